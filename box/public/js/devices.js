@@ -31,6 +31,11 @@ bt.devices = function() {
     var options = {"persistent": false,
 		   "bitrate": 9600,
 		   "ctsFlowControl": false};
+
+    // The daq always starts at 9600.  Once it is connected it is
+    // moved to this rate, the fastest of its rates that every
+    // platform's serial driver supports.
+    var fastBitrate = 115200;
    
     // Important note related to the Google serial API.  Timeout
     // doesn't mean what you think it means.  Timeout seems to mean,
@@ -409,6 +414,15 @@ bt.devices = function() {
 
 		    bt.ui.info('The experiment has started on ' + d.path + ' and will be completed in ' + totalTime + ' seconds');		
 
+		    // Have the daq send each measurement as it is
+		    // taken, so it shows up without waiting for the
+		    // experiment to finish.  A daq that does not
+		    // support this answers with an abort, which is
+		    // harmless; the data is still logged on the daq.
+		    if (d.protocol.subscribe !== undefined) {
+			d.protocol.subscribe(d.experiment_measurements).then(function(response) { }, function(error) { });
+		    }
+
 		    // The experiment has begun.  
 
 		    // The experiment object to which this device is
@@ -922,6 +936,19 @@ bt.devices = function() {
 			// Indicate that the recently connected pathname is connected.
 			bt.ui.indicate(path,'connected');
 			bt.ui.info(path + ' is enabled.');	
+
+			// Move to the faster rate.  A daq that cannot
+			// answers with an abort and the connection stays
+			// at 9600, as it does if the new rate fails.
+			if (d.protocol.configureBaud !== undefined) {
+			    d.protocol.configureBaud(fastBitrate).then(function(response) {
+				if (response.result === "Success") {
+				    bt.ui.info(path + ' is running at ' + fastBitrate + ' baud.');
+				}
+			    }, function(error) {
+				bt.ui.warning(path + ' stays at 9600 baud.');
+			    });
+			}
 		    }
 		    else {
 			bt.ui.error(path + ' cannot be enabled.');
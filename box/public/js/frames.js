@@ -0,0 +1,281 @@
+/**
+ * frames.js
+ *
+ * Decodes the binary frames a miniSDI-12 device sends in response to
+ * an `F` command.  An `F` dump holds the same data as a `D` dump, but
+ * each saved period is sent as one small binary frame instead of a
+ * line of text for every port.
+ *
+ * Every frame on the wire is COBS encoded and followed by a single
+ * zero byte.  Once decoded a frame is:
+ *
+ *     length  1 byte, number of bytes in type and body
+ *     type    1 byte, 'H', 'D' or 'E'
+ *     body    length - 1 bytes, numbers are little endian
+ *     crc     2 bytes, CRC-16/XMODEM of length, type and body
+ *
+ * The frame types are:
+ *
+ *     H - Header: start time (uint32), period length in milliseconds
+ *         (uint32) and the number of fractional bits in the values of
+ *         each port (one byte per port).
+ *     D - Data: period number (uint32), port mask (one byte, bit n is
+ *         port n+1) and a signed 32 bit fixed point value for each
+ *         port in the mask.  A summary of a window of samples has
+ *         bit 7 of the mask set and only one port, its value is the
+ *         mean and is followed by the min and max (fixed point) and
+ *         the count (one byte).
+ *     E - End: the number of periods sent (uint16), a period can be sent as several data frames.
+ */
+
+// Extend the namespace
+var bt = bt || {};
+bt.frames = {};
+
+/**
+ * frames()
+ *
+ * Define the frames module.
+ *
+ */
+bt.frames = function() {
+
+    // ************************************************************************
+    // Variables local to this module.
+    // ************************************************************************
+    var HEADER = 0x48;  // 'H'
+    var DATA = 0x44;    // 'D'
+    var END = 0x45;     // 'E'
+    var SUMMARY = 0x80; // set in the port mask of a summary
+
+    // The largest frame the DAQ sends is well under this.  Anything
+    // longer has lost its delimiter and is thrown away.
+    var MAX_FRAME = 64;
+
+    // *** DECODER OBJECT DEFINITION ***
+
+    /**
+     * decoder()
+     *
+     * This object turns the bytes received from a device into
+     * records.  Bytes may be pushed in pieces of any size; a frame
+     * split across two receive events is put back together.
+     */
+    bt.frames.decoder = function() {
+
+	// Bytes of the frame that has not seen its zero yet.
+	this.pending = [];
+
+	// The last header record, needed to turn period numbers into
+	// times and fixed point values into numbers.
+	this.header = null;
+
+	// The number of frames thrown away because they failed their
+	// length or crc check.
+	this.errors = 0;
+    }
+
+    bt.frames.decoder.prototype.push = push;
+
+    /**
+     * push()
+     *
+     * Decodes every complete frame in buf.
+     *
+     * @param buf An ArrayBuffer of bytes received from the device.
+     *
+     * @returns An array of records.  A header record has type 'H',
+     * start, period (in seconds) and fracBits fields.  A data record has type
+     * 'D', period, time and values fields, where values maps port
+     * addresses to numbers.  A summary also has min, max and count
+     * fields, values holds the mean.  An end record has type 'E' and a count
+     * field.
+     */
+    function push(buf) {
+
+	var bytes = new Uint8Array(buf);
+	var records = [];
+
+	for (var i = 0; i < bytes.length; i++) {
+
+	    if (bytes[i] !== 0) {
+		if (this.pending.length < MAX_FRAME) {
+		    this.pending.push(bytes[i]);
+		}
+		continue;
+	    }
+
+	    // A zero ends the frame.
+	    var frame = cobsDecode(this.pending);
+	    this.pending = [];
+
+	    var record = (frame === null) ? null : parseFrame.call(this, frame);
+	    if (record === null) {
+		this.errors++;
+	    }
+	    else {
+		records.push(record);
+	    }
+	}
+
+	return records;
+    }
+
+    /**
+     * parseFrame()
+     *
+     * Checks the length and crc of a decoded frame and turns its body
+     * into a record.
+     *
+     * @param frame An array of decoded bytes.
+     *
+     * @returns The record, or null if the frame is not valid.
+     */
+    function parseFrame(frame) {
+
+	if (frame.length < 4 || frame[0] !== frame.length - 3) {
+	    return null;
+	}
+
+	var crc = frame[frame.length - 2] | (frame[frame.length - 1] << 8);
+	if (crc !== bt.frames.crc16(frame.slice(0, frame.length - 2))) {
+	    return null;
+	}
+
+	var type = frame[1];
+	var body = frame.slice(2, frame.length - 2);
+	var record = {};
+
+	if (type === HEADER && body.length >= 8) {
+	    record.type = 'H';
+	    record.start = getLong(body, 0);
+	    record.period = getLong(body, 4) / 1000;
+	    record.fracBits = body.slice(8);
+	    this.header = record;
+	}
+
+	else if (type === DATA && body.length >= 5) {
+	    record.type = 'D';
+	    record.period = getLong(body, 0);
+	    record.values = {};
+
+	    if (this.header !== null) {
+		record.time = this.header.start + Math.round(record.period * this.header.period * 1000) / 1000;
+	    }
+
+	    var summary = (body[4] & SUMMARY) !== 0;
+	    var mask = body[4] & ~SUMMARY;
+	    var offset = 5;
+	    for (var port = 1; mask !== 0; port++, mask >>= 1) {
+		if (mask & 1) {
+		    if (offset + (summary ? 13 : 4) > body.length) {
+			return null;
+		    }
+		    var scale = Math.pow(2, (this.header !== null) ? this.header.fracBits[port - 1] : 0);
+		    record.values[port] = (getLong(body, offset) | 0) / scale;
+		    offset += 4;
+		    if (summary) {
+			record.min = (getLong(body, offset) | 0) / scale;
+			record.max = (getLong(body, offset + 4) | 0) / scale;
+			record.count = body[offset + 8];
+			offset += 9;
+		    }
+		}
+	    }
+	}
+
+	else if (type === END && body.length >= 2) {
+	    record.type = 'E';
+	    record.count = body[0] | (body[1] << 8);
+	}
+
+	else {
+	    return null;
+	}
+
+	return record;
+    }
+
+    // ************************************************************************
+    // Methods provided by this module, visible to others via
+    // the bt.frames namespace.
+    // ************************************************************************
+
+    /**
+     * crc16()
+     *
+     * CRC-16/XMODEM, polynomial 0x1021 with a starting value of 0.
+     * This is avr-libc's _crc_xmodem_update().
+     *
+     * @param bytes An array of bytes.
+     *
+     * @returns The crc.
+     */
+    bt.frames.crc16 = function(bytes) {
+
+	var crc = 0;
+
+	for (var i = 0; i < bytes.length; i++) {
+	    crc ^= bytes[i] << 8;
+	    for (var bit = 0; bit < 8; bit++) {
+		crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+		crc &= 0xFFFF;
+	    }
+	}
+
+	return crc;
+    }
+
+    /* **************************************************************
+     *
+     * Local Utility Functions
+     *
+     */
+
+    /**
+     * cobsDecode()
+     *
+     * Undoes the COBS encoding of one frame.  Each code byte is the
+     * distance to the next zero in the original frame.
+     *
+     * @param bytes An array of encoded bytes, without the final zero.
+     *
+     * @returns An array of decoded bytes, or null if a code byte
+     * points past the end of the frame.
+     */
+    function cobsDecode(bytes) {
+
+	var out = [];
+	var i = 0;
+
+	while (i < bytes.length) {
+	    var code = bytes[i++];
+	    if (i + code - 1 > bytes.length) {
+		return null;
+	    }
+	    for (var j = 1; j < code; j++) {
+		out.push(bytes[i++]);
+	    }
+	    if (code < 0xFF && i < bytes.length) {
+		out.push(0);
+	    }
+	}
+
+	return out;
+    }
+
+    /**
+     * getLong()
+     *
+     * Reads an unsigned little endian 32 bit number.
+     */
+    function getLong(bytes, offset) {
+	return (bytes[offset] | (bytes[offset + 1] << 8) |
+		(bytes[offset + 2] << 16) | (bytes[offset + 3] << 24)) >>> 0;
+    }
+
+} // end bt.frames module
+
+
+// Invoke module.
+bt.frames();
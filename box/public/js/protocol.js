@@ -28,6 +28,7 @@ bt.protocol = function() {
     var commandElement = 0;
 
     var ct = "!;"  // The command terminator
+    var LIVE = "*" // Starts a data report sent live after an L command
 
     // Identify the position of these common tokens in responses.
     var ID = 0;
@@ -36,6 +37,9 @@ bt.protocol = function() {
     var TIME = 2;
     var VALUES = 3;
     var N = 3;
+    var MIN = 4;
+    var MAX = 5;
+    var COUNT = 6;
 
     // *** miniSDI12 OBJECT DEFINITION ***
 
@@ -99,13 +103,42 @@ bt.protocol = function() {
      * getLoggedData()
      * stop()
      *
+     * getLoggedFrames() is optional, it gets the same data as
+     * getLoggedData() in binary frames.
+     *
+     * getLoggedPage(cursor, n) is optional, it gets the logged data a
+     * page at a time.
+     *
+     * configureWindow(a, n) is optional, it has a port logged as a
+     * summary of every n samples.
+     *
+     * configureDeadband(a, band, silence) is optional, it has a port
+     * logged only when its measurement changes.
+     *
+     * query(mask, start, end) is optional, it gets the logged data
+     * from some ports over a range of time.
+     *
+     * configureBaud(rate) is optional, it moves the connection to a
+     * faster baud rate.
+     *
+     * subscribe(n) is optional, it has a running experiment send its
+     * measurements as they are taken.
+     *
      */
 
     bt.protocol.miniSDI12.prototype.acknowledge = acknowledge;
     bt.protocol.miniSDI12.prototype.configurePeriod = configurePeriod;
+    bt.protocol.miniSDI12.prototype.configureDivider = configureDivider;
+    bt.protocol.miniSDI12.prototype.configureWindow = configureWindow;
+    bt.protocol.miniSDI12.prototype.configureDeadband = configureDeadband;
+    bt.protocol.miniSDI12.prototype.configureBaud = configureBaud;
     bt.protocol.miniSDI12.prototype.getMeasurements = getMeasurements;
     bt.protocol.miniSDI12.prototype.startMeasurements = startMeasurements;    
     bt.protocol.miniSDI12.prototype.getLoggedData = getLoggedData;
+    bt.protocol.miniSDI12.prototype.getLoggedFrames = getLoggedFrames;
+    bt.protocol.miniSDI12.prototype.getLoggedPage = getLoggedPage;
+    bt.protocol.miniSDI12.prototype.query = query;
+    bt.protocol.miniSDI12.prototype.subscribe = subscribe;
     bt.protocol.miniSDI12.prototype.stop = stop;
 
     bt.protocol.miniSDI12.prototype.send = send;
@@ -139,9 +172,13 @@ bt.protocol = function() {
      *
      * This method issues a `P` command to the underlying miniSDI-12
      * device to configure its period to 'n', where 'n' is expressed
-     * in seconds.
+     * in seconds.  A period that is not a whole number of seconds is
+     * sent as seconds and milliseconds, "0P0,100!;" for 0.1, and can
+     * be at most 16 seconds.  The shortest period is 0.1 seconds, the
+     * DAQ can not save samples any faster.
      *
-     * @param n The new period, expressed in number of seconds. 
+     * @param n The new period, expressed in number of seconds, to
+     * the nearest millisecond.
      *
      * @returns A promise that will eventually be fulfilled by a
      * response object representing the device's response.
@@ -149,15 +186,22 @@ bt.protocol = function() {
     function configurePeriod(n) {
 
 
-	// An experiment's period is stored in a signed 16-bit
-	// variable on the Arduino UNO.  Thus, the maximum possible
-	// period on the DAQ is currently 2^15 - 1. This maximum is
-	// enforced both by runnable.js and protocol.js.
-	var maximumPossiblePeriod = 32767;
+	// An experiment's period is stored in milliseconds in an
+	// unsigned 32-bit variable on the Arduino UNO.  Thus, the
+	// maximum possible period on the DAQ is 4294966 seconds.  This
+	// maximum is enforced both by runnable.js and protocol.js.
+	var maximumPossiblePeriod = 4294966;
+	var maximumFractionalPeriod = 16;
+	var minimumPeriod = 100;
 
-	if (typeof(n) === 'number' && n >= 1 && n <= maximumPossiblePeriod) {
-	    var command = "0P" + n + ct;
-	    return this.send(command, 0, "P", n);
+	var total = Math.round(n * 1000);
+	var seconds = Math.floor(total / 1000);
+	var ms = total % 1000;
+
+	if (typeof(n) === 'number' && total >= minimumPeriod && n <= maximumPossiblePeriod &&
+	    (ms === 0 || n <= maximumFractionalPeriod)) {
+	    var command = "0P" + seconds + (ms === 0 ? "" : "," + ms) + ct;
+	    return this.send(command, 0, "P", total / 1000);
 	}
 	
 	else {
@@ -170,6 +214,164 @@ bt.protocol = function() {
 	}
     }
 
+    /**
+     * configureDivider()
+     *
+     * This method issues an `I` command to the underlying miniSDI-12
+     * device to sample port 'a' once every 'n' periods of the next
+     * M-style experiment.  Every port shares the period set by
+     * configurePeriod, so slow changing sensors can be logged less
+     * often than fast ones.  Each logged measurement only holds the
+     * ports that were due.
+     *
+     * @param a The port to configure, 0 for every port.
+     *
+     * @param n The number of periods between samples, 1 to 255.
+     *
+     * @returns A promise that will eventually be fulfilled by a
+     * response object representing the device's response.
+     */
+    function configureDivider(a, n) {
+
+	if (typeof(n) === 'number' && n % 1 === 0 && n >= 1 && n <= 255) {
+	    var command = a + "I" + n + ct;
+	    return this.send(command, a, "I", n);
+	}
+
+	else {
+	    return new Promise(function(resolve, reject) {
+		var ro = new bt.protocol.response();
+		ro.type = "NA";
+		ro.result = "Badly Formed Command";
+		reject(ro);
+	    });
+	}
+    }
+
+    /**
+     * configureWindow()
+     *
+     * This method issues a `W` command to the underlying miniSDI-12
+     * device to log port 'a' as a summary of every 'n' samples of
+     * the next M-style experiment.  Each summary holds the mean,
+     * min, max and count of its samples, so the log lasts n times
+     * as long without losing the peaks.  Measurements sent live
+     * are not summarised.
+     *
+     * @param a The port to configure, 0 for every port.
+     *
+     * @param n The number of samples in a summary, 1 to 255.
+     *
+     * @returns A promise that will eventually be fulfilled by a
+     * response object representing the device's response.
+     */
+    function configureWindow(a, n) {
+
+	if (typeof(n) === 'number' && n % 1 === 0 && n >= 1 && n <= 255) {
+	    var command = a + "W" + n + ct;
+	    return this.send(command, a, "W", n);
+	}
+
+	else {
+	    return new Promise(function(resolve, reject) {
+		var ro = new bt.protocol.response();
+		ro.type = "NA";
+		ro.result = "Badly Formed Command";
+		reject(ro);
+	    });
+	}
+    }
+
+    /**
+     * configureDeadband()
+     *
+     * This method issues an `H` command to the underlying miniSDI-12
+     * device to log port 'a' only when its measurement changes during
+     * the next M-style experiment.  A measurement is logged if it
+     * differs from the last one logged by more than 'band', or if
+     * 'silence' periods have passed since it.  Each logged
+     * measurement keeps its own time.  Measurements sent live are
+     * not filtered.
+     *
+     * @param a The port to configure, 0 for every port.
+     *
+     * @param band The deadband in the sensor's native units, 0 to
+     * 255.  A thermocouple counts in quarter degrees.
+     *
+     * @param silence The most periods between logged measurements,
+     * 0 to 65535.  0 is no limit, 1 logs every measurement.
+     *
+     * @returns A promise that will eventually be fulfilled by a
+     * response object representing the device's response.
+     */
+    function configureDeadband(a, band, silence) {
+
+	if (typeof(band) === 'number' && band % 1 === 0 && band >= 0 && band <= 255 &&
+	    typeof(silence) === 'number' && silence % 1 === 0 && silence >= 0 && silence <= 65535) {
+	    var command = a + "H" + band + "," + silence + ct;
+	    return this.send(command, a, "H", band + "," + silence);
+	}
+
+	else {
+	    return new Promise(function(resolve, reject) {
+		var ro = new bt.protocol.response();
+		ro.type = "NA";
+		ro.result = "Badly Formed Command";
+		reject(ro);
+	    });
+	}
+    }
+
+    /**
+     * configureBaud()
+     *
+     * This method issues an `S` command to the underlying miniSDI-12
+     * device to change its baud rate to 'rate'.  The device answers
+     * at the old rate and then switches.  Once the answer arrives the
+     * connection is switched too and an acknowledge is sent at the
+     * new rate; the device falls back to 9600 if it does not get a
+     * valid command at the new rate within 3 seconds, and so does
+     * the connection if the acknowledge gets no answer.  The device
+     * always starts at 9600, so the rate is asked for again every
+     * time it is connected.
+     *
+     * @param rate The new baud rate.  One of 9600, 19200, 38400,
+     * 57600, 115200 or 250000.
+     *
+     * @returns A promise that will eventually be fulfilled by the
+     * response to the acknowledge sent at the new rate.
+     */
+    function configureBaud(rate) {
+
+	var d = this;
+	var command = "0S" + rate + ct;
+
+	return this.send(command, 0, "S", rate).then(function(ro) {
+
+	    if (ro.result !== "Success") {
+		return ro;
+	    }
+
+	    return new Promise(function(resolve, reject) {
+		chrome.serial.update(d.ci.connectionId, {"bitrate": rate}, function(result) {
+		    if (!result) {
+			ro.result = "Error";
+			resolve(ro);
+			return;
+		    }
+		    d.acknowledge(0).then(resolve, function(error) {
+
+			// The device has gone back to 9600 by the time
+			// the acknowledge times out, follow it.
+			chrome.serial.update(d.ci.connectionId, {"bitrate": 9600}, function(result) {
+			    reject(error);
+			});
+		    });
+		});
+	    });
+	});
+    }
+
     /**
      * startMeasurements()
      *
@@ -215,6 +417,102 @@ bt.protocol = function() {
 	return this.send(command, 0, "D");	
     }
 
+    /** 
+     * getLoggedPage()
+     * 
+     * This method issues a `D` command with a cursor to the
+     * underlying miniSDI-12 device to get up to 'n' periods of the
+     * data backed up to the device, starting at period 'cursor'.
+     * Each period is logged the same way the responses to
+     * getLoggedData() are.  The promise is fulfilled by a response
+     * object whose cursor is where the next page starts; pass it to
+     * the next call to carry on, or to a later call to get only
+     * the periods saved since.  Cursors are period numbers, which
+     * start again at 1 with every M-style experiment.
+     *
+     * @param cursor The period to start at, 0 for the oldest.
+     *
+     * @param n The most periods to get, 0 for all of them.
+     *
+     */
+    function getLoggedPage(cursor, n) {
+	
+	var command = "0D" + cursor + "," + n + ct;
+	return this.send(command, 0, "D", n);	
+    }
+
+    /** 
+     * query()
+     * 
+     * This method issues a `Q` command to the underlying miniSDI-12
+     * device to get the data backed up to the device from the ports
+     * in 'mask' between the times 'start' and 'end'.  Only the
+     * matching data is sent; each measurement is logged the same way
+     * the responses to getLoggedData() are.  The promise is
+     * fulfilled by a response object whose n is the number of
+     * measurements sent.
+     *
+     * @param mask Bit n is set to get port n+1.  0 for every port.
+     *
+     * @param start The time of the first measurement, in seconds
+     * since 1970.
+     *
+     * @param end The time of the last measurement, in seconds since
+     * 1970.  Leave it out to get everything since start.
+     *
+     */
+    function query(mask, start, end) {
+	
+	var command = mask + "Q" + start;
+	if (end !== undefined) {
+	    command += "," + end;
+	}
+	command += ct;
+	return this.send(command, 0, "Q");	
+    }
+
+    /** 
+     * getLoggedFrames()
+     * 
+     * This method issues an `F` command to the underlying miniSDI-12
+     * device to get all data currently backed up to the device
+     * itself as binary frames.  See frames.js.  Each saved period
+     * is logged the same way the responses to getLoggedData() are.
+     * The promise is fulfilled by a response object of type "F"
+     * whose n is the number of periods sent.
+     *
+     */
+    function getLoggedFrames() {
+	
+	var command = "0F0" + ct;
+	return this.send(command, 0, "F");	
+    }
+
+
+    /** 
+     * subscribe()
+     * 
+     * This method issues an `L` command to the underlying miniSDI-12
+     * device to have a running M-style experiment send each of its
+     * next 'n' periods as they are saved.  The data reports start
+     * with '*', so one that arrives while the daq is answering
+     * another command is never taken for that answer.  They are
+     * logged the same way as those sent for an `R` command.
+     * Subscribe again before the n periods run out to keep receiving
+     * them.
+     *
+     * @param n The number of periods to send, at most 65535.  0 ends
+     * the subscription.
+     *
+     * @returns A promise that will eventually be fulfilled by a
+     * response object whose n is the number of periods granted.
+     */
+    function subscribe(n) {
+
+	var command = "0L" + n + ct;
+	return this.send(command, 0, "L", n);
+    }
+
 
     /**
      * stop()
@@ -241,6 +539,14 @@ bt.protocol = function() {
      *
      */
     function parse(s) {
+
+	// A data report sent live after a Subscribe (L) command can
+	// arrive at any time, even while the daq is answering another
+	// command.  It is marked, so route it before anything else
+	// looks at the last command sent.
+	if (s.charAt(0) === LIVE) {
+	    return parseLive(s);
+	}
     
 	// Split the string on the commas and see how many
 	// tokens we have.
@@ -252,9 +558,14 @@ bt.protocol = function() {
 	 *     B - Abort or Break Response
 	 *     A - Acknowledge Active
 	 *     P - Configure Period
+	 *     I - Configure Divider
+	 *     W - Configure Window
+	 *     H - Configure Deadband
 	 *     R - Continuous Measurement
 	 *     M - Start Measurement
 	 *     D - Get Data
+	 *     L - Subscribe, or a data report sent live after it
+	 *     Q - Query Data
 	 *     NA - No response applicable.  This is for when
 	 *          no command needs to be sent to the DAQ, but a successful
 	 *          response object needs to be returned.
@@ -263,16 +574,23 @@ bt.protocol = function() {
 	 *
 	 * 2) a: An integer value [0..9] representing a DAQ or a sensor address.
 	 *
-	 * 3) time: An integer value expressing the number of seconds since
-	 *          Jan 1, 1970 that this response was received.
+	 * 3) time: A value expressing the number of seconds since
+	 *          Jan 1, 1970 that this response was received.  It
+	 *          has three decimal places for a measurement that was
+	 *          not taken on a whole second.
 	 *
 	 * 4) n: Either a period or a number of measurements, as provided
 	 *       in the P and M responses.
 	 *
 	 * 5) values: An array of measurements in the data response.
+	 *    For a summary of a window of samples it is their mean,
+	 *    and min, max and count are also set.
 	 *
 	 * 6) period: The period at which the daq is configured.
 	 *
+	 *    cursor: Where the next page of logged data starts, as
+	 *    provided in the response to a D command with a cursor.
+	 *
 	 * 7) terminated: It is true if only one response was expected
 	 *    or if the terminating ':' has been received, false,
 	 *    otherwise.
@@ -356,6 +674,66 @@ bt.protocol = function() {
 		    
 	    }
 
+	    // If there are 3 tokens after an S command, it is a
+	    // configure baud rate response.
+	    else if (tokens.length === 3 && this.last.type === 'S') {
+
+		ro.type = 'S';
+		ro.n = parseInt(tokens[PERIOD]);
+		ro.terminated = true;
+		ro.result = (ro.n === this.last.n) ? "Success" : "Error";
+	    }
+
+	    // If there are 3 tokens after a D command, it is the
+	    // cursor that ends a page of logged data.
+	    else if (tokens.length === 3 && this.last.type === 'D') {
+
+		ro.type = 'D';
+		ro.cursor = parseInt(tokens[PERIOD]);
+		ro.terminated = true;
+		ro.result = "Success";
+	    }
+
+	    // If there are 3 tokens after a Q command, it is the
+	    // number of measurements that matched the query.
+	    else if (tokens.length === 3 && this.last.type === 'Q') {
+
+		ro.type = 'Q';
+		ro.n = parseInt(tokens[PERIOD]);
+		ro.terminated = true;
+		ro.result = "Success";
+	    }
+
+	    // If there are 3 tokens after an I command, it is a
+	    // configure divider response, the port and its divider.
+	    else if (tokens.length === 3 && this.last.type === 'I') {
+
+		ro.type = 'I';
+		ro.n = parseInt(tokens[PERIOD]);
+		ro.terminated = true;
+		ro.result = (ro.a === this.last.address && ro.n === this.last.n) ? "Success" : "Error";
+	    }
+
+	    // If there are 3 tokens after a W command, it is a
+	    // configure window response, the port and its window.
+	    else if (tokens.length === 3 && this.last.type === 'W') {
+
+		ro.type = 'W';
+		ro.n = parseInt(tokens[PERIOD]);
+		ro.terminated = true;
+		ro.result = (ro.a === this.last.address && ro.n === this.last.n) ? "Success" : "Error";
+	    }
+
+	    // If there are 3 tokens after an L command, it is a
+	    // subscribe response.
+	    else if (tokens.length === 3 && this.last.type === 'L') {
+
+		ro.type = 'L';
+		ro.n = parseInt(tokens[PERIOD]);
+		ro.terminated = true;
+		ro.result = (ro.n === this.last.n) ? "Success" : "Error";
+	    }
+
 	    // If there are 3 tokens, it is a configure period response.
 	    // Extract the period from the response and set the type.
 	    else if (tokens.length === 3) {
@@ -390,9 +768,32 @@ bt.protocol = function() {
 		}
 	    }
 	    
+	    // If there are 4 tokens after a P command, it is a
+	    // configure period response for a period with
+	    // milliseconds, the seconds followed by the milliseconds.
+	    else if (tokens.length === 4 && this.last.type === 'P') {
+
+		ro.type = 'P';
+		ro.period = (parseInt(tokens[PERIOD]) * 1000 + parseInt(tokens[N])) / 1000;
+		ro.terminated = true;
+		ro.result = (ro.period === this.last.n) ? "Success" : "Error";
+	    }
+
+	    // If there are 4 tokens after an H command, it is a
+	    // configure deadband response, the port, its deadband and
+	    // its silence.
+	    else if (tokens.length === 4 && this.last.type === 'H') {
+
+		ro.type = 'H';
+		ro.n = parseInt(tokens[PERIOD]);
+		ro.silence = parseInt(tokens[N]);
+		ro.terminated = true;
+		ro.result = (ro.a === this.last.address && ro.n + "," + ro.silence === this.last.n) ? "Success" : "Error";
+	    }
+
 	    // If there are 4 tokens, then this could be a response to
 	    // a Continuous Measurement (R), Start Measurement (M) or
-	    // Send Data (D) command.
+	    // Send Data (D) or Query Data (Q) command.
 	    else if (tokens.length === 4) {
 		
 		// Determine whether this is a response to an M command.
@@ -430,7 +831,7 @@ bt.protocol = function() {
 		
 		    ro.result = "Success";
 		    ro.type = this.last.type;
-		    ro.time = tokens[TIME];
+		    ro.time = parseFloat(tokens[TIME]);
 		    ro.values = tokens[VALUES];
 
 		    // Is there a colon at the end of this?
@@ -442,8 +843,60 @@ bt.protocol = function() {
 		    }
 		}
 	    }
+
+	    // If there are 7 tokens, it is a summary of a window of
+	    // logged measurements sent in response to a Send Data (D)
+	    // or Query Data (Q) command: the time of the last
+	    // measurement in the window, then the mean, min, max and
+	    // number of measurements.
+	    else if (tokens.length === 7) {
+
+		ro.result = "Success";
+		ro.type = this.last.type;
+		ro.time = parseFloat(tokens[TIME]);
+		ro.values = tokens[VALUES];
+		ro.min = tokens[MIN];
+		ro.max = tokens[MAX];
+		ro.count = parseInt(tokens[COUNT]);
+		ro.terminated = (s.indexOf(':') > -1);
+	    }
+	}
+
+	return ro;
+    }
+
+    /**
+     * parseLive(s)
+     *
+     * This method, not public in the protocol object, parses a data
+     * report sent live after a Subscribe (L) command, a data report
+     * or a summary that starts with LIVE.  It never ends the
+     * response to the command that was sent last.
+     */
+    function parseLive(s) {
+
+	var tokens = s.substring(LIVE.length).split(',');
+	var ro = new response();
+
+	ro.raw = s;
+	ro.type = 'L';
+	ro.terminated = false;
+
+	if (tokens.length !== 4 && tokens.length !== 7) {
+	    ro.result = "Error";
+	    return ro;
 	}
 
+	ro.id = tokens[ID];
+	ro.a = parseInt(tokens[ADDRESS]);
+	ro.time = parseFloat(tokens[TIME]);
+	ro.values = tokens[VALUES];
+	if (tokens.length === 7) {
+	    ro.min = tokens[MIN];
+	    ro.max = tokens[MAX];
+	    ro.count = parseInt(tokens[COUNT]);
+	}
+	ro.result = "Success";
 	return ro;
     }
 
@@ -548,6 +1001,11 @@ bt.protocol = function() {
 	if(this.last.type === "P") {
 	    this.last.period = cmd.n;
 	}
+
+	// Binary responses need a fresh decoder for every command.
+	if(this.last.type === "F") {
+	    this.decoder = new bt.frames.decoder();
+	}
 	
 	// Log the raw serial command to the debug serial console.
 	bt.ui.serial(cmd.c);
@@ -613,6 +1071,13 @@ bt.protocol = function() {
 	     */
 	    receive = function(info) {
 
+		// Responses to an F command are binary frames, not
+		// lines of text.
+		if(this.last.type === "F") {
+		    receiveFrames.call(this, info, sendInterval, resolve);
+		    return;
+		}
+
 		var data = "";
 		
 		// Given an ArrayBuffer of data, construct a string and parse
@@ -658,7 +1123,7 @@ bt.protocol = function() {
 		    // synchronized with the clock on the device, I
 		    // think it's best to use the timestamp provided
 		    // by the device.
-		    if(ro.type === "D" || ro.type === "R") {
+		    if(ro.type === "D" || ro.type === "R" || ro.type === "L" || ro.type === "Q") {
 		
 			// If the time on the response is newer than the
 			// lasttime we heard from this particular address,
@@ -671,8 +1136,9 @@ bt.protocol = function() {
 			    // the daq commands may resend the same data, so
 			    // we need to avoid logging it multiple times.
 			    
-			    // Get rid of any colons to avoid user confusion.
-			    var msg = ro.raw.replace(':','');
+			    // Get rid of any colons, and the mark of a live
+			    // report, to avoid user confusion.
+			    var msg = ro.raw.replace(':','').replace(LIVE,'');
 
 			    // Then log it.
 			    bt.ui.log(msg);
@@ -699,6 +1165,61 @@ bt.protocol = function() {
 	}); // end return new Promise()
     }
 
+    /**
+     * receiveFrames()
+     *
+     * This method, not public in the protocol object, handles the
+     * data received in response to an `F` command.  Each data frame
+     * is logged the same way a `D` data report is.  The promise is
+     * resolved once the end frame arrives.
+     *
+     * @param info The serial info received by the onReceive event
+     * handler.
+     *
+     * @param sendInterval The timer that rejects the promise.
+     *
+     * @param resolve The function that resolves the promise.
+     */
+    function receiveFrames(info, sendInterval, resolve) {
+
+	var records = this.decoder.push(info.data);
+
+	for (var i = 0; i < records.length; i++) {
+
+	    var record = records[i];
+	    this.count++;
+
+	    if (record.type === 'D') {
+		for (var a in record.values) {
+
+		    var v = record.values[a];
+		    var msg = a + "," + record.time + "," + (v >= 0 ? "+" : "") + v.toFixed(2);
+		    if (record.count !== undefined) {
+			msg += "," + (record.min >= 0 ? "+" : "") + record.min.toFixed(2) +
+			    "," + (record.max >= 0 ? "+" : "") + record.max.toFixed(2) + "," + record.count;
+		    }
+		    bt.ui.serial(msg);
+
+		    if(record.time > this.lasttime[a]) {
+			this.lasttime[a] = record.time;
+			bt.ui.log(msg);
+		    }
+		}
+	    }
+
+	    else if (record.type === 'E') {
+		var ro = new response();
+		ro.type = "F";
+		ro.result = "Success";
+		ro.n = record.count;
+		ro.errors = this.decoder.errors;
+		ro.terminated = true;
+		clearTimeout(sendInterval);
+		resolve(ro);
+	    }
+	}
+    }
+
     // *** COMMAND OBJECT DEFINITION ***
 
     /**
@@ -718,9 +1239,16 @@ bt.protocol = function() {
      *     B - Break Response
      *     A - Acknowledge Active
      *     P - Configure Period
+     *     I - Configure Divider
+     *     W - Configure Window
+     *     H - Configure Deadband
      *     R - Continuous Measurement
      *     M - Start Measurement
      *     D - Get Data
+     *     F - Get Data as binary frames
+     *     S - Configure Baud Rate
+     *     L - Subscribe
+     *     Q - Query Data
      *
      * @param n The n-value used in the command.
      *
@@ -489,7 +489,8 @@ bt.runnable = function() {
      *
      * @param value An integer value, 1 or greater.
      *
-     * @param units A string, 'minutes', 'hours', or 'seconds'.
+     * @param units A string, 'minutes', 'hours', 'seconds' or
+     * 'milliseconds'.
      */
     function toSeconds(value, units) {
 
@@ -499,6 +500,7 @@ bt.runnable = function() {
 	if (value === undefined) return undefined;
 	else if(value === NaN) return undefined;
 	else if(value === 0) return undefined;
+	else if (units === 'milliseconds') return value / 1000;
 	else if (units === 'seconds') return value;
 	else if (units === 'minutes') return value * 60;	
 	else if (units === 'hours') return value * 60 * 60;
@@ -527,11 +529,18 @@ bt.runnable = function() {
 	var per = toSeconds(period, p_units);
 	var dur = toSeconds(duration, d_units);
 
-	// An experiment's period is stored in a signed 16-bit
-	// variable on the Arduino UNO.  Thus, the maximum possible
-	// period on the DAQ is currently 2^15 - 1.  This maximum is
-	// enforced both by runnable.js and protocol.js.
-	var maximumPossiblePeriod = 32767;
+	// An experiment's period is stored in milliseconds in an
+	// unsigned 32-bit variable on the Arduino UNO.  Thus, the
+	// maximum possible period on the DAQ is 4294966 seconds.  This
+	// maximum is enforced both by runnable.js and protocol.js.
+	var maximumPossiblePeriod = 4294966;
+
+	// A period that is not a whole number of seconds is timed
+	// from the DAQ's 4096 Hz clock, which limits it to 16 seconds.
+	var maximumFractionalPeriod = 16;
+
+	// The DAQ can not save samples faster than every 0.1 seconds.
+	var minimumPeriod = 0.1;
 	
 	if(per === undefined) {
 	    bt.ui.error("The period must be an integer value greater than 0");
@@ -548,6 +557,16 @@ bt.runnable = function() {
 	    return;
 	}
 
+	else if(per < minimumPeriod) {
+	    bt.ui.error("At this time, the period cannot be less than " + minimumPeriod + " seconds.");
+	    return;
+	}
+
+	else if(per % 1 !== 0 && per > maximumFractionalPeriod) {
+	    bt.ui.error("A period that is not a whole number of seconds cannot exceed " + maximumFractionalPeriod + " seconds.");
+	    return;
+	}
+
 	else if(dur < per) {
 	    bt.ui.error("The duration must be greater than the period.");
 	    return;
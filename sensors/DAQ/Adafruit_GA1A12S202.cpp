@@ -1,16 +1,42 @@
-#include "Adafruit_GA1A12S202.H"
+#include "Adafruit_GA1A12S202.h"
+
+//10^x worked out by the compiler. The whole decades are split off so the series for e^x only has
+//to cover 0 <= x < ln(10), 30 terms is well past float precision there. Everything is float, which
+//is what double is on the AVR too, so a host build of the tests works out the very same table.
+#define GA1A12S202_LN10 2.302585093f
+static constexpr float expSeries (float x, int n, float term){
+    return n > 30 ? term : term + expSeries(x, n + 1, term * x / n);
+}
+static constexpr float power10 (float x){
+    return x >= 1 ? 10 * power10(x - 1) : expSeries(x * GA1A12S202_LN10, 1, 1.0f);
+}
+static constexpr uint32_t luxEntry (int raw){
+    return power10(raw * (float)GA1A12S202_LOG_RANGE / GA1A12S202_RAW_RANGE) * (1UL << GA1A12S202_LUX_FRAC_BITS) + 0.5f;
+}
+
+//expands to luxEntry(0), luxEntry(0+1) ... luxEntry(768+192+48+12+3)
+#define GA1A12S202_LUX4(i) luxEntry(i), luxEntry(i+1), luxEntry(i+2), luxEntry(i+3)
+#define GA1A12S202_LUX16(i) GA1A12S202_LUX4(i), GA1A12S202_LUX4(i+4), GA1A12S202_LUX4(i+8), GA1A12S202_LUX4(i+12)
+#define GA1A12S202_LUX64(i) GA1A12S202_LUX16(i), GA1A12S202_LUX16(i+16), GA1A12S202_LUX16(i+32), GA1A12S202_LUX16(i+48)
+#define GA1A12S202_LUX256(i) GA1A12S202_LUX64(i), GA1A12S202_LUX64(i+64), GA1A12S202_LUX64(i+128), GA1A12S202_LUX64(i+192)
+
+static_assert(GA1A12S202_RAW_RANGE == 1024, "luxTable is written out for 1024 readings");
+
+//fixed point lux for every analog reading. 4KB of flash instead of a call to pow for every reading.
+static const uint32_t luxTable[GA1A12S202_RAW_RANGE] PROGMEM = {
+    GA1A12S202_LUX256(0), GA1A12S202_LUX256(256), GA1A12S202_LUX256(512), GA1A12S202_LUX256(768)
+};
+
 /**
 Adafruit_GA1A12S202::Adafruit_GA1A12S202 (int8_t pin)
-  Sets the pin the sensor is connected too. sets raw range to 1024 and logRange to 5.0.
-  Sets analog reference for the arduino board to external. That is now the analog reference 
+  Sets the pin the sensor is connected too. Sets analog reference for the arduino board to external. That is now the analog reference 
   will be read from the AREF pin. This needs to be 3.3 volts.
   
   @param int8_t pin    The pin the sensor is connected too.
 */
 Adafruit_GA1A12S202::Adafruit_GA1A12S202 (int8_t pin){
     sensorPin = pin;
-    rawRange = 1024;
-    logRange = 5.0;
+    sampler = NULL;
     analogReference(EXTERNAL);
 }
 /**
@@ -23,7 +49,36 @@ float Adafruit_GA1A12S202::readLux (void)
 
 */
 float Adafruit_GA1A12S202::readLux (void){
-    return rawToLux (analogRead (sensorPin));
+    return rawToLux (readRaw ());
+}
+
+/**
+void Adafruit_GA1A12S202::setSampler (AnalogSampler* samplerPtr)
+  Takes readings from a free running analog sampler. A reading is then always waiting and has
+  GA1A12S202_EXTRA_BITS more bits than analogRead.
+  
+  @param AnalogSampler* samplerPtr    The sampler converting the pin of the sensor.
+*/
+void Adafruit_GA1A12S202::setSampler (AnalogSampler* samplerPtr){
+    sampler = samplerPtr;
+}
+
+/**
+int Adafruit_GA1A12S202::readRaw (void)
+  retuns the current analog reading from the sensor, 0 to GA1A12S202_RAW_RANGE-1 with
+  GA1A12S202_EXTRA_BITS fractional bits. The newest oversampled reading is returned straight away
+  once a sampler is set, until then one blocking analogRead is made.
+  
+  @param void
+  
+  @return int    the current raw value of the sensor.
+
+*/
+int Adafruit_GA1A12S202::readRaw (void){
+    if (sampler != NULL){
+        return (*sampler).read();
+    }
+    return analogRead (sensorPin) << GA1A12S202_EXTRA_BITS;
 }
 
 
@@ -36,6 +91,65 @@ float Adafruit_GA1A12S202::rawToLux (int raw)
   @return float      The converted value.
 */
 float Adafruit_GA1A12S202::rawToLux (int raw){
-    float logLux = raw * logRange / rawRange;
-    return pow(10, logLux);
+    return rawToLuxFixed(raw) * (1.0 / (1UL << GA1A12S202_LUX_FRAC_BITS));
+}
+
+/**
+uint32_t Adafruit_GA1A12S202::rawToLuxFixed (int raw)
+  converts analog reading to a fixed point lux value by looking up the steps either side of it in
+  luxTable and interpolating between them with the fractional bits. One step is only 1.1% more lux
+  than the last so a straight line between them is well within the accuracy of the sensor. The
+  interpolation is rounded so luxToRawFixed gives back the same reading. Readings outside of 0 to GA1A12S202_RAW_RANGE-1 are clamped.
+  
+  @param int raw    the raw analog reading with GA1A12S202_EXTRA_BITS fractional bits.
+  
+  @return uint32_t   The converted value with GA1A12S202_LUX_FRAC_BITS fractional bits.
+*/
+uint32_t Adafruit_GA1A12S202::rawToLuxFixed (int raw){
+    if (raw < 0){
+        raw = 0;
+    }
+    int step = raw >> GA1A12S202_EXTRA_BITS;
+    uint8_t fraction = raw & ((1 << GA1A12S202_EXTRA_BITS) - 1);
+    if (step >= GA1A12S202_RAW_RANGE - 1){
+        return pgm_read_dword(&luxTable[GA1A12S202_RAW_RANGE - 1]);
+    }
+    uint32_t low = pgm_read_dword(&luxTable[step]);
+    uint32_t high = pgm_read_dword(&luxTable[step + 1]);
+    return low + (((high - low) * fraction + (1 << (GA1A12S202_EXTRA_BITS - 1))) >> GA1A12S202_EXTRA_BITS);
+}
+
+/**
+int Adafruit_GA1A12S202::luxToRawFixed (uint32_t lux)
+  The reverse of rawToLuxFixed. The step below lux is found with a binary search of luxTable and
+  the fractional bits are the nearest point on the straight line to the next step, so
+  rawToLuxFixed gives back lux to within a fraction of a step.
+  
+  @param uint32_t lux    the lux with GA1A12S202_LUX_FRAC_BITS fractional bits.
+  
+  @return int   The analog reading with GA1A12S202_EXTRA_BITS fractional bits.
+*/
+int Adafruit_GA1A12S202::luxToRawFixed (uint32_t lux){
+    if (lux <= pgm_read_dword(&luxTable[0])){
+        return 0;
+    }
+    if (lux >= pgm_read_dword(&luxTable[GA1A12S202_RAW_RANGE - 1])){
+        return (GA1A12S202_RAW_RANGE - 1) << GA1A12S202_EXTRA_BITS;
+    }
+    //luxTable[low] <= lux < luxTable[high]
+    int low = 0;
+    int high = GA1A12S202_RAW_RANGE - 1;
+    while (high - low > 1){
+        int middle = (low + high) / 2;
+        if (pgm_read_dword(&luxTable[middle]) <= lux){
+            low = middle;
+        }
+        else{
+            high = middle;
+        }
+    }
+    uint32_t lowLux = pgm_read_dword(&luxTable[low]);
+    uint32_t stepLux = pgm_read_dword(&luxTable[high]) - lowLux;
+    uint32_t fraction = (((lux - lowLux) << GA1A12S202_EXTRA_BITS) + stepLux / 2) / stepLux;
+    return (low << GA1A12S202_EXTRA_BITS) + fraction;
 }
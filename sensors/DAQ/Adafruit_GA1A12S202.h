@@ -6,6 +6,17 @@
 
 #ifndef ADAFRUIT_GA1A12S202_H
 #define ADAFRUIT_GA1A12S202_H
+#include <avr/pgmspace.h>
+#include "AnalogSampler.h"     //free running oversampled ADC
+
+// global constants for this class. All constants contributed to this class will begin with GA1A12S202_
+// the analog reading covers GA1A12S202_LOG_RANGE decades of lux over GA1A12S202_RAW_RANGE steps.
+#define GA1A12S202_RAW_RANGE 1024
+#define GA1A12S202_LOG_RANGE 5.0
+// raw readings are oversampled, they have this many bits below one step of the analog reading
+#define GA1A12S202_EXTRA_BITS ANALOGSAMPLER_EXTRA_BITS
+// fixed point lux readings have this many fractional bits, 1 lux is 1024
+#define GA1A12S202_LUX_FRAC_BITS 10
 
 /**
 Class: Adafruit_GA1A12S202
@@ -16,21 +27,37 @@ Constructor:
 Public Function:
   float readLux (void)
     postcondition: returns the converted reading from the sensor.
-Private Functions:
+  void setSampler (AnalogSampler* samplerPtr)
+    precondition: samplerPtr has been set up to convert the pin of the sensor.
+    postcondition: readings are taken from samplerPtr instead of analogRead.
+  int readRaw (void)
+    postcondition: returns the raw analog reading from the sensor, with GA1A12S202_EXTRA_BITS
+      fractional bits.
   float rawToLux (int raw)
     postcondition: the raw analog reading is convered via a log scale to a lux reading.
+  static uint32_t rawToLuxFixed (int raw)
+    postcondition: returns the lux reading for the raw analog reading as a fixed point number with
+      GA1A12S202_LUX_FRAC_BITS fractional bits. The lux for every step of the analog reading is
+      calculated at compile time and stored in a table in flash, the fractional bits of raw are
+      interpolated between steps. No float math is done.
+  static int luxToRawFixed (uint32_t lux)
+    postcondition: returns the raw analog reading, with GA1A12S202_EXTRA_BITS fractional bits, that
+      rawToLuxFixed turns into the nearest lux to lux. Lux outside of the table is clamped.
 */
 class Adafruit_GA1A12S202{
   public:
     Adafruit_GA1A12S202 (int8_t pin);
     
     float readLux (void);
+    void setSampler (AnalogSampler* samplerPtr);
+    int readRaw (void);
+    float rawToLux (int raw);
+    static uint32_t rawToLuxFixed (int raw);
+    static int luxToRawFixed (uint32_t lux);
     
   private:
       int8_t sensorPin;
-      float rawRange;
-      float logRange;
-      float rawToLux (int raw);
+      AnalogSampler* sampler;
 };
 
 #endif
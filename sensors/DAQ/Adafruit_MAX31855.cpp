@@ -21,6 +21,18 @@
 
 
 
+// writes to the cached port registers are read-modify-write, keep an
+// interrupt from changing another pin on the same port in between.
+static inline void writePin(volatile uint8_t *port, uint8_t mask, uint8_t level) {
+  uint8_t oldSREG = SREG;
+  cli();
+  if (level)
+    *port |= mask;
+  else
+    *port &= ~mask;
+  SREG = oldSREG;
+}
+
 Adafruit_MAX31855::Adafruit_MAX31855(int8_t SCLK, int8_t CS, int8_t MISO) {
   sclk = SCLK;
   cs = CS;
@@ -32,16 +44,48 @@ Adafruit_MAX31855::Adafruit_MAX31855(int8_t SCLK, int8_t CS, int8_t MISO) {
   pinMode(miso, INPUT);
 
   digitalWrite(cs, HIGH);
+
+  sclkPort = portOutputRegister(digitalPinToPort(sclk));
+  sclkMask = digitalPinToBitMask(sclk);
+  csPort = portOutputRegister(digitalPinToPort(cs));
+  csMask = digitalPinToBitMask(cs);
+  misoPin = portInputRegister(digitalPinToPort(miso));
+  misoMask = digitalPinToBitMask(miso);
 }
 
 void Adafruit_MAX31855::changeCS(int newCS){
   cs = newCS;
+  csPort = portOutputRegister(digitalPinToPort(cs));
+  csMask = digitalPinToBitMask(cs);
 }
 
 double Adafruit_MAX31855::readInternal(void) {
-  uint32_t v;
-  
-  v = spiread32();
+  return frameToInternal(spiread32());
+}
+
+double Adafruit_MAX31855::readCelsius(void) {
+  return frameToCelsius(spiread32());
+}
+
+uint8_t Adafruit_MAX31855::readError() {
+  return frameToError(spiread32());
+}
+
+double Adafruit_MAX31855::readFarenheit(void) {
+  float f = readCelsius();
+  f *= 9.0;
+  f /= 5.0;
+  f += 32;
+  return f;
+}
+
+uint32_t Adafruit_MAX31855::readFrame(void) {
+  return spiread32();
+}
+
+double Adafruit_MAX31855::frameToInternal(uint32_t frame) {
+  uint32_t v = frame;
+
   // ignore bottom 4 bits - they're just thermocouple data
   v >>= 4;
 
@@ -55,22 +99,12 @@ double Adafruit_MAX31855::readInternal(void) {
   return internal;
 }
 
-double Adafruit_MAX31855::readCelsius(void) {
-
-  int32_t v;
+double Adafruit_MAX31855::frameToCelsius(uint32_t frame) {
 
-  v = spiread32();
+  int32_t v = frame;
 
   //Serial.print("0x"); Serial.println(v, HEX);
 
-  /*
-  float internal = (v >> 4) & 0x7FF;
-  internal *= 0.0625;
-  if ((v >> 4) & 0x800) 
-    internal *= -1;
-  Serial.print("\tInternal Temp: "); Serial.println(internal);
-  */
-
   if (v & 0x7) {
     // uh oh, a serious problem!
     return NAN; 
@@ -87,42 +121,48 @@ double Adafruit_MAX31855::readCelsius(void) {
   return centigrade;
 }
 
-uint8_t Adafruit_MAX31855::readError() {
-  return spiread32() & 0x7;
+// the signed 14 bit thermocouple count, LSB = 0.25 degrees C
+int16_t Adafruit_MAX31855::frameToRaw(uint32_t frame) {
+  int32_t v = frame;
+  v >>= 18;
+  return v;
 }
 
-double Adafruit_MAX31855::readFarenheit(void) {
-  float f = readCelsius();
-  f *= 9.0;
-  f /= 5.0;
-  f += 32;
-  return f;
+// the signed 12 bit cold junction count, LSB = 0.0625 degrees C
+int16_t Adafruit_MAX31855::frameToInternalRaw(uint32_t frame) {
+  int16_t v = (frame >> 4) & 0xFFF;
+  // sign extend from bit 11
+  v <<= 4;
+  v >>= 4;
+  return v;
+}
+
+uint8_t Adafruit_MAX31855::frameToError(uint32_t frame) {
+  return frame & 0x7;
 }
 
-uint32_t Adafruit_MAX31855::spiread32(void) { 
+uint32_t Adafruit_MAX31855::spiread32(void) {
   int i;
   uint32_t d = 0;
 
-  digitalWrite(sclk, LOW);
-  _delay_ms(1);
-  digitalWrite(cs, LOW);
-  _delay_ms(1);
+  writePin(sclkPort, sclkMask, LOW);
+  writePin(csPort, csMask, LOW);
+  _delay_us(MAX31855_CS_SETUP_US);
 
   for (i=31; i>=0; i--)
   {
-    digitalWrite(sclk, LOW);
-    _delay_ms(1);
+    writePin(sclkPort, sclkMask, LOW);
+    _delay_us(MAX31855_HALF_CLOCK_US);
     d <<= 1;
-    if (digitalRead(miso)) {
+    if (*misoPin & misoMask) {
       d |= 1;
     }
 
-    digitalWrite(sclk, HIGH);
-    _delay_ms(1);
+    writePin(sclkPort, sclkMask, HIGH);
+    _delay_us(MAX31855_HALF_CLOCK_US);
   }
 
-  digitalWrite(cs, HIGH);
+  writePin(csPort, csMask, HIGH);
   //Serial.println(d, HEX);
   return d;
 }
-
@@ -24,6 +24,12 @@
 #ifndef ADAFRUIT_MAX31855_H
 #define ADAFRUIT_MAX31855_H
 
+// MAX31855 timing: SCK high and low time >= 100ns, CS fall to SCK rise >= 100ns,
+// SCK fall to data valid <= 40ns, max clock 5MHz. 1us covers all of these with
+// room to spare and still reads a frame in about 130us, see test/thermo.cpp.
+#define MAX31855_CS_SETUP_US 1
+#define MAX31855_HALF_CLOCK_US 1
+
 class Adafruit_MAX31855 {
  public:
   Adafruit_MAX31855(int8_t SCLK, int8_t CS, int8_t MISO);
@@ -34,9 +40,21 @@ class Adafruit_MAX31855 {
   double readFarenheit(void);
   uint8_t readError();
 
+  // one transaction, decode the fields with the frameTo functions below so the
+  // fault bits, thermocouple and internal temperatures all come from the same frame.
+  uint32_t readFrame(void);
+  static double frameToCelsius(uint32_t frame);
+  static int16_t frameToRaw(uint32_t frame);
+  static double frameToInternal(uint32_t frame);
+  static int16_t frameToInternalRaw(uint32_t frame);
+  static uint8_t frameToError(uint32_t frame);
+
 
  private:
   int8_t sclk, miso, cs;
+  // cached port registers so the bit-bang path doesn't go through digitalWrite
+  volatile uint8_t *sclkPort, *csPort, *misoPin;
+  uint8_t sclkMask, csMask, misoMask;
   uint32_t spiread32(void);
 };
 #endif
@@ -0,0 +1,110 @@
+/**
+Aggregator.cpp
+  Implementation for the Aggregator class.
+**/
+#include "Aggregator.h"
+
+/**
+Aggregator::Aggregator (void)
+  Constructor for the aggregator. No port is summarised until start is called.
+@param void
+@return
+**/
+Aggregator::Aggregator (void){
+    for (uint8_t port = 0; port < MEMORY_MAX_PORTS; port++){
+        window[port] = 1;
+        count[port] = 0;
+    }
+    sensors = NULL;
+}
+
+/**
+void Aggregator::start (uint8_t* windows, Sensor** sensorPtrs)
+  Sets the window of every port and empties them, called as an experiment starts or is recovered.
+  A window of 0, from an experiment block saved before windows were kept, is taken as 1.
+@param uint8_t* windows
+  The number of samples in a window of each port.
+@param Sensor** sensorPtrs
+  The sensor of each port, used to take the mean in its units.
+@return void
+**/
+void Aggregator::start (uint8_t* windows, Sensor** sensorPtrs){
+    sensors = sensorPtrs;
+    for (uint8_t port = 0; port < MEMORY_MAX_PORTS; port++){
+        window[port] = (windows[port] == 0) ? 1 : windows[port];
+        count[port] = 0;
+    }
+}
+
+/**
+boolean Aggregator::add (uint8_t port, int16_t sample, DataBlock* summary)
+  Adds a sample to the running min, max, sum and count of a port. Only the sum is kept, not the
+  samples, so a window costs the same RAM however long it is. The sum is of the sample converted
+  with rawToValue.
+@param uint8_t port
+  The port the sample is from, 0 to MEMORY_MAX_PORTS-1.
+@param int16_t sample
+  The sample in the sensors native units.
+@param DataBlock* summary
+  Where to store the summary if the window is full.
+@return boolean
+  True if the window was full and summary holds its summary.
+  False otherwise.
+**/
+boolean Aggregator::add (uint8_t port, int16_t sample, DataBlock* summary){
+    if (count[port] == 0){
+        low[port] = sample;
+        high[port] = sample;
+        sum[port] = 0;
+    }
+    low[port] = min(low[port], sample);
+    high[port] = max(high[port], sample);
+    sum[port] += (*sensors[port]).rawToValue(sample);
+    count[port]++;
+    if (count[port] < window[port]){
+        return false;
+    }
+    summarise(port, summary);
+    return true;
+}
+
+/**
+boolean Aggregator::close (uint8_t port, DataBlock* summary)
+  Ends the window of a port early, as an experiment stops, so its last samples are not lost.
+@param uint8_t port
+  The port to close, 0 to MEMORY_MAX_PORTS-1.
+@param DataBlock* summary
+  Where to store the summary of the window.
+@return boolean
+  True if the window held samples and summary holds their summary.
+  False if it was empty.
+**/
+boolean Aggregator::close (uint8_t port, DataBlock* summary){
+    if (count[port] == 0){
+        return false;
+    }
+    summarise(port, summary);
+    return true;
+}
+
+/**
+void Aggregator::summarise (uint8_t port, DataBlock* summary)
+  Stores the summary of the window of a port and empties it. The mean is rounded in the units of
+  the sensor and turned back into the nearest native unit. The 64 bit division is slow on the AVR
+  but is only made once a window.
+@param uint8_t port
+  The port to summarise, its window must hold samples.
+@param DataBlock* summary
+  Where to store the summary.
+@return void
+**/
+void Aggregator::summarise (uint8_t port, DataBlock* summary){
+    int32_t half = (sum[port] < 0) ? -(count[port] / 2) : count[port] / 2;
+    int32_t mean = (sum[port] + half) / count[port];
+    (*summary).portMask = (1 << port);
+    (*summary).data[port] = (*sensors[port]).valueToRaw(mean);
+    (*summary).low = low[port];
+    (*summary).high = high[port];
+    (*summary).count = count[port];
+    count[port] = 0;
+}
@@ -0,0 +1,74 @@
+/**
+Aggregator.h
+  Class definiton for the Aggregator class.
+**/
+#if (ARDUINO >= 100)
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#ifndef AGGREGATOR_H
+#define AGGREGATOR_H
+#include "Memory.h"            //DataBlock
+#include "Sensor.h"            //rawToValue and valueToRaw for the mean
+
+// global constants for this class. All constants contributed to this class will begin with AGGREGATOR_
+// most samples in one window, the count of a summary is one byte
+#define AGGREGATOR_MAX_WINDOW 255
+
+/**
+Class: Aggregator
+  Sits between sampling and Memory. Keeps a running min, max, sum and count of the samples of each
+  port in RAM and hands back a summary once a port has a window of samples, so a port sampled every
+  second can be logged as one record a minute without losing its peaks. Each port has its own
+  window, a port with a window of 1 is not summarised and its samples are saved as they are.
+  Nothing is saved to EEPROM until a window is full, the samples of a window that was not full are
+  lost if the DAQ is reset. Ports are numbered from 0, the same as DataBlock::data. The min and
+  max are kept in the sensors native units. The mean is taken of the samples converted with
+  rawToValue, so it is the mean of the lux and not of the logarithmic readings of the light
+  sensor, and is saved as the nearest native unit with valueToRaw.
+Known Bug (fixed):
+  The mean used to be taken in native units, for the light sensor that is the geometric mean of
+  the lux, which is less than the mean whenever the light changes over a window.
+Constructor: Aggregator (void)
+  postcondition: every window is 1 and empty.
+Public Functions:
+  void start (uint8_t* windows, Sensor** sensorPtrs):
+    precondition: windows holds MEMORY_MAX_PORTS window sizes and sensorPtrs the sensor of each
+      port.
+    postcondition: port n is summarised every windows[n] samples, 0 is taken as 1, in the units of
+      sensorPtrs[n]. Every window is empty.
+  boolean isSummarised (uint8_t port):
+    postcondition: returns true if the samples of port are added to a window instead of being
+      saved.
+  boolean add (uint8_t port, int16_t sample, DataBlock* summary):
+    precondition: port is summarised.
+    postcondition: sample has been added to the window of port. If the window is now full the
+      summary of it has been stored in summary, the window is empty and true is returned. The
+      period number of summary is left for the caller to set.
+  boolean close (uint8_t port, DataBlock* summary):
+    postcondition: if the window of port holds any samples their summary has been stored in
+      summary, the window is empty and true is returned.
+**/
+class Aggregator{
+    public:
+    //constructor
+    Aggregator (void);
+    //public functions
+    void start (uint8_t* windows, Sensor** sensorPtrs);
+    boolean isSummarised (uint8_t port){return window[port] > 1;};
+    boolean add (uint8_t port, int16_t sample, DataBlock* summary);
+    boolean close (uint8_t port, DataBlock* summary);
+
+    private:
+    uint8_t window[MEMORY_MAX_PORTS];     //samples in a full window
+    uint8_t count[MEMORY_MAX_PORTS];      //samples in the window so far
+    int16_t low[MEMORY_MAX_PORTS];
+    int16_t high[MEMORY_MAX_PORTS];
+    int64_t sum[MEMORY_MAX_PORTS];        //sum of rawToValue, a window of lux does not fit 32 bits
+    Sensor** sensors;
+    void summarise (uint8_t port, DataBlock* summary);
+};
+
+#endif
@@ -0,0 +1,78 @@
+/**
+AnalogSampler.cpp
+  Implementation for the AnalogSampler class.
+**/
+#include "AnalogSampler.h"
+
+/**
+AnalogSampler::AnalogSampler (void)
+  Constructor for the analog sampler. The ADC is set up later by samplerSetup, the registers can
+  not be set before the Arduino core has started.
+@param void
+@return
+**/
+AnalogSampler::AnalogSampler (void){
+    sum = 0;
+    conversions = 0;
+    reading = 0;
+    ready = false;
+}
+
+/**
+void AnalogSampler::samplerSetup (uint8_t pin)
+  Starts the ADC converting pin over and over. The reference is the AREF pin, the same as
+  analogReference(EXTERNAL), the REFS bits are left at 0. The digital input buffer of the pin is
+  turned off, it only adds noise to an analog input. Waits for the first reading so a reading is
+  never taken before there is one, this takes 6.7 ms with 64 conversions.
+@param uint8_t pin
+  The analog pin to convert, A0 to A5.
+@return void
+**/
+void AnalogSampler::samplerSetup (uint8_t pin){
+    uint8_t channel = pin - A0;
+    sum = 0;
+    conversions = 0;
+    ready = false;
+    ADMUX = channel;
+    DIDR0 |= (1 << channel);
+    //free running, each conversion starts as the last one ends
+    ADCSRB = 0;
+    ADCSRA = (1 << ADEN) | (1 << ADSC) | (1 << ADATE) | (1 << ADIE) | ANALOGSAMPLER_PRESCALER;
+    uint32_t start = millis();
+    while (!ready && millis() - start < ANALOGSAMPLER_SETUP_TIMEOUT){
+    }
+}
+
+/**
+void AnalogSampler::conversionDone (void)
+  Adds a conversion to the sum. Summing 4^n conversions and shifting the sum right by n leaves n
+  more bits than one conversion, the noise of the conversions dithers the bits in between.
+@param void
+@return void
+**/
+void AnalogSampler::conversionDone (void){
+    sum += ADC;
+    if (++conversions < ANALOGSAMPLER_CONVERSIONS){
+        return;
+    }
+    reading = sum >> ANALOGSAMPLER_EXTRA_BITS;
+    ready = true;
+    sum = 0;
+    conversions = 0;
+}
+
+/**
+uint16_t AnalogSampler::read (void)
+  Returns the newest reading. inturrupts are turned off while it is copied so a reading the
+  inturrupt is updating is never read half old and half new.
+@param void
+@return uint16_t
+  The reading, 0 to ANALOGSAMPLER_RANGE-1.
+**/
+uint16_t AnalogSampler::read (void){
+    uint8_t oldSREG = SREG;
+    cli();
+    uint16_t value = reading;
+    SREG = oldSREG;
+    return value;
+}
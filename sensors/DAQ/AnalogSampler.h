@@ -0,0 +1,63 @@
+/**
+AnalogSampler.h
+  Class definiton for the AnalogSampler class.
+**/
+#if (ARDUINO >= 100)
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#ifndef ANALOGSAMPLER_H
+#define ANALOGSAMPLER_H
+
+// global constants for this class. All constants contributed to this class will begin with ANALOGSAMPLER_
+// bits of resolution added by oversampling, every extra bit takes 4 times as many conversions.
+// 2 sums 16 conversions, 3 sums 64. The sum of 64 10 bit conversions still fits in 16 bits.
+#define ANALOGSAMPLER_EXTRA_BITS 3
+#define ANALOGSAMPLER_CONVERSIONS (1 << (2*ANALOGSAMPLER_EXTRA_BITS))
+// readings are 0 to ANALOGSAMPLER_RANGE-1
+#define ANALOGSAMPLER_RANGE (1024 << ANALOGSAMPLER_EXTRA_BITS)
+// ADC clock of 16 MHz / 128 = 125 kHz, a conversion takes 13 ADC clocks, 104 us
+#define ANALOGSAMPLER_PRESCALER ((1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0))
+#define ANALOGSAMPLER_SETUP_TIMEOUT 20     //milliseconds to wait for the first reading
+
+/**
+Class: AnalogSampler
+  Keeps the ADC converting one analog pin in free running mode so a reading is always waiting. The
+  ADC inturrupt adds each conversion to a sum, every ANALOGSAMPLER_CONVERSIONS conversions the sum
+  is decimated to a reading with ANALOGSAMPLER_EXTRA_BITS more bits than one conversion. The noise
+  of a single conversion is averaged out and reading costs a 16 bit copy instead of the 110 us of
+  blocking analogRead. A new reading is ready every 6.7 ms with 64 conversions. Once started
+  analogRead must not be used, it would change the channel of the running ADC.
+Constructor: AnalogSampler (void)
+  postcondition: the ADC is not started, read returns 0.
+Public Functions:
+  void samplerSetup (uint8_t pin):
+    precondition: pin is an analog pin, A0 to A5. The analog reference is the AREF pin.
+    postcondition: the ADC is converting pin in free running mode and the first reading has been
+      taken.
+  void conversionDone (void):
+    precondition: only called from the ADC inturrupt.
+    postcondition: the conversion has been added to the sum, if it was the last of a reading the
+      reading has been updated and the sum emptied.
+  uint16_t read (void):
+    postcondition: returns the newest reading, 0 to ANALOGSAMPLER_RANGE-1, without waiting.
+**/
+class AnalogSampler{
+    public:
+    //constructor
+    AnalogSampler (void);
+    //public functions
+    void samplerSetup (uint8_t pin);
+    void conversionDone (void);
+    uint16_t read (void);
+
+    private:
+    uint16_t sum;                 //sum of the conversions of the reading being taken
+    uint8_t conversions;          //conversions in sum
+    volatile uint16_t reading;    //the newest decimated reading
+    volatile boolean ready;       //true once the first reading has been taken
+};
+
+#endif
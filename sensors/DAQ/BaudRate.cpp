@@ -0,0 +1,107 @@
+/**
+BaudRate.cpp
+  Implementation for the BaudRate class.
+**/
+#include "BaudRate.h"
+#include "miniSDI_12.h"
+#include <avr/pgmspace.h>
+
+//supported rates, the index is the code of the rate
+static const uint32_t baudRates[BAUD_RATES] PROGMEM = {9600, 19200, 38400, 57600, 115200, 250000};
+
+/**
+BaudRate::BaudRate (void)
+  Constructor for the baud rate. Does nothing, baudSetup starts the serial port.
+@param void
+@return
+**/
+BaudRate::BaudRate (void){
+
+}
+
+/**
+void BaudRate::baudSetup (void)
+  Starts the serial port at BAUD_DEFAULT, the rate the SCIO app opens the port at.
+Known Bug (fixed):
+  The DAQ used to start at the last rate that had been confirmed, saved in the settings block. A
+  master that opened the port at BAUD_DEFAULT could not reach it for BAUD_TIMEOUT after every
+  start, and the first command it sent was lost. The master now asks for a faster rate each time
+  it connects instead.
+@param void
+@return void
+**/
+void BaudRate::baudSetup (void){
+    begin(BAUD_DEFAULT_CODE);
+}
+
+/**
+void BaudRate::setBaud (uint32_t rate)
+  Responds to an S command. The response is sent at the old rate and the last byte has left the
+  UART before the rate is changed, the master switches once it has the response. BAUD_DEFAULT is
+  not put on trial, it is what the DAQ falls back to anyway.
+@param uint32_t rate
+  The rate asked for.
+@return void
+**/
+void BaudRate::setBaud (uint32_t rate){
+    for (uint8_t newCode = 0; newCode < BAUD_RATES; newCode++){
+        if (codeToBaud(newCode) == rate){
+            respond(0, rate);
+            Serial.flush();
+            begin(newCode);
+            return;
+        }
+    }
+    respond(SDI_ABORT);
+}
+
+/**
+void BaudRate::commandReceived (void)
+  A valid command at the current rate shows the master is using it, it is kept until the DAQ
+  restarts or another rate is asked for.
+@param void
+@return void
+**/
+void BaudRate::commandReceived (void){
+    onTrial = false;
+}
+
+/**
+void BaudRate::serviceBaud (void)
+  Falls back to BAUD_DEFAULT if the master has not sent a valid command since the rate changed.
+@param void
+@return void
+**/
+void BaudRate::serviceBaud (void){
+    if (onTrial && millis() - trialStart > BAUD_TIMEOUT){
+        begin(BAUD_DEFAULT_CODE);
+    }
+}
+
+/**
+void BaudRate::begin (uint8_t newCode)
+  Restarts the serial port at a new rate. Anything waiting in the receive buffer was sent at the
+  old rate and is thrown away.
+@param uint8_t newCode
+  The index of the new rate.
+@return void
+**/
+void BaudRate::begin (uint8_t newCode){
+    code = newCode;
+    Serial.end();
+    Serial.begin(codeToBaud(code));
+    onTrial = (code != BAUD_DEFAULT_CODE);
+    trialStart = millis();
+}
+
+/**
+uint32_t BaudRate::codeToBaud (uint8_t code)
+  Looks up the rate for a code.
+@param uint8_t code
+  The index of the rate, must be less than BAUD_RATES.
+@return uint32_t
+  The rate.
+**/
+uint32_t BaudRate::codeToBaud (uint8_t code){
+    return pgm_read_dword(&baudRates[code]);
+}
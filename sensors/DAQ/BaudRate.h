@@ -0,0 +1,75 @@
+/**
+BaudRate.h
+  Class definiton for the BaudRate class.
+**/
+#if (ARDUINO >= 100)
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#ifndef BAUDRATE_H
+#define BAUDRATE_H
+
+// global constants for this class. All constants contributed to this class will begin with BAUD_
+// the rate the DAQ starts at and falls back to. The SCIO app always opens the port at this rate.
+#define BAUD_DEFAULT 9600
+#define BAUD_DEFAULT_CODE 0
+// number of supported rates, see baudRates in BaudRate.cpp
+#define BAUD_RATES 6
+// milliseconds a new rate is kept without receiving a valid command
+#define BAUD_TIMEOUT 3000
+
+/**
+Class: BaudRate
+  Manages the serial baud rate. The DAQ always starts at BAUD_DEFAULT. The master can ask for a
+  faster rate with the S command, the DAQ acknowledges at the old rate, switches, and then waits
+  for a valid command at the new rate. If none arrives within BAUD_TIMEOUT milliseconds the master
+  did not follow, the DAQ falls back to BAUD_DEFAULT so it can always be reached. No rate is
+  saved, the master asks for its rate again every time it connects.
+  The rates supported are those the Uno's 16MHz clock can make within 2.1%: 9600, 19200, 38400,
+  57600, 115200 and 250000.
+Constructor: BaudRate (void)
+  postcondition: object has been created. baudSetup must be called before it is used.
+Public Functions:
+  void baudSetup (void):
+    postcondition: the serial port has been started at BAUD_DEFAULT.
+  void setBaud (uint32_t rate):
+    postcondition: if rate is supported it has been acknowledged at the old rate and the serial port
+      switched to it. Otherwise an abort response is sent and the rate is not changed.
+  void commandReceived (void):
+    precondition: called every time a valid command is received.
+    postcondition: the current rate is confirmed if it was on trial.
+  void serviceBaud (void):
+    precondition: called from the main loop.
+    postcondition: if the current rate has been on trial for longer than BAUD_TIMEOUT the serial port
+      has been switched back to BAUD_DEFAULT.
+  uint32_t getBaud (void):
+    postcondition: returns the current rate.
+Private Functions:
+  void begin (uint8_t code):
+    postcondition: the serial port has been restarted at rate code and the trial has started unless
+      code is BAUD_DEFAULT_CODE.
+  uint32_t codeToBaud (uint8_t code):
+    postcondition: returns the rate for code.
+**/
+class BaudRate{
+    public:
+    //constructor
+    BaudRate (void);
+    //public functions
+    void baudSetup (void);
+    void setBaud (uint32_t rate);
+    void commandReceived (void);
+    void serviceBaud (void);
+    uint32_t getBaud (void){return codeToBaud(code);};
+
+    private:
+    uint8_t code;               //index of the current rate
+    boolean onTrial;            //true until a valid command arrives at the current rate
+    uint32_t trialStart;        //millis() when the current rate was started
+    void begin (uint8_t newCode);
+    uint32_t codeToBaud (uint8_t code);
+};
+
+#endif
@@ -0,0 +1,80 @@
+/**
+CommandParser.cpp
+  Implementation for the CommandParser class.
+**/
+#include "CommandParser.h"
+
+/**
+CommandParser::CommandParser (void)
+  Constructor for the command parser. Starts with an empty buffer.
+@param void
+@return
+**/
+CommandParser::CommandParser (void){
+    length = 0;
+    overflow = false;
+    lastByte = 0;
+    command = 0;
+    port = 0;
+    number = 0;
+    count = SDI_NO_COUNT;
+}
+
+/**
+uint8_t CommandParser::poll (void)
+  Feeds the bytes waiting in the serial port to the parser. Stops as soon as a command is complete
+  so it can be run before the next one is read. A partly received command only times out when no
+  byte has arrived for SDI_COMMAND_TIMEOUT milliseconds, bytes already waiting are read first.
+Known Bug (fixed):
+  The timeout used to be checked before the waiting bytes were read, a command whose end was in the
+  serial buffer was thrown away if the main loop had been busy for longer than the timeout.
+@param void
+@return uint8_t
+  PARSER_COMMAND if a command was received.
+  PARSER_ERROR if a bad command was received or a partly received command timed out.
+  PARSER_NONE otherwise.
+**/
+uint8_t CommandParser::poll (void){
+    uint8_t result = PARSER_NONE;
+    while (result == PARSER_NONE && Serial.available() > 0){
+        result = feed(Serial.read());
+    }
+    if (result == PARSER_NONE && (length > 0 || overflow) && millis() - lastByte > SDI_COMMAND_TIMEOUT){
+        length = 0;
+        overflow = false;
+        return PARSER_ERROR;
+    }
+    return result;
+}
+
+/**
+uint8_t CommandParser::feed (char c)
+  Adds one byte to the command being received. A ";" ends the command, it is parsed and the
+  buffer is emptied for the next one.
+@param char c
+  The byte received.
+@return uint8_t
+  PARSER_COMMAND if c ended a good command.
+  PARSER_ERROR if c ended a bad or too long command.
+  PARSER_NONE otherwise.
+**/
+uint8_t CommandParser::feed (char c){
+    lastByte = millis();
+    if (c != ';'){
+        if (length < SDI_COMMAND_LENGTH){
+            buffer[length++] = c;
+        }
+        else{
+            overflow = true;
+        }
+        return PARSER_NONE;
+    }
+    uint8_t received = length;
+    boolean tooLong = overflow;
+    length = 0;
+    overflow = false;
+    if (tooLong || !parseCommand(buffer, received, &command, &port, &number, &count)){
+        return PARSER_ERROR;
+    }
+    return PARSER_COMMAND;
+}
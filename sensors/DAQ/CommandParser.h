@@ -0,0 +1,72 @@
+/**
+CommandParser.h
+  Class definiton for the CommandParser class.
+**/
+#if (ARDUINO >= 100)
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#ifndef COMMANDPARSER_H
+#define COMMANDPARSER_H
+#include "miniSDI_12.h"
+
+// global constants for this class. All constants contributed to this class will begin with PARSER_
+// results returned by feed and poll
+#define PARSER_NONE 0        // no complete command yet
+#define PARSER_COMMAND 1     // a command was received, see getCommand, getPort, getNumber and getCount
+#define PARSER_ERROR 2       // a bad, too long or timed out command was received
+
+/**
+Class: CommandParser
+  Receives miniSDI_12 commands one byte at a time. Bytes are kept in a buffer between calls until
+  the ";" that ends a command arrives, the command is then parsed with parseCommand straight away.
+  Nothing ever waits for a byte that has not arrived yet so the main loop keeps running while a
+  command trickles in. A command that is longer than SDI_COMMAND_LENGTH is thrown away up to its
+  ";". A partly received command that gets no more bytes for SDI_COMMAND_TIMEOUT milliseconds is
+  thrown away, the same as the blocking read it replaces.
+Constructor: CommandParser (void)
+  postcondition: the buffer is empty.
+Public Functions:
+  uint8_t poll (void):
+    postcondition: bytes waiting in the serial port have been fed to the parser, stopping after the
+      first complete command. Returns PARSER_ERROR if a partly received command got no byte for
+      SDI_COMMAND_TIMEOUT milliseconds, otherwise the result of the last call to feed.
+  uint8_t feed (char c):
+    postcondition: c has been added to the command. Returns PARSER_COMMAND or PARSER_ERROR if c
+      ended a command, otherwise PARSER_NONE.
+  char getCommand (void):
+    postcondition: returns the command letter of the last command, 0 for an acknowledge.
+  uint8_t getPort (void):
+    postcondition: returns the port address of the last command.
+  uint32_t getNumber (void):
+    postcondition: returns the number after the command letter of the last command.
+  uint32_t getCount (void):
+    postcondition: returns the number after the comma of the last command, SDI_NO_COUNT if it had
+      none.
+**/
+class CommandParser{
+    public:
+    //constructor
+    CommandParser (void);
+    //public functions
+    uint8_t poll (void);
+    uint8_t feed (char c);
+    char getCommand (void){return command;};
+    uint8_t getPort (void){return port;};
+    uint32_t getNumber (void){return number;};
+    uint32_t getCount (void){return count;};
+
+    private:
+    char buffer[SDI_COMMAND_LENGTH];
+    uint8_t length;
+    boolean overflow;           //true if the command being received did not fit in buffer
+    uint32_t lastByte;          //millis() when the last byte was received
+    char command;
+    uint8_t port;
+    uint32_t number;
+    uint32_t count;
+};
+
+#endif
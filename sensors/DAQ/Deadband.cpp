@@ -0,0 +1,63 @@
+/**
+Deadband.cpp
+  Implementation for the Deadband class.
+**/
+#include "Deadband.h"
+
+/**
+Deadband::Deadband (void)
+  Constructor for the deadband. Every port keeps every sample until start is called.
+@param void
+@return
+**/
+Deadband::Deadband (void){
+    for (uint8_t port = 0; port < MEMORY_MAX_PORTS; port++){
+        band[port] = 0;
+        silence[port] = 1;
+    }
+    kept = 0;
+}
+
+/**
+void Deadband::start (uint8_t* bands, uint16_t* silences)
+  Sets the deadband and maximum silence of every port, called as an experiment starts or is
+  recovered. No port has a last kept sample so the next sample of each is kept.
+@param uint8_t* bands
+  The deadband of each port in native units.
+@param uint16_t* silences
+  The most periods between kept samples of each port, 0 for no limit.
+@return void
+**/
+void Deadband::start (uint8_t* bands, uint16_t* silences){
+    for (uint8_t port = 0; port < MEMORY_MAX_PORTS; port++){
+        band[port] = bands[port];
+        silence[port] = silences[port];
+    }
+    kept = 0;
+}
+
+/**
+boolean Deadband::keep (uint8_t port, int16_t sample, uint32_t period)
+  Checks a sample against the last kept sample of its port. The change is worked out in 32 bits
+  so samples at opposite ends of the 16 bit range do not wrap.
+@param uint8_t port
+  The port the sample is from, 0 to MEMORY_MAX_PORTS-1.
+@param int16_t sample
+  The sample in the sensors native units.
+@param uint32_t period
+  The period the sample was taken in.
+@return boolean
+  True if the sample is to be saved.
+  False if it is in the deadband.
+**/
+boolean Deadband::keep (uint8_t port, int16_t sample, uint32_t period){
+    int32_t change = (int32_t)sample - last[port];
+    if ((kept & (1 << port)) && change <= band[port] && -change <= band[port]
+        && (silence[port] == 0 || period - lastPeriod[port] < silence[port])){
+        return false;
+    }
+    kept |= (1 << port);
+    last[port] = sample;
+    lastPeriod[port] = period;
+    return true;
+}
@@ -0,0 +1,57 @@
+/**
+Deadband.h
+  Class definiton for the Deadband class.
+**/
+#if (ARDUINO >= 100)
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#ifndef DEADBAND_H
+#define DEADBAND_H
+#include "Memory.h"            //MEMORY_MAX_PORTS
+
+// global constants for this class. All constants contributed to this class will begin with DEADBAND_
+// largest deadband in native units and longest silence in periods that can be set
+#define DEADBAND_MAX_BAND 255
+#define DEADBAND_MAX_SILENCE 65535
+
+/**
+Class: Deadband
+  Decides which samples are worth saving for change driven logging. A sample of a port is kept if it
+  differs from the last sample of the port that was kept by more than the deadband of the port, or
+  if the port has been silent for its maximum silence. Samples in between are dropped, a slow
+  changing temperature is saved a few times an hour instead of every period. Every kept sample is
+  saved with its own period number so its time is still known. The first sample of a port after
+  start is always kept, so nothing is lost by a reset but a few extra samples. Ports are numbered
+  from 0, the same as DataBlock::data.
+Constructor: Deadband (void)
+  postcondition: every sample is kept.
+Public Functions:
+  void start (uint8_t* bands, uint16_t* silences):
+    precondition: bands and silences hold MEMORY_MAX_PORTS settings.
+    postcondition: port n keeps samples that change by more than bands[n] native units, or that
+      come silences[n] periods or more after the last kept sample. A silence of 0 never forces a
+      sample to be kept, a silence of 1 keeps every sample. No sample has been kept yet.
+  boolean keep (uint8_t port, int16_t sample, uint32_t period):
+    postcondition: returns true if sample, taken in period, is to be saved. It is then the last
+      kept sample of port.
+**/
+class Deadband{
+    public:
+    //constructor
+    Deadband (void);
+    //public functions
+    void start (uint8_t* bands, uint16_t* silences);
+    boolean keep (uint8_t port, int16_t sample, uint32_t period);
+
+    private:
+    uint8_t band[MEMORY_MAX_PORTS];          //largest change in native units that is dropped
+    uint16_t silence[MEMORY_MAX_PORTS];      //periods after which a sample is always kept
+    uint8_t kept;                            //bit n is set once port n has kept a sample
+    int16_t last[MEMORY_MAX_PORTS];          //last sample kept
+    uint32_t lastPeriod[MEMORY_MAX_PORTS];   //period of the last sample kept
+};
+
+#endif
@@ -103,7 +103,7 @@ class EEPROMClassEx
 	
 	template <class T> int readBlock(int address, const T& value)
 	{		
-		eeprom_read_block((void*)&value, (const void*)address, sizeof(value));
+		eeprom_read_block((void*)&value, (const void*)(uintptr_t)address, sizeof(value));
 		return sizeof(value);
 	}
 	
@@ -119,7 +119,7 @@ class EEPROMClassEx
 	template <class T> int writeBlock(int address, const T& value)
 	{
 		if (!isWriteOk(address+sizeof(value))) return 0;
-		eeprom_write_block((void*)&value, (void*)address, sizeof(value));			  			  
+		eeprom_write_block((void*)&value, (void*)(uintptr_t)address, sizeof(value));			  			  
 		return sizeof(value);
 	}
 
@@ -10,75 +10,349 @@ Experiment::Experiment (void)
   @param void
 */
 Experiment::Experiment (void){
-    
+    liveCredit = 0;
+    reporting = false;
+    timing = false;
+    leadIn = false;
+    finished = false;
+    periodMs = EXPERIMENT_DEFAULT_PERIOD;
+    tickRate = 0;
+    for (uint8_t port = 0; port < PORT_MAX; port++){
+        dividers[port] = 1;
+        windows[port] = 1;
+        bands[port] = 0;
+        silences[port] = 1;
+    }
 }
 
 /**
-void Experiment::experimentSetup (Port* portsPtr, Memory* memPtr)
-  Stores pointers to memory and ports, calls intialization functions for hardware timers and RTC,
-  recovers previous experiment.
+void Experiment::experimentSetup (Port* portsPtr, Memory* memPtr, WallClock* clockPtr)
+  Stores pointers to memory, ports and the wall clock, calls intialization functions for hardware
+  timers and RTC, recovers previous experiment.
 
   @param Port* portsPtr    A pointer to a ports object
   @param Memory* memPtr    A pointer to a memory object
+  @param WallClock* clockPtr    A pointer to the wall clock ticked by the timer
   
   @return void
 */
-void Experiment::experimentSetup (Port* portsPtr, Memory* memPtr){
+void Experiment::experimentSetup (Port* portsPtr, Memory* memPtr, WallClock* clockPtr){
   ports = portsPtr;
   memory = memPtr;
-  timerSetup();
-  startClock();
-  recoverExperiment();
+  clock = clockPtr;
   #ifdef RTCset
-      // following line sets the RTC to the date & time this sketch was compiled
+      // following line sets the RTC to the date & time this sketch was compiled, before the wall
+      // clock is synced to it
       RTC_DS1307 RTC;
       RTC.adjust(DateTime(__DATE__, __TIME__));
   #endif
+  timerSetup();
+  startClock();
+  recoverExperiment();
 }
 
 /**
-void Experiment::setPeriod (uint32_t newPeriod)
-  Takes a newPeriod and checks boundry condidtions. Saves newPeriod to IRC1 register, 
-  the compare register for hardware timer/counter1. Experiment max is 2^16-1
+void Experiment::setPeriod (uint32_t seconds, uint32_t ms)
+  Takes a new period and checks boundry condidtions. The period is a number of seconds and
+  milliseconds, aPs!; for whole seconds and aPs,ms!; for anything shorter. Picks the timebase that
+  times it with setTimebase, a period that is not a whole number of seconds must fit in the 16 bit
+  timer at 4096 Hz, 16 seconds. A period of whole seconds can be as long as EXPERIMENT_MAX_PERIOD,
+  over 49 days. A period shorter than EXPERIMENT_MIN_PERIOD is refused, the main loop could not
+  save the samples as fast as they are due and the sample queue would overflow. Responds with the
+  seconds, and the milliseconds if there are any.
   
-  @param uint32_t newPeriod    The new period.
+  @param uint32_t seconds    The whole seconds of the new period.
+  @param uint32_t ms         The milliseconds of the new period, SDI_NO_COUNT for none.
   
   @return void
 */
-void Experiment::setPeriod (uint32_t newPeriod){
-    if (newPeriod > EXPERIMENT_MAX_PERIOD || experimentBlock.isRunning){
+void Experiment::setPeriod (uint32_t seconds, uint32_t ms){
+    if (ms == SDI_NO_COUNT){
+        ms = 0;
+    }
+    if (seconds > EXPERIMENT_MAX_PERIOD || ms > 999 || seconds*1000 + ms < EXPERIMENT_MIN_PERIOD
+        || experimentBlock.isRunning || reporting || !setTimebase(seconds*1000 + ms)){
         respond(0);
     }
+    else if (ms == 0){
+        periodMs = seconds*1000;
+        respond(0 , seconds);
+    }
     else{
-        EXPERIMENT_PERIOD = newPeriod;
-        respond(0 , newPeriod);
+        periodMs = seconds*1000 + ms;
+        respond(0 , seconds, ms);
     }
 }
 
 /**
-uint32_t Experiment::updateCurrentPeriod (void)
-  Updates the current period of the experiment and saves experiment block to EEPROM.
-  if it was the last period calls stop experiment.
-  
+void Experiment::setDivider (uint8_t port, uint32_t divider)
+  Sets how often a port is sampled by the next M experiment, aIn!; samples port a once every n
+  periods. All ports share the one timebase set by setPeriod, so a slow changing thermocouple can
+  be sampled far less often than a light sensor without filling the log. Each saved record holds
+  only the ports that were due, see dueMask. A divider of 1, the default, samples every period.
+  Responds with the port and the divider.
+
+  @param uint8_t port        The port to set, 0 for every port.
+  @param uint32_t divider    Periods between samples, 1 to EXPERIMENT_MAX_DIVIDER.
+
+  @return void
+*/
+void Experiment::setDivider (uint8_t port, uint32_t divider){
+    if (port > PORT_MAX || divider == 0 || divider > EXPERIMENT_MAX_DIVIDER
+        || experimentBlock.isRunning || reporting){
+        respond(0);
+        return;
+    }
+    for (uint8_t index = 0; index < PORT_MAX; index++){
+        if (port == 0 || port == index + 1){
+            dividers[index] = divider;
+        }
+    }
+    respond(port, divider);
+}
+
+/**
+void Experiment::setWindow (uint8_t port, uint32_t window)
+  Sets how many samples of a port the next M experiment saves as one summary, aWn!; saves port a
+  as the mean, min, max and count of every n samples. A light sensor sampled every second can be
+  logged once a minute without losing its peaks, which stretches the log by the window. Samples
+  are counted as they are taken so a port with a divider is summarised over n of its own samples.
+  A window of 1, the default, saves every sample. Responds with the port and the window.
+
+  @param uint8_t port        The port to set, 0 for every port.
+  @param uint32_t window     Samples in a summary, 1 to AGGREGATOR_MAX_WINDOW.
+
+  @return void
+*/
+void Experiment::setWindow (uint8_t port, uint32_t window){
+    if (port > PORT_MAX || window == 0 || window > AGGREGATOR_MAX_WINDOW
+        || experimentBlock.isRunning || reporting){
+        respond(0);
+        return;
+    }
+    for (uint8_t index = 0; index < PORT_MAX; index++){
+        if (port == 0 || port == index + 1){
+            windows[index] = window;
+        }
+    }
+    respond(port, window);
+}
+
+/**
+void Experiment::setDeadband (uint8_t port, uint32_t band, uint32_t silence)
+  Sets change driven logging of a port for the next M experiment, aHb,s!; only saves a sample of
+  port a that differs from the last one saved by more than b native units, or that comes s periods
+  after it. A temperature that holds steady is then saved every s periods instead of every
+  period, and any change bigger than b is still saved the period it is seen. The port is still
+  sampled every period it is due. Without s there is no limit on the silence. A silence of 1, the
+  default, saves every sample. Responds with the port, the deadband and the silence.
+
+  @param uint8_t port        The port to set, 0 for every port.
+  @param uint32_t band       The deadband in native units, 0 to DEADBAND_MAX_BAND.
+  @param uint32_t silence    Most periods between saved samples, 0 to DEADBAND_MAX_SILENCE,
+                             SDI_NO_COUNT or 0 for no limit.
+
+  @return void
+*/
+void Experiment::setDeadband (uint8_t port, uint32_t band, uint32_t silence){
+    if (silence == SDI_NO_COUNT){
+        silence = 0;
+    }
+    if (port > PORT_MAX || band > DEADBAND_MAX_BAND || silence > DEADBAND_MAX_SILENCE
+        || experimentBlock.isRunning || reporting){
+        respond(0);
+        return;
+    }
+    for (uint8_t index = 0; index < PORT_MAX; index++){
+        if (port == 0 || port == index + 1){
+            bands[index] = band;
+            silences[index] = silence;
+        }
+    }
+    respond(port, band, silence);
+}
+
+/**
+void Experiment::countStarted (void)
+  Called from the EXPERIMENT_COUNT_START inturrupt as the timer goes back to 0. Adds the count that
+  has ended to the wall clock. While an experiment is timing, the last count of a period ends it,
+  see periodElapsed. Then loads the length of the count that has just started into EXPERIMENT_TOP.
+  A period ends as the timer goes back to 0 and not as it reaches the top, which is a tick earlier.
+  The count that ends on the second an experiment starts on, see startOnSecond, starts the timing
+  instead of ending a period, and for an R experiment posts the token of the first report.
+  This inturrupt is always on so the wall clock keeps time between experiments.
+
   @param void
-  
-  @return uint32_t   the current period of the experiment.
+
+  @return void
+*/
+void Experiment::countStarted (void){
+    (*clock).countEnded();
+    if (leadIn){
+        leadIn = false;
+        timing = true;
+        if (reporting){
+            sampleQueue.post(0);
+        }
+    }
+    else if (timing && ++timerCount >= periodCounts){
+        timerCount = 0;
+        periodElapsed();
+    }
+    EXPERIMENT_TOP = nextTop();
+}
+
+/**
+uint16_t Experiment::nextTop (void)
+  Works out the EXPERIMENT_TOP of count timerCount of a period. A period longer than the 16 bit
+  timer is split into periodCounts counts of nearly the same length, the first longCounts of them
+  are one tick longer so they add up to the whole period. A period is rarely a whole number of ticks of the
+  fast timebases, 100ms is 409.6 ticks at 4096 Hz, so the fraction is added up every period and a
+  period is given an extra tick whenever it comes to a whole one. Periods are never more than one
+  tick out and never drift from the RTC. EXPERIMENT_TOP is only written as the timer goes back to
+  0, while the timer is still at the old top it would count on past a new one.
+
+  @param void
+
+  @return uint16_t    the top of the count.
 */
-uint32_t Experiment::updateCurrentPeriod (void){
+uint16_t Experiment::nextTop (void){
+    uint16_t top = countTop;
+    if (timerCount < longCounts){
+        top++;
+    }
+    if (timerCount == 0){
+        tickError += tickFraction;
+        if (tickError >= 1000){
+            tickError -= 1000;
+            top++;
+        }
+    }
+    return top;
+}
+
+/**
+void Experiment::periodElapsed (void)
+  Called from countStarted at the end of the last count of a period. Updates the current period
+  of the experiment and posts a sample due token for it. The sensors are not read here, reading
+  them and writing EEPROM takes far too long to do with inturrupts off. If it was the last period
+  the counts stop ending periods so no more tokens are posted and finished is set, so the main
+  loop ends the experiment even if the queue was full and the last token was dropped. The
+  experiment block is updated once the main loop has saved the last sample. R experiments are
+  clocked the same way.
+
+  @param void
+
+  @return void
+*/
+void Experiment::periodElapsed (void){
     currentPeriod ++;
-    (*memory).updateExperimentBlock(experimentBlock);
-    if (currentPeriod == experimentBlock.targetMeasurment){
-        stopExperiment();
+    sampleQueue.post(currentPeriod);
+    if (currentPeriod == lastPeriod){
+        timing = false;
+        finished = true;
     }
-    return currentPeriod;
+}
+
+/**
+void Experiment::serviceSamples (void)
+  Called from the main loop. Drains the sample queue, saving port data for each period that was
+  posted by the inturrupt. While the master has granted live credit each saved period is also sent
+  to it, time stamped the same way the D command would. Calls stop experiment once the last period
+  has been saved. While an R experiment is running port data is sent instead of saved, the last
+  report ends the R experiment. R reports are time stamped from the time of the first report so
+  reports less than a second apart each have their own time.
+Known Bug (fixed):
+  The experiment used to end only when the token of the last period was fetched. If the main loop
+  was held up long enough for the queue to fill, by a dump or a wait for the RTC, and the last
+  token was dropped, the timer had stopped but the experiment stayed running until a break
+  command. finished is read before the queue is drained, if it was set and the experiment is
+  still running once every token has been serviced the last period is serviced late.
+
+  @param void
+
+  @return void
+*/
+void Experiment::serviceSamples (void){
+    uint32_t period;
+    boolean lastPosted = finished;
+    while (sampleQueue.fetch(&period)){
+        servicePeriod(period);
+    }
+    if (lastPosted && (reporting || experimentBlock.isRunning)){
+        servicePeriod(lastPeriod);
+    }
+}
+
+/**
+void Experiment::servicePeriod (uint32_t period)
+  Saves, or sends for an R experiment, the port data of one period. Ends the experiment once the
+  last period has been serviced. Nothing is done if no experiment is running, a token left from an
+  experiment that has stopped is dropped.
+
+  @param uint32_t period    The period number.
+
+  @return void
+*/
+void Experiment::servicePeriod (uint32_t period){
+    if (reporting){
+        Timestamp time = Memory::periodTime(reportStart, periodMs, period);
+        (*ports).sendPortData(reportPort, period >= lastPeriod, &time);
+        if (period >= lastPeriod){
+            reporting = false;
+            finished = false;
+        }
+    }
+    else if (experimentBlock.isRunning){
+        Timestamp time;
+        Timestamp* liveTime = NULL;
+        if (liveCredit > 0){
+            liveCredit--;
+            time = Memory::periodTime(experimentBlock.startTime, experimentBlock.periodMs, period);
+            liveTime = &time;
+        }
+        (*ports).savePortData(experimentBlock.port, period, dueMask(period), liveTime);
+        if (period >= experimentBlock.targetMeasurment){
+            stopExperiment();
+        }
+    }
+}
+
+/**
+void Experiment::subscribe (uint32_t credit)
+  Subscribes the master to the running M experiment. Each period saved from now on is also sent to
+  the master as live data reports, marked with SDI_LIVE, until credit periods have been sent. The credit keeps a master that
+  has stopped reading from being flooded, it grants more by subscribing again before it runs out.
+  Responds with the credit granted, which is capped at EXPERIMENT_MAX_CREDIT.
+
+  @param uint32_t credit    The number of periods to send. 0 to end the subscription.
+
+  @return void
+*/
+void Experiment::subscribe (uint32_t credit){
+    if (!experimentBlock.isRunning){
+        respond(SDI_ABORT);
+        return;
+    }
+    liveCredit = (credit > EXPERIMENT_MAX_CREDIT) ? EXPERIMENT_MAX_CREDIT : credit;
+    respond(0, liveCredit);
 }
 
 /**
 void Experiment::startR (uint8_t port, uint32_t targetMeasurment)
-  Starts an R experiment. Checks running conditions. Uses Arduino delay function
-  to clock the experiment. Sends port data after every measurment. WARNING: this
-  function cannot be inturrupted - it will finish all requested measurments before
-  returning to the main program. This should only be used for a small number of measurments.
+  Starts an R experiment. Checks running conditions. Like an M experiment it starts as the wall
+  clock starts a new second, so every report is time stamped to the millisecond from the start.
+  Nothing waits for the second, the timer inturrupt posts the first report as it starts, see
+  startOnSecond. Every report is clocked by that inturrupt and sent from the main loop by
+  serviceSamples, so commands are still answered while it runs and a break command stops it. A
+  single measurment is sent straight away and is allowed while an M experiment is running, it does
+  not use the timer.
+Known Bug (fixed):
+  The timer used to be started part way through a second and the reports time stamped from the
+  start of that second, every report after the first was out by up to 999 ms.
+Known Bug (fixed):
+  The start used to wait in the main loop for the wall clock to start a new second, commands sent
+  in that time waited up to a second for an answer.
   
   @param uint8_t port    The desired port to measure. 0 for all ports.
   @param uint32_t targetMeasurment    The desired number of measurments.
@@ -87,23 +361,19 @@ void Experiment::startR (uint8_t port, uint32_t targetMeasurment)
 */
 void Experiment::startR (uint8_t port, uint32_t targetMeasurment){
     //running conditions.
-    if (experimentBlock.isRunning && targetMeasurment != 1){
+    if (targetMeasurment == 0 || reporting || (experimentBlock.isRunning && targetMeasurment != 1)){
         respond(0);
     }
+    else if (targetMeasurment == 1){
+        (*ports).sendPortData(port, true);
+    }
     else {
-        for (int i = 1; i <= targetMeasurment; i++){
-            (*ports).sendPortData(port);
-            if (i == targetMeasurment){
-                terminate();
-                endLine();
-            }
-            else{
-                endLine();
-            }
-            if (targetMeasurment != 1 && i != targetMeasurment){
-                delay (EXPERIMENT_PERIOD*1000);
-            }
-        }
+        reporting = true;
+        reportPort = port;
+        currentPeriod = 0;
+        lastPeriod = targetMeasurment - 1;
+        sampleQueue.clear();
+        reportStart = startOnSecond();
     }
 }
 
@@ -111,6 +381,9 @@ void Experiment::startR (uint8_t port, uint32_t targetMeasurment){
 void Experiment::startM (uint8_t port, uint32_t targetMeasurment)
   Starts and M experiment. Checks running conditions and parameters.
   Creates a new experiment block and updates the EEPROM. Clears EEPROM of old experiment data.
+  The experiment starts as the wall clock starts a new second, so the time of every period can be
+  worked out to the millisecond from the start time in the experiment block. Nothing waits for the
+  second, see startOnSecond, the response is sent straight away.
   WARMING: sucsussfully calling this function will result in the loss of old experiment data.
   
   @param uint8_t port    The desired port to measure. 0 for all ports.
@@ -120,56 +393,102 @@ void Experiment::startM (uint8_t port, uint32_t targetMeasurment)
 */
 void Experiment::startM (uint8_t port, uint32_t targetMeasurment){
     //running conditions and parameter check.
-    if (experimentBlock.isRunning || (!(*ports).isActive(port) && port !=0) || port > PORT_MAX || port < 0){
+    if (experimentBlock.isRunning || reporting || (!(*ports).isActive(port) && port !=0) || port > PORT_MAX){
         respond(SDI_ABORT);
     }
     else {
         currentPeriod = 0;
+        lastPeriod = targetMeasurment;
+        sampleQueue.clear();
         experimentBlock.isRunning = true;
         experimentBlock.port = port;
-        (*memory).reset();
-        experimentBlock.periodLgth = EXPERIMENT_PERIOD;
+        experimentBlock.logEpoch = (*memory).reset();
+        experimentBlock.periodMs = periodMs;
         experimentBlock.targetMeasurment = targetMeasurment;
-        RTC_DS1307 RTC;                                        //reading the time since i2c requires inturrupts                                  
-        experimentBlock.startTime = RTC.now().unixtime();     // set starting time
+        for (uint8_t index = 0; index < PORT_MAX; index++){
+            experimentBlock.dividers[index] = dividers[index];
+            experimentBlock.windows[index] = windows[index];
+            experimentBlock.bands[index] = bands[index];
+            experimentBlock.silences[index] = silences[index];
+        }
+        (*ports).startWindows(experimentBlock.windows);
+        (*ports).startDeadbands(experimentBlock.bands, experimentBlock.silences);
+        experimentBlock.startTime = startOnSecond();     // set starting time
         (*memory).updateExperimentBlock(experimentBlock);
-        TCNT1 = 0;         // clear timer1
-        TIFR1  |= (1 << ICF1);  // clear the inturrupt flag    
-        // set timer interupt on                               
-        TIMSK1 |= (1 << ICIE1); // start exp
+        uint32_t duration = Memory::periodTime(0, periodMs, targetMeasurment).seconds;
         if (port == 0){                           
-            respond (port*(*ports).getNumberActive(), EXPERIMENT_PERIOD*targetMeasurment, targetMeasurment);
+            respond (port*(*ports).getNumberActive(), duration, targetMeasurment);
         }
         else{
-            respond (port, EXPERIMENT_PERIOD*targetMeasurment, targetMeasurment);
+            respond (port, duration, targetMeasurment);
         }
     }
 }
 
 /**
 void Experiment::stopExperiment (void)
-  Stops experiments by turning off gloabl inturrupts. Updates experiment block and writes it to 
-  memory.
+  Stops experiments by stopping the counts of the timer ending periods. Tokens still in the sample
+  queue are dropped. Saves the summaries of any
+  windows that were not full. Updates experiment block and writes it to 
+  memory. Waits for every queued write to finish so the stopped experiment is safe in EEPROM. A
+  running R experiment is stopped without sending any more measurments.
   
   @param void
   
   @return void
 */
 void Experiment::stopExperiment (void){
-    // set timer interupt off
-    TIMSK1 &= (0 << ICIE1);
-    //clear is runnign flag
+    // stop ending periods, the count start inturrupt still keeps the wall clock, and drop the
+    // tokens of periods that have not been serviced
+    timing = false;
+    leadIn = false;
+    finished = false;
+    sampleQueue.clear();
+    //save what is left in the windows of an M experiment
+    if (experimentBlock.isRunning){
+        (*ports).closeWindows(currentPeriod);
+    }
+    //clear is runnign flag and end any subscription or R experiment
     experimentBlock.isRunning = false;
-    //update data header in memory
+    liveCredit = 0;
+    reporting = false;
+    //update data header in memory and wait for it and the last samples to be written
     (*memory).updateExperimentBlock(experimentBlock);
+    (*memory).flush();
+}
+
+/**
+uint8_t Experiment::dueMask (uint32_t period)
+  Works out which ports are sampled in period. A port is due when period is a multiple of its
+  divider, so each port is sampled on a steady period of its own that starts with the experiment.
+  A divider of 0, from an experiment block saved before dividers were kept, samples every period.
+
+  @param uint32_t period    The period number.
+
+  @return uint8_t    bit n is set if port n+1 is due.
+*/
+uint8_t Experiment::dueMask (uint32_t period){
+    uint8_t mask = 0;
+    for (uint8_t index = 0; index < PORT_MAX; index++){
+        uint8_t divider = experimentBlock.dividers[index];
+        if (divider <= 1 || period % divider == 0){
+            mask |= (1 << index);
+        }
+    }
+    return mask;
 }
 
 /**
 void Experiment::recoverExperiment (void)
   Loads the last experiment from memory. If the running curretnlyRunning bit is set
   calculates what the current period would be and starts experiment running. If the calculated
-  current period exceedes the desired number of measurments then the experiment is stopped.
-  Updates the experiment block in memory.
+  current period has reached the desired number of measurments, or the clock is now before the
+  start of the experiment, then the experiment is stopped. The timer is started where in the period
+  it should be once the wall clock starts a new second, when the time since the start is a whole number of
+  seconds, so a long period carries on from the right count. An experiment block with a period no
+  timebase can time is stopped. The windows of the ports start empty, the samples of a window
+  that was not full when the DAQ was reset are lost. The first sample of each port is saved
+  whatever its deadband. Updates the experiment block in memory.
   
   @param void
   
@@ -177,29 +496,146 @@ void Experiment::recoverExperiment (void)
 */
 void Experiment::recoverExperiment (void){
     (*memory).loadExperimentBlock(&experimentBlock);
-    if (experimentBlock.isRunning){
-        RTC_DS1307 RTC;
-        currentPeriod = ((RTC.now().unixtime()) - (experimentBlock.startTime)) / experimentBlock.periodLgth;
-        if (currentPeriod > experimentBlock.targetMeasurment){
-            stopExperiment();
-        }
-        EXPERIMENT_PERIOD = experimentBlock.periodLgth;
-        (*memory).updateExperimentBlock(experimentBlock);
-        TCNT1 = (RTC.now().unixtime() - experimentBlock.startTime) % experimentBlock.periodLgth;      // sets timer to where in the period it should be
+    if (!experimentBlock.isRunning){
+        return;
+    }
+    if (!setTimebase(experimentBlock.periodMs)){
+        stopExperiment();
+        return;
+    }
+    periodMs = experimentBlock.periodMs;
+    uint32_t now = (*clock).nextSecond();
+    currentPeriod = Memory::timePeriod(experimentBlock.startTime, periodMs, now);
+    if (now < experimentBlock.startTime || currentPeriod >= experimentBlock.targetMeasurment){
+        stopExperiment();
+        return;
+    }
+    lastPeriod = experimentBlock.targetMeasurment;
+    (*ports).startWindows(experimentBlock.windows);
+    (*ports).startDeadbands(experimentBlock.bands, experimentBlock.silences);
+    (*memory).updateExperimentBlock(experimentBlock);
+    // sets timer to where in the period it should be
+    Timestamp due = Memory::periodTime(experimentBlock.startTime, periodMs, currentPeriod);
+    startTimer(((now - due.seconds)*1000 - due.ms) * tickRate / 1000);
+}
+
+/**
+boolean Experiment::setTimebase (uint32_t newPeriod)
+  Picks the rate of the RTC square wave the timer counts. A period of whole seconds is counted at
+  1 Hz, any other period at the fastest rate that counts it in 16 bits, 32768 Hz up to 2 seconds
+  and 4096 Hz up to 16 seconds. Every rate comes from the RTC crystal, so sample times stay locked
+  to the RTC. A period of more than 65536 seconds does not fit in the 16 bit timer, it is split
+  into the fewest counts that do fit and the count start inturrupt counts them, see countStarted.
+  Works out the ticks in each count and the thousandths of a tick left over, see nextTop. A change
+  of rate syncs the wall clock to the RTC again, which waits up to a second.
+
+  @param uint32_t newPeriod    The period in milliseconds.
+
+  @return boolean    false if no timebase can time newPeriod.
+*/
+boolean Experiment::setTimebase (uint32_t newPeriod){
+    uint16_t rate;
+    Ds1307SqwPinMode mode;
+    if (newPeriod == 0){
+        return false;
+    }
+    else if (newPeriod % 1000 == 0 && newPeriod / 1000 <= EXPERIMENT_MAX_PERIOD){
+        rate = EXPERIMENT_SLOW_HZ;
+        mode = SquareWave1HZ;
+    }
+    else if (newPeriod <= EXPERIMENT_MAX_COUNT*1000 / EXPERIMENT_FAST_HZ){
+        rate = EXPERIMENT_FAST_HZ;
+        mode = SquareWave32kHz;
+    }
+    else if (newPeriod <= EXPERIMENT_MAX_COUNT*1000 / EXPERIMENT_MID_HZ){
+        rate = EXPERIMENT_MID_HZ;
+        mode = SquareWave4kHz;
     }
+    else{
+        return false;
+    }
+    //the whole ticks in a period, and thousandths of a tick left over
+    uint32_t ticks = (rate == EXPERIMENT_SLOW_HZ) ? newPeriod / 1000 : newPeriod * rate / 1000;
+    tickFraction = (rate == EXPERIMENT_SLOW_HZ) ? 0 : newPeriod * rate % 1000;
+    periodCounts = (ticks + EXPERIMENT_MAX_COUNT - 1) / EXPERIMENT_MAX_COUNT;
+    countTop = ticks / periodCounts - 1;
+    longCounts = ticks % periodCounts;
+    RTC_DS1307::writeSqwPinMode(mode);
+    if (rate != tickRate){
+        (*clock).setRate(rate);
+    }
+    tickRate = rate;
+    return true;
+}
+
+/**
+void Experiment::startTimer (uint32_t ticks)
+  Starts the timer ticks into the period after currentPeriod and lets its counts end periods. The
+  count the timer would be on is found by taking whole counts off ticks, and the fraction of a tick
+  the periods before would have added up is worked out, so the timer carries on exactly as if it
+  had been running since the start. The length of the count is loaded straight away, the
+  EXPERIMENT_COUNT_START inturrupt loads the rest. The wall clock moves the timer so the time is
+  kept across the jump. Inturrupts are off while the count is worked out so the inturrupt does
+  not load a count part way through.
+
+  @param uint32_t ticks    ticks of the timebase since the start of the period, 0 to start a new one.
+
+  @return void
+*/
+void Experiment::startTimer (uint32_t ticks){
+    uint8_t oldSREG = SREG;
+    cli();
+    tickError = ((currentPeriod % 1000) * tickFraction) % 1000;
+    timerCount = 0;
+    uint32_t length = (uint32_t)countTop + 1 + (longCounts > 0);
+    while (timerCount + 1 < periodCounts && ticks >= length){
+        ticks -= length;
+        timerCount++;
+        length = (uint32_t)countTop + 1 + (timerCount < longCounts);
+    }
+    uint16_t top = nextTop();
+    (*clock).setCount(top, (ticks > top) ? top : ticks);     // set timer1 to where it should be
+    finished = false;
+    timing = true;                              // start exp
+    SREG = oldSREG;
+}
+
+/**
+uint32_t Experiment::startOnSecond (void)
+  Starts the timer ending the periods after currentPeriod, 0, from the next second of the wall
+  clock. The wall clock moves the timer so its current count ends on that second and the count
+  start inturrupt starts the timing then, see countStarted, so the main loop carries on meanwhile.
+  Inturrupts are off while the timer is moved so the count can not end part way through.
+
+  @param void
+
+  @return uint32_t    the unix time of the second the experiment starts on.
+*/
+uint32_t Experiment::startOnSecond (void){
+    uint8_t oldSREG = SREG;
+    cli();
+    tickError = ((currentPeriod % 1000) * tickFraction) % 1000;
+    timerCount = 0;
+    timing = false;
+    finished = false;
+    leadIn = true;
+    uint32_t second = (*clock).countToSecond();
+    SREG = oldSREG;
+    return second;
 }
 
 /**
 void Experiment::timerSetup (void)
-  set timer/counter1 to clock on external 1hz sqw from rtc on arduino pin 5
-  sets the default period length to 1s
+  set timer/counter1 to clock on external sqw from rtc on arduino pin 5
+  sets the default period length to 1 tick. The compare match at 0 marks the start of a count, its
+  inturrupt is always on to keep the wall clock.
   
   @param void
   
   @return void
 */
 void Experiment::timerSetup (void){
-   //set timer/counter 1 to clock on external 1hz sqw from rtc on arduino pin 5
+   //set timer/counter 1 to clock on external sqw from rtc on arduino pin 5
     TCCR1B |= (1 << CS12);
     TCCR1B |= (1 << CS11);
     TCCR1B |= (1 << CS10);
@@ -208,20 +644,22 @@ void Experiment::timerSetup (void){
     TCCR1B |= (1 << WGM12);
     TCCR1A &= (0 << WGM11);
     TCCR1A &= (0 << WGM10);
-    // set default period
-    EXPERIMENT_PERIOD = 1;
+    // set default period of 1 tick
+    EXPERIMENT_TOP = 0;
+    // the count start inturrupt fires as the timer goes back to 0
+    OCR1A = 0;
     // clear timer 16 bit reg
     TCNT1 = 0;
     // set global interrupt falg on
     SREG |= (1 << 7);
-    // set timer interupt off
-    TIMSK1 &= (0 << ICIE1);
+    // the count start inturrupt is always on
+    TIMSK1 = (1 << OCIE1A);
 }
 
 /**
 void Experiment::startClock (void)
-  Uses I2C communication to set pin modes and begin communication with
-  RTC.
+  Sets the pin mode of the square wave input and starts the RTC square wave at the timebase for
+  the default period. Setting the first timebase syncs the wall clock to the RTC.
   
   @param void
   
@@ -232,11 +670,7 @@ void Experiment::startClock (void){
      Serial.println("transmitting");
      #endif
      pinMode(EXPERIMENT_CLOCK_PIN, INPUT_PULLUP);
-     Wire.beginTransmission(EXPERIMENT_RTC_I2C_ADDRESS);
-     Wire.write(0x07); // move pointer to DAQ_SQW address
-     Wire.write(0x10); // sends 0x10 (hex) 00010000 (binary)
-     Wire.endTransmission();
+     setTimebase(EXPERIMENT_DEFAULT_PERIOD);
 }
 
 
-
@@ -8,11 +8,24 @@
 #define EXPERIMENT_H
 #include "Port.h"
 #include "Memory.h"
-#define EXPERIMENT_PERIOD ICR1
-#define EXPERIMENT_MAX_PERIOD 65535
-#define EXPERIMENT_MEASURMENT TIMER1_CAPT_vect
+#include "SampleQueue.h"
+#include "WallClock.h"
+#define EXPERIMENT_TOP ICR1   //the timer counts 0 to EXPERIMENT_TOP, one count is EXPERIMENT_TOP+1 ticks
+#define EXPERIMENT_MAX_COUNT 65536UL   //most ticks in one count of the 16 bit timer
+#define EXPERIMENT_MAX_PERIOD 4294966UL   //longest period in seconds, in milliseconds it must fit in 32 bits
+#define EXPERIMENT_DEFAULT_PERIOD 1000   //period in milliseconds until one is set
+//shortest period in milliseconds. Saving six ports queues about 9 bytes of EEPROM writes a period
+//at 3.3 ms a byte, this leaves time for the sensor reads and the reports as well.
+#define EXPERIMENT_MIN_PERIOD 100
+#define EXPERIMENT_COUNT_START TIMER1_COMPA_vect   //the timer is back at 0, see countStarted
+//timebases, the rates in Hz of the RTC square wave the timer can count. See setTimebase.
+#define EXPERIMENT_SLOW_HZ 1
+#define EXPERIMENT_MID_HZ 4096
+#define EXPERIMENT_FAST_HZ 32768
 #define EXPERIMENT_RTC_I2C_ADDRESS 0x68
 #define EXPERIMENT_CLOCK_PIN 5
+#define EXPERIMENT_MAX_CREDIT 65535   //most periods a subscription can be granted at once
+#define EXPERIMENT_MAX_DIVIDER 255    //most periods between samples of a port
 //#define RTCset
 
 /**
@@ -27,53 +40,150 @@ Public Variables:
     ExperimentBlock experimentBlock
       The parameters for the currently running experiment.
 Public Methods:
-    void experimentSetup (Port* portsPtr, Memory* memPtr)
+    void experimentSetup (Port* portsPtr, Memory* memPtr, WallClock* clockPtr)
       precondition: an experiment object has been declared.
       postcondition: a pointer to memory is stored in the varible memory. 
-        a pointer to ports is stored in the varibale ports.
-    void setPeriod (uint32_t newPeriod)
+        a pointer to ports is stored in the varibale ports. a pointer to the wall clock is stored
+        in the variable clock and it has been synced to the RTC.
+    void setPeriod (uint32_t seconds, uint32_t ms)
       precondition: an experiment is not currently running.
-      postcondition: The period has been set to the newPeriod.
-    uint32_t updateCurrentPeriod (void)
-      postcondition: the current period is incremented by 1
+      postcondition: The period has been set to seconds plus ms milliseconds and the timer is
+        counting the timebase that times it. A period shorter than EXPERIMENT_MIN_PERIOD is
+        refused.
+    void setDivider (uint8_t port, uint32_t divider)
+      precondition: an experiment is not currently running.
+      postcondition: the next M experiment samples port, or every port if port is 0, once every
+        divider periods.
+    void setWindow (uint8_t port, uint32_t window)
+      precondition: an experiment is not currently running.
+      postcondition: the next M experiment saves port, or every port if port is 0, as one summary
+        of every window samples.
+    void setDeadband (uint8_t port, uint32_t band, uint32_t silence)
+      precondition: an experiment is not currently running.
+      postcondition: the next M experiment only saves a sample of port, or of every port if port is
+        0, that differs from the last one saved by more than band native units or that comes
+        silence periods after it.
+    void countStarted (void)
+      precondition: only called from the EXPERIMENT_COUNT_START inturrupt.
+      postcondition: the count that has ended has been added to the wall clock, if it ended a period
+        of an experiment periodElapsed has been called, if it ended on the second an experiment
+        starts on the timing has started, and EXPERIMENT_TOP holds the length of the count that has
+        just started.
+    void serviceSamples (void)
+      precondition: called from the main loop.
+      postcondition: every waiting sample due token has been drained from the sample queue and the
+        port data for it saved to memory. While there is live credit the saved data is also sent to
+        the master, using one credit a period. If the last period has been saved the experiment is
+        stopped. While an R experiment is running port data for each token is sent to the master
+        instead. The experiment ends once its last period has elapsed even if the token for it was
+        dropped from a full queue.
+    void subscribe (uint32_t credit)
+      precondition: an m-experiment is running.
+      postcondition: the next credit periods saved by the experiment will also be sent to the master
+        as they are saved. A credit of 0 ends the subscription.
     void startR (uint8_t port, uint32_t targetMeasurment)
-      precondition: if an m-experiment is running targetMeasurment must be 1.
-      postcondition: the daq is running an R-experiment.
+      precondition: if an m-experiment is running targetMeasurment must be 1. An r-experiment is not
+        currently running.
+      postcondition: a single measurment has been sent. If more were asked for the daq is running an
+        R-experiment, every measurment is sent by serviceSamples from the next second on.
     void startM (uint8_t port, uint32_t targetMeasurment)
-      precondition: an m-experiment or an r-experiment is not currently running. 
+      precondition: an m-experiment or an r-experiment is not currently running.
       postcondition: the daq is running an M-experiment and experiment parameters have been
         saved to the EEPROM
     void stopExperiment (void)
-      postcondition: all experiments stopped.
+      postcondition: all experiments stopped, any subscription ended and the sample queue is empty. The samples waiting in the
+        windows of an M experiment have been saved.
 Private Methods:
+    void periodElapsed (void)
+      precondition: only called from countStarted.
+      postcondition: the current period is incremented by 1 and a sample due token for it has been
+        posted to the sample queue. If it was the last period of the M or R experiment the counts
+        no longer end periods and finished is set.
+    void servicePeriod (uint32_t period)
+      precondition: called from the main loop.
+      postcondition: the port data of period has been saved, or sent for an R experiment. If it was
+        the last period the experiment has ended. Nothing is done if no experiment is running.
+    uint8_t dueMask (uint32_t period)
+      postcondition: returns a port mask of the ports of the running M experiment that are sampled
+        in period.
     void recoverExperiment (void)
       postcondition: Called on startup of DAQ. The last saved experiment block is loaded into
         the public variable ExperimentBlock.
+    boolean setTimebase (uint32_t newPeriod)
+      postcondition: the RTC square wave is the fastest timebase that can time newPeriod, in
+        milliseconds, and the counts of the timer in each period have been worked out. If the
+        timebase has changed the wall clock has been synced to it. Returns false if no timebase can
+        time newPeriod, nothing is changed.
+    uint32_t startOnSecond (void)
+      precondition: currentPeriod is 0.
+      postcondition: the count start inturrupt starts the timing of the experiment as the wall
+        clock starts the next second, returns the unix time of that second.
+    void startTimer (uint32_t ticks)
+      precondition: currentPeriod is the last period that has elapsed.
+      postcondition: the timer is ticks into the next period, on the count and with the
+        EXPERIMENT_TOP it would have had, and its counts end periods.
+    uint16_t nextTop (void)
+      postcondition: returns the EXPERIMENT_TOP of count timerCount of a period, adding the
+        fraction of a tick a period leaves over to tickError at the start of a period.
     void timerSetup (void)
       postcondition: The configuration bits for the hardware timers have been properly set.
     void startClock (void)
-      postcondition: The RTC has been intialized.
+      postcondition: The RTC has been intialized and the wall clock synced to it.
 **/
 
 class Experiment{
     public:
     //constructor and setup functions
     Experiment (void);
-    void experimentSetup (Port* portsPtr, Memory* memPtr);
+    void experimentSetup (Port* portsPtr, Memory* memPtr, WallClock* clockPtr);
     //public varibles
     ExperimentBlock experimentBlock;
     //public functions
-    void setPeriod (uint32_t newPeriod);
-    uint32_t updateCurrentPeriod (void);
+    void setPeriod (uint32_t seconds, uint32_t ms);
+    void setDivider (uint8_t port, uint32_t divider);
+    void setWindow (uint8_t port, uint32_t window);
+    void setDeadband (uint8_t port, uint32_t band, uint32_t silence);
+    void countStarted (void);
+    void serviceSamples (void);
+    void subscribe (uint32_t credit);
     void startR (uint8_t port, uint32_t targetMeasurment);
     void startM (uint8_t port, uint32_t targetMeasurment);
     void stopExperiment (void);
     
     private:
-    uint32_t currentPeriod;
+    volatile uint32_t currentPeriod;
+    volatile uint32_t lastPeriod;    //period the counts stop ending periods after
+    volatile boolean timing;         //true while the counts of the timer end periods
+    volatile boolean leadIn;         //true until the count the experiment starts after has ended
+    volatile boolean finished;       //set once the last period has elapsed, until it is serviced
+    uint16_t liveCredit;
+    boolean reporting;               //true while an R experiment is running
+    uint8_t reportPort;
+    uint32_t reportStart;            //unix time of the first report of an R experiment, on a whole second
+    uint32_t periodMs;               //period length in milliseconds, set by setPeriod
+    uint8_t dividers[PORT_MAX];      //periods between samples of each port, set by setDivider
+    uint8_t windows[PORT_MAX];       //samples in a summary of each port, set by setWindow
+    uint8_t bands[PORT_MAX];         //deadband of each port in native units, set by setDeadband
+    uint16_t silences[PORT_MAX];     //most periods between saved samples of each port, set by setDeadband
+    uint16_t tickRate;               //the timebase in Hz
+    uint8_t periodCounts;            //counts of the timer in a period, more than 1 for long periods
+    uint8_t longCounts;              //counts at the start of a period that have an extra tick
+    volatile uint8_t timerCount;     //the count of the current period the timer is on
+    uint16_t countTop;               //EXPERIMENT_TOP for a count without an extra tick
+    uint16_t tickFraction;           //thousandths of a tick a period is longer than its counts
+    volatile uint16_t tickError;     //thousandths of a tick the periods so far have fallen behind
+    SampleQueue sampleQueue;
     Port* ports;
     Memory* memory;
+    WallClock* clock;
+    void periodElapsed (void);
+    void servicePeriod (uint32_t period);
+    uint8_t dueMask (uint32_t period);
     void recoverExperiment (void);
+    boolean setTimebase (uint32_t newPeriod);
+    uint32_t startOnSecond (void);
+    void startTimer (uint32_t ticks);
+    uint16_t nextTop (void);
     void timerSetup (void);
     void startClock (void);
 };
@@ -1,5 +1,40 @@
 #include "Memory.h"
 #include "miniSDI_12.h"
+#include <util/crc16.h>
+
+//zig-zag encoding maps small negative and positive changes to small unsigned numbers,
+//0,-1,1,-2,2... become 0,1,2,3,4...
+static inline uint32_t zigZag (int32_t value){
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static inline int32_t unZigZag (uint32_t value){
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+//writes value 7 bits at a time, low bits first. The top bit of every byte but the last is set.
+static uint8_t putVarint (uint8_t* buffer, uint32_t value){
+    uint8_t length = 0;
+    while (value > 0x7F){
+        buffer[length++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    buffer[length++] = value;
+    return length;
+}
+
+//reads a varint from a page. Returns false if it runs off the end of the page.
+static boolean getVarint (uint16_t address, uint8_t* offset, uint32_t* value){
+    *value = 0;
+    for (uint8_t shift = 0; shift < 35 && *offset < MEMORY_PAGE_SIZE; shift += 7){
+        uint8_t byte = EEPROM.read(address + (*offset)++);
+        *value |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)){
+            return true;
+        }
+    }
+    return false;
+}
 
 /**
 Memory::Memory (void)
@@ -20,25 +55,49 @@ void Memory::memorySetup (void)
   @return void
 */
 void Memory::memorySetup (void){
-    headerBlockSize = sizeof(MemoryBlock) + sizeof(ExperimentBlock);
-    dataBlockSize = sizeof(DataBlock);
-    maxBlocks = (MEMORY_SIZE - headerBlockSize) / dataBlockSize;
-    EEPROM.readBlock(MEMORY_BLOCK_ADDRESS, memoryBlock);
+    headerBlockSize = sizeof(ExperimentBlock) + sizeof(SettingsBlock);
+    maxPages = (MEMORY_SIZE - headerBlockSize) / MEMORY_PAGE_SIZE;
+    ExperimentBlock experimentBlock;
+    loadExperimentBlock(&experimentBlock);
+    logEpoch = experimentBlock.logEpoch;
+    scanLog();
 }//memorySetup
 
 /**
 void Memory::updateExperimentBlock (ExperimentBlock experimentBlock)
-  Updates the experiment block in memroy by overwriting the existing experiment block.
+  Updates the experiment block in memroy by queueing it to overwrite the existing experiment block.
   
   @param experimentBlock    The experiment block to write to EEPROM
   
   @return void
 */
 void Memory::updateExperimentBlock (ExperimentBlock experimentBlock){
-    uint8_t tempReg = SREG;    // save the status register
-    SREG &= (0 << 7);          // turn off inturrupts to save memory
-    EEPROM.updateBlock(EXPERIMENT_BLOCK_ADDRESS, experimentBlock);    //save memroy
-    SREG = tempReg;            // return status register
+    writeQueue.queueBlock(EXPERIMENT_BLOCK_ADDRESS, experimentBlock);    //save memroy
+}
+
+/**
+void Memory::updateSettingsBlock (SettingsBlock settingsBlock)
+  Updates the settings block in memroy by queueing it to overwrite the existing settings block.
+  
+  @param settingsBlock    The settings block to write to EEPROM
+  
+  @return void
+*/
+void Memory::updateSettingsBlock (SettingsBlock settingsBlock){
+    writeQueue.queueBlock(SETTINGS_BLOCK_ADDRESS, settingsBlock);
+}
+
+/**
+void Memory::loadSettingsBlock (SettingsBlock* settingsBlock)
+    Reads the settings block from EEPROM.
+    
+    @param SettingsBlock*  the location to store the settings block
+    
+    @return void
+*/
+void Memory::loadSettingsBlock (SettingsBlock* settingsBlock){
+    writeQueue.flush();
+    EEPROM.readBlock(SETTINGS_BLOCK_ADDRESS, *settingsBlock);
 }
 
 /**
@@ -51,103 +110,518 @@ void Memory::loadExperimentBlock (ExperimentBlock* experimentBlock)
 */
 void Memory::loadExperimentBlock (ExperimentBlock* experimentBlock){
     ExperimentBlock newBlock;
+    writeQueue.flush();
     EEPROM.readBlock(EXPERIMENT_BLOCK_ADDRESS, newBlock);
     setEqual(experimentBlock, &newBlock);
 }
 
 /**
 void Memory::saveDataBlock (DataBlock dataBlock)
-    Saves a data block into memroy
+    Appends a data block to the log as a frame. Only the frame itself is written, the head and tail
+    pointers are kept in RAM and rebuilt by scanLog on startup. The frame is queued and written by
+    the EE_READY inturrupt, this returns as soon as it has been queued. The port mask byte is queued
+    last, until it is written the end of page marker it replaces stops the frame being read.
     
     @param DataBlock  the block of data to be saved into memory
     
     @return void
 */
 void Memory::saveDataBlock (DataBlock dataBlock){
-    uint8_t tempReg = SREG;
-    SREG &= (0 << 7);
-    EEPROM.updateBlock((memoryBlock.tailPtr)*dataBlockSize + headerBlockSize, dataBlock);
-    memoryBlock.tailPtr = (((memoryBlock.tailPtr)+1) % maxBlocks);
-    if (memoryBlock.tailPtr == memoryBlock.headPtr){
-        memoryBlock.headPtr = ((memoryBlock.headPtr)+1) % maxBlocks;
+    uint8_t buffer[MEMORY_MAX_FRAME];
+    uint8_t length = 0;
+    dataBlock.portMask &= MEMORY_PORT_MASK;
+    if (dataBlock.portMask == MEMORY_END_OF_PAGE){
+        return;
+    }
+    if (writer.offset != 0){
+        length = encodeFrame(&dataBlock, buffer);
+    }
+    //start a new page if none is open or the frame does not fit in this one
+    if (writer.offset == 0 || writer.offset + length > MEMORY_PAGE_SIZE){
+        openPage(dataBlock.periodNumber);
+        length = encodeFrame(&dataBlock, buffer);
+    }
+    uint16_t address = pageAddress(writer.page) + writer.offset;
+    for (uint8_t i = 1; i < length; i++){
+        writeQueue.queueByte(address + i, buffer[i]);
+    }
+    if (writer.offset + length < MEMORY_PAGE_SIZE){
+        writeQueue.queueByte(address + length, MEMORY_END_OF_PAGE);
+    }
+    writeQueue.queueByte(address, buffer[0]);
+    writer.offset += length;
+    writer.period = dataBlock.periodNumber;
+    for (uint8_t port = 0; port < MEMORY_MAX_PORTS; port++){
+        if (dataBlock.portMask & (1 << port)){
+            writer.last[port] = dataBlock.data[port];
+        }
     }
-    EEPROM.updateBlock(MEMORY_BLOCK_ADDRESS,memoryBlock);
-    SREG = tempReg;
 }
 
 /**
-void Memory::loadDataBlock (uint16_t effectiveAddress, DataBlock* dataBlock)
-    Reads the data block at the effectiveAddress in EEPROM and sets DataBlock* to point at it.
+void Memory::firstBlock (LogCursor* cursor)
+    Points cursor at the oldest DataBlock in the log. Any queued writes are made first so every
+    saved DataBlock can be read.
     
-    @param uint16_t effectiveAddress    The logical address the desired data block.
-    @param DataBlock* dataBlock         A pointer to be set to the new data block.
+    @param LogCursor* cursor    The cursor to set.
+    
+    @return void
 */
-void Memory::loadDataBlock (uint16_t effectiveAddress, DataBlock* dataBlock){
-    DataBlock newBlock;
-    uint16_t absoluteAddress = effectiveAddress*dataBlockSize + headerBlockSize;
-    EEPROM.readBlock(absoluteAddress, newBlock);
-    setEqual (dataBlock, &newBlock);
+void Memory::firstBlock (LogCursor* cursor){
+    writeQueue.flush();
+    cursor -> page = memoryBlock.headPtr;
+    cursor -> offset = 0;
+    if (writer.offset != 0){
+        startPage(cursor);
+    }
 }
 
 /**
-uint16_t Memory::getPtr(uint16_t numValues)
-  returns the logical address of block in EEPROM of the block tailPtr - numValues
-
-  @param uint16_t numValues    The number of desired data blocks
-  
-  @return uint16_t             Logical address of data block.
+void Memory::seekBlock (LogCursor* cursor, uint32_t period)
+    Points cursor at the oldest DataBlock in the log with a period number of at least period. Base
+    periods only go up from the head page to the tail page, so the page it is in is found with a
+    binary search of the page headers. A period can be saved as several DataBlocks that run on from
+    one page into the next, so the search is for the newest page that starts before period. Only
+    the frames in that page before it are decoded, finding any period reads a number of headers
+    that grows with the log2 of the number of pages. Any queued writes are made first so every
+    saved DataBlock can be read.
+    Known Bug (fixed):
+    The search used to stop at the newest page starting at or before period. When a page started
+    part way through the blocks of period, the blocks of it on the page before were skipped.
+    
+    @param LogCursor* cursor    The cursor to set.
+    @param uint32_t period      The period number to look for.
+    
+    @return void
 */
-uint16_t Memory::getPtr(uint16_t numValues){
-    if(numValues < 1 || numValues > maxBlocks){
-        return memoryBlock.headPtr;
+void Memory::seekBlock (LogCursor* cursor, uint32_t period){
+    PageHeader header;
+    DataBlock dataBlock;
+    firstBlock(cursor);
+    if (cursor -> offset == 0){
+        return;
     }
-    //memory is full and any value in is acceptable
-    else if (memoryBlock.headPtr > memoryBlock.tailPtr){
-        if (numValues > memoryBlock.tailPtr){
-            return (maxBlocks - (numValues - memoryBlock.tailPtr));
+    //pages are counted from the head. low is the newest page known to start before period, or the
+    //head if none do. Every page after high starts at or after period.
+    uint16_t low = 0;
+    uint16_t high = (memoryBlock.tailPtr + maxPages - memoryBlock.headPtr) % maxPages;
+    while (low < high){
+        uint16_t middle = (low + high + 1) / 2;
+        if (loadHeader((memoryBlock.headPtr + middle) % maxPages, &header) && header.basePeriod < period){
+            low = middle;
         }
         else{
-            return (memoryBlock.tailPtr - numValues);
+            high = middle - 1;
         }
     }
-    //memory is not full and we can't ask for more than we have
-    else{
-        if(numValues > memoryBlock.tailPtr){
-            return memoryBlock.headPtr;
+    cursor -> page = (memoryBlock.headPtr + low) % maxPages;
+    startPage(cursor);
+    //skip the older frames at the start of the page
+    LogCursor previous = *cursor;
+    while (loadDataBlock(cursor, &dataBlock) && dataBlock.periodNumber < period){
+        previous = *cursor;
+    }
+    *cursor = previous;
+}
+
+/**
+boolean Memory::lastPeriod (uint32_t* period)
+    Finds the period number of the newest DataBlock in the log, the writer is always just after it.
+    Nothing is read from the EEPROM.
+    
+    @param uint32_t* period    The location to store the period number.
+    
+    @return boolean    false if the log is empty, period is not changed.
+*/
+boolean Memory::lastPeriod (uint32_t* period){
+    if (writer.offset == 0){
+        return false;
+    }
+    *period = writer.period;
+    return true;
+}
+
+/**
+boolean Memory::loadDataBlock (LogCursor* cursor, DataBlock* dataBlock)
+    Decodes the DataBlock at cursor and moves cursor on to the next one, moving on to the next
+    page at the end of each page.
+    
+    @param LogCursor* cursor      The position in the log.
+    @param DataBlock* dataBlock   The location to store the DataBlock.
+    
+    @return boolean    false if there are no more DataBlocks in the log.
+*/
+boolean Memory::loadDataBlock (LogCursor* cursor, DataBlock* dataBlock){
+    while (cursor -> offset != 0){
+        if (decodeFrame(cursor, dataBlock)){
+            return true;
+        }
+        if (cursor -> page == memoryBlock.tailPtr){
+            cursor -> offset = 0;
         }
         else{
-            return (memoryBlock.tailPtr - numValues);
+            cursor -> page = (cursor -> page + 1) % maxPages;
+            startPage(cursor);
         }
     }
+    return false;
 }
 
 /**
-void Memory::updatePtr(uint16_t* ptr)
-  Increments ptr by one and makes sure it doesn't
-  
-  @param pointer the the memory pointer
-  
-  @reutnr void
+uint16_t Memory::reset (void)
+    Moves the head pointer up to a new page and starts a new log epoch, effectily reseting memory.
+    Nothing is erased, pages from before the reset are from another epoch once the new epoch has
+    been saved in the experiment block. The tail is not moved back to the start of the log so the next
+    experiment carries on writing where the last one stopped.
+    
+    @param void
+    
+    @return uint16_t    the new log epoch
+*/
+uint16_t Memory::reset (void){
+    if (writer.offset != 0){
+        memoryBlock.tailPtr = (memoryBlock.tailPtr + 1) % maxPages;
+        writer.page = memoryBlock.tailPtr;
+        writer.offset = 0;
+    }
+    memoryBlock.headPtr = memoryBlock.tailPtr;
+    logEpoch++;
+    return logEpoch;
+}
+
+/**
+Timestamp Memory::periodTime (uint32_t startTime, uint32_t periodMs, uint32_t period)
+    Works out the time a period was due, period times the period length after the start. The
+    product does not fit in 32 bits once there are many short periods, so the whole seconds and
+    the milliseconds of the period length are multiplied seperately and the milliseconds are
+    split again by thousands of periods.
+
+    @param uint32_t startTime    unix time of period 0
+    @param uint32_t periodMs     period length in milliseconds
+    @param uint32_t period       the period number
+
+    @return Timestamp    the time the period was due
+*/
+Timestamp Memory::periodTime (uint32_t startTime, uint32_t periodMs, uint32_t period){
+    Timestamp time;
+    uint16_t ms = periodMs % 1000;
+    uint32_t part = (period % 1000) * ms;
+    time.seconds = startTime + period*(periodMs / 1000) + (period / 1000)*ms + part / 1000;
+    time.ms = part % 1000;
+    return time;
+}
+
+/**
+uint32_t Memory::timePeriod (uint32_t startTime, uint32_t periodMs, uint32_t time)
+    The reverse of periodTime, finds the last period that was due at or before a unix time. A
+    period that is not a whole number of seconds is never more than a few seconds long, see
+    Experiment::setPeriod, so the remainder times 1000 always fits in 32 bits.
+
+    @param uint32_t startTime    unix time of period 0
+    @param uint32_t periodMs     period length in milliseconds
+    @param uint32_t time         unix time, not before startTime
+
+    @return uint32_t    the period number
 */
-void Memory::updatePtr(uint16_t* ptr){
-    (*ptr) = ((*ptr)+1) % maxBlocks;
+uint32_t Memory::timePeriod (uint32_t startTime, uint32_t periodMs, uint32_t time){
+    uint32_t offset = time - startTime;
+    if (periodMs % 1000 == 0){
+        return offset / (periodMs / 1000);
+    }
+    return (offset / periodMs)*1000 + ((offset % periodMs)*1000) / periodMs;
 }
 
 /**
-void Memory::reset (void)
-    Sets points in memBlock to head of circular FIFO array. effectily reseting memory
+void Memory::scanLog (void)
+    Rebuilds the head and tail pointers from the log. The newest page is the valid page that is
+    not followed by a valid page with the next sequence number. The oldest page is found by walking
+    back from the newest for as long as the sequence numbers keep counting down. The frames in the
+    newest page are decoded to find where the next frame goes and what it is encoded against. If
+    there are no pages from the current epoch yet the log starts after the newest page of the last
+    epoch that left any, see oldTail.
     
     @param void
     
     @return void
+Known Bug (fixed):
+  A log with no valid pages used to start again at page 0. A reboot between a reset and the first
+  frame of the next experiment then sent every experiment back to the first pages and undid the
+  wear leveling of carrying on where the last experiment stopped.
 */
-void Memory::reset (void){
-    memoryBlock.headPtr = 0;
-    memoryBlock.tailPtr = 0;
-    uint8_t tempReg = SREG;
-    SREG &= (0 << 7);
-    EEPROM.updateBlock(MEMORY_BLOCK_ADDRESS, memoryBlock);
-    SREG = tempReg;
+void Memory::scanLog (void){
+    PageHeader header;
+    PageHeader next;
+    int newest = -1;
+    for (int page = 0; page < maxPages && newest < 0; page++){
+        if (loadHeader(page, &header)){
+            if (!loadHeader((page+1) % maxPages, &next) || next.seq != (uint8_t)(header.seq + 1)){
+                newest = page;
+            }
+        }
+    }
+    //no valid pages, memory is empty
+    if (newest < 0){
+        memoryBlock.tailPtr = oldTail();
+        memoryBlock.headPtr = memoryBlock.tailPtr;
+        writer.page = memoryBlock.tailPtr;
+        writer.offset = 0;
+        nextSeq = 0;
+        return;
+    }
+    loadHeader(newest, &header);
+    nextSeq = header.seq + 1;
+    memoryBlock.tailPtr = newest;
+    uint16_t head = newest;
+    for (int stored = 1; stored < maxPages; stored++){
+        uint16_t prev = (head + maxPages - 1) % maxPages;
+        uint8_t seq = header.seq;
+        if (!loadHeader(prev, &header) || (uint8_t)(header.seq + 1) != seq){
+            break;
+        }
+        head = prev;
+    }
+    memoryBlock.headPtr = head;
+    //run the writer through the newest page
+    DataBlock dataBlock;
+    writer.page = newest;
+    startPage(&writer);
+    while (decodeFrame(&writer, &dataBlock)){
+    }
+}
+
+/**
+uint16_t Memory::oldTail (void)
+    Finds where an empty log starts, the page after the newest page of the most recent epoch
+    before the current one. Epochs only count up, so the most recent one is the one the fewest
+    resets back. Its newest page is found the same way scanLog finds it.
+    
+    @param void
+    
+    @return uint16_t    the page to start the log at, 0 if no page from any epoch is valid.
+*/
+uint16_t Memory::oldTail (void){
+    PageHeader header;
+    PageHeader next;
+    uint16_t closest = 0;
+    for (int page = 0; page < maxPages; page++){
+        if (checkHeader(page, &header) && header.epoch != logEpoch
+            && (closest == 0 || (uint16_t)(logEpoch - header.epoch) < closest)){
+            closest = logEpoch - header.epoch;
+        }
+    }
+    if (closest == 0){
+        return 0;
+    }
+    uint16_t epoch = logEpoch - closest;
+    for (int page = 0; page < maxPages; page++){
+        if (checkHeader(page, &header) && header.epoch == epoch){
+            if (!checkHeader((page+1) % maxPages, &next) || next.epoch != epoch
+                || next.seq != (uint8_t)(header.seq + 1)){
+                return (page + 1) % maxPages;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+void Memory::openPage (uint32_t basePeriod)
+    Starts a new page after the tail page, or at the tail page if the log is empty. If the log is
+    full the oldest page is dropped. The end of page marker is queued before the header so stale
+    frames are never read from a page with a valid header. The bytes between the header and the
+    first frame are left as they are.
+    
+    @param uint32_t basePeriod    The period number of the first frame in the page.
+    
+    @return void
+*/
+void Memory::openPage (uint32_t basePeriod){
+    if (writer.offset != 0){
+        memoryBlock.tailPtr = (memoryBlock.tailPtr + 1) % maxPages;
+        if (memoryBlock.tailPtr == memoryBlock.headPtr){
+            memoryBlock.headPtr = (memoryBlock.headPtr + 1) % maxPages;
+        }
+    }
+    PageHeader header;
+    header.seq = nextSeq++;
+    header.epoch = logEpoch;
+    header.basePeriod = basePeriod;
+    header.check = checksum(&header);
+    uint16_t address = pageAddress(memoryBlock.tailPtr);
+    writeQueue.queueByte(address + firstFrame(&header), MEMORY_END_OF_PAGE);
+    writeQueue.queueBlock(address, header);
+    writer.page = memoryBlock.tailPtr;
+    writer.offset = firstFrame(&header);
+    writer.period = basePeriod;
+    memset(writer.last, 0, sizeof(writer.last));
+}
+
+/**
+boolean Memory::startPage (LogCursor* cursor)
+    Points cursor at the first frame of its page.
+    
+    @param LogCursor* cursor    The cursor, page must already be set.
+    
+    @return boolean    false if the page header is not valid, offset is set to 0.
+*/
+boolean Memory::startPage (LogCursor* cursor){
+    PageHeader header;
+    if (!loadHeader(cursor -> page, &header)){
+        cursor -> offset = 0;
+        return false;
+    }
+    cursor -> offset = firstFrame(&header);
+    cursor -> period = header.basePeriod;
+    memset(cursor -> last, 0, sizeof(cursor -> last));
+    return true;
+}
+
+/**
+boolean Memory::decodeFrame (LogCursor* cursor, DataBlock* dataBlock)
+    Decodes the frame at cursor, a period or a summary. cursor is only moved past the frame if the
+    whole frame is read.
+    
+    @param LogCursor* cursor      The position in the page.
+    @param DataBlock* dataBlock   The location to store the decoded frame.
+    
+    @return boolean    false at the end of the page.
+*/
+boolean Memory::decodeFrame (LogCursor* cursor, DataBlock* dataBlock){
+    uint16_t address = pageAddress(cursor -> page);
+    uint8_t offset = cursor -> offset;
+    uint32_t value;
+    if (offset == 0 || offset >= MEMORY_PAGE_SIZE){
+        return false;
+    }
+    uint8_t mask = EEPROM.read(address + offset++);
+    if (mask == MEMORY_END_OF_PAGE || (mask & ~(MEMORY_PORT_MASK | MEMORY_SUMMARY | MEMORY_NEXT_PERIOD))){
+        return false;
+    }
+    value = 1;
+    if (!(mask & MEMORY_NEXT_PERIOD) && !getVarint(address, &offset, &value)){
+        return false;
+    }
+    dataBlock -> periodNumber = cursor -> period + value;
+    dataBlock -> portMask = mask & MEMORY_PORT_MASK;
+    dataBlock -> count = 0;
+    int16_t mean = 0;
+    for (uint8_t port = 0; port < MEMORY_MAX_PORTS; port++){
+        if (mask & (1 << port)){
+            if (!getVarint(address, &offset, &value)){
+                return false;
+            }
+            dataBlock -> data[port] = cursor -> last[port] + unZigZag(value);
+            mean = dataBlock -> data[port];
+        }
+    }
+    if (mask & MEMORY_SUMMARY){
+        if (!getVarint(address, &offset, &value)){
+            return false;
+        }
+        dataBlock -> low = mean - value;
+        if (!getVarint(address, &offset, &value)){
+            return false;
+        }
+        dataBlock -> high = mean + value;
+        if (!getVarint(address, &offset, &value) || value == 0){
+            return false;
+        }
+        dataBlock -> count = value;
+    }
+    cursor -> offset = offset;
+    cursor -> period = dataBlock -> periodNumber;
+    for (uint8_t port = 0; port < MEMORY_MAX_PORTS; port++){
+        if (mask & (1 << port)){
+            cursor -> last[port] = dataBlock -> data[port];
+        }
+    }
+    return true;
+}
+
+/**
+uint8_t Memory::encodeFrame (DataBlock* dataBlock, uint8_t* buffer)
+    Encodes dataBlock as a frame following the last frame written. A frame saved every period has
+    its period delta folded into the port mask, which saves a byte of every frame and so a byte of
+    EEPROM wear. A summary is encoded with its low and high against its mean, they are never far
+    from it for a slow changing sensor.
+    
+    @param DataBlock* dataBlock    The DataBlock to encode.
+    @param uint8_t* buffer         At least MEMORY_MAX_FRAME bytes to store the frame.
+    
+    @return uint8_t    The length of the frame.
+*/
+uint8_t Memory::encodeFrame (DataBlock* dataBlock, uint8_t* buffer){
+    uint8_t length = 0;
+    int16_t mean = 0;
+    uint32_t delta = dataBlock -> periodNumber - writer.period;
+    buffer[length++] = dataBlock -> portMask | (dataBlock -> count != 0 ? MEMORY_SUMMARY : 0)
+                       | (delta == 1 ? MEMORY_NEXT_PERIOD : 0);
+    if (delta != 1){
+        length += putVarint(&buffer[length], delta);
+    }
+    for (uint8_t port = 0; port < MEMORY_MAX_PORTS; port++){
+        if (dataBlock -> portMask & (1 << port)){
+            int32_t delta = (int32_t)dataBlock -> data[port] - writer.last[port];
+            length += putVarint(&buffer[length], zigZag(delta));
+            mean = dataBlock -> data[port];
+        }
+    }
+    if (dataBlock -> count != 0){
+        length += putVarint(&buffer[length], (uint16_t)(mean - dataBlock -> low));
+        length += putVarint(&buffer[length], (uint16_t)(dataBlock -> high - mean));
+        length += putVarint(&buffer[length], dataBlock -> count);
+    }
+    return length;
+}
+
+/**
+boolean Memory::loadHeader (uint16_t page, PageHeader* header)
+    Reads the header of a page and checks it.
+    
+    @param uint16_t page          The page number.
+    @param PageHeader* header     The location to store the header.
+    
+    @return boolean    true if the header is from the current log epoch and its check matches.
+Known Bug (fixed):
+  The log epoch used to be a byte that was only mixed into a crc8 of the header. Each page left
+  from an old experiment still passed the check one time in 256, and was then taken for the newest
+  page after a reset. The epoch is now stored in the header and compared, the CRC only catches
+  headers that were half written.
+*/
+boolean Memory::loadHeader (uint16_t page, PageHeader* header){
+    return checkHeader(page, header) && (header -> epoch) == logEpoch;
+}
+
+/**
+boolean Memory::checkHeader (uint16_t page, PageHeader* header)
+    Reads the header of a page and checks it was written whole, whatever epoch it is from.
+    
+    @param uint16_t page          The page number.
+    @param PageHeader* header     The location to store the header.
+    
+    @return boolean    true if the check of the header matches.
+*/
+boolean Memory::checkHeader (uint16_t page, PageHeader* header){
+    EEPROM.readBlock(pageAddress(page), *header);
+    return (header -> check) == checksum(header);
+}
+
+/**
+uint16_t Memory::checksum (PageHeader* header)
+    Calculates the CRC-16/XMODEM of every byte of the header except check, the same CRC the binary
+    frames of miniSDI_12 use.
+    
+    @param PageHeader* header    The header to check.
+    
+    @return uint16_t    The CRC.
+*/
+uint16_t Memory::checksum (PageHeader* header){
+    uint16_t crc = 0;
+    const uint8_t* bytePtr = (const uint8_t*)header;
+    for (uint8_t i = 0; i < sizeof(PageHeader) - sizeof(header -> check); i++){
+        crc = _crc_xmodem_update(crc, bytePtr[i]);
+    }
+    return crc;
 }
 
 /**
@@ -164,21 +638,13 @@ void Memory::setEqual (ExperimentBlock* block1, ExperimentBlock* block2){
     block1 -> isRunning = block2 -> isRunning;             
     block1 -> port = block2 -> port;                  
     block1 -> startTime = block2 -> startTime;            
-    block1 -> periodLgth = block2 -> periodLgth;           
+    block1 -> periodMs = block2 -> periodMs;           
     block1 -> targetMeasurment = block2 -> targetMeasurment;     
-}
-
-/**
-void Memory::setEqual (DataBlock* block1, DataBlock* block2)
-    set DataBlock1 equal to DataBlock2
-    
-    @param DataBlock* block1    DataBlock to be set
-    @param DataBlock* block2    DataBlock used as reference
-
-    @return void
-*/
-void Memory::setEqual (DataBlock* block1, DataBlock* block2){
-  block1 -> port = block2 -> port;
-  block1 -> periodNumber = block2 -> periodNumber;
-  block1 -> data = block2 -> data;
+    block1 -> logEpoch = block2 -> logEpoch;
+    for (uint8_t port = 0; port < MEMORY_MAX_PORTS; port++){
+        block1 -> dividers[port] = block2 -> dividers[port];
+        block1 -> windows[port] = block2 -> windows[port];
+        block1 -> bands[port] = block2 -> bands[port];
+        block1 -> silences[port] = block2 -> silences[port];
+    }
 }
@@ -13,46 +13,141 @@ Memory.h
 #ifndef MEMORY_H
 #define MEMORY_H
 #include "EEPROMex.h"
+#include "WriteQueue.h"
 
 // global constants for this class. All constants contributed to this class will begin with MEMORY_
 #define MEMORY_SIZE 1024
-#define MEMORY_BLOCK_ADDRESS 0
-#define EXPERIMENT_BLOCK_ADDRESS 4
+#define EXPERIMENT_BLOCK_ADDRESS 0
+#define SETTINGS_BLOCK_ADDRESS (EXPERIMENT_BLOCK_ADDRESS + sizeof(ExperimentBlock))
+// the log is split into pages. A page is the unit that is overwritten when the log is full.
+#define MEMORY_PAGE_SIZE 64
+// the most ports a DataBlock can hold. Must be at least PORT_MAX.
+#define MEMORY_MAX_PORTS 6
+#define MEMORY_PORT_MASK 0x3F
+// set in the port mask of a frame that holds a summary of a window of samples, see DataBlock
+#define MEMORY_SUMMARY 0x80
+// set in the port mask of a frame one period after the frame before it, its period delta is left out
+#define MEMORY_NEXT_PERIOD 0x40
+// a port mask of 0 marks the end of the frames in a page
+#define MEMORY_END_OF_PAGE 0
+// the first frame of a page starts seq & MEMORY_SKEW_MASK bytes after the header, see firstFrame
+#define MEMORY_SKEW_MASK 7
+// longest encoded frame: port mask, 5 byte period delta and a 3 byte delta for every port. A
+// summary frame only holds one port and is shorter.
+#define MEMORY_MAX_FRAME (1 + 5 + 3*MEMORY_MAX_PORTS)
 
 //this struct is 4 bytes
+//Only kept in RAM. It is rebuilt from the log by scanLog on startup instead of being saved to
+//EEPROM with every data block. Both pointers are page numbers.
 typedef struct MemoryBlock_TAG{
-    uint16_t headPtr;              // 2 bytes
-    uint16_t tailPtr;              // 2 bytes
+    uint16_t headPtr;              // 2 bytes, oldest page
+    uint16_t tailPtr;              // 2 bytes, page being written
 }MemoryBlock;
 
 //This struck holds all of the experiment parameters.
-//This struct is 12 bytes
+//This struct is 46 bytes
 typedef struct ExperimentBlock_TAG{
     boolean isRunning;             // 1 byte
     uint8_t port;                  // 1 byte
-    uint32_t startTime;            // 4 bytes
-    uint16_t periodLgth;           // 2 bytes
+    uint32_t startTime;            // 4 bytes, unix time of period 0, always on a whole second
+    uint32_t periodMs;             // 4 bytes, period length in milliseconds
     uint32_t targetMeasurment;     // 4 bytes
+    uint16_t logEpoch;             // 2 bytes, changes every time the log is reset
+    uint8_t dividers[MEMORY_MAX_PORTS];    // 6 bytes, port n+1 is sampled every dividers[n] periods
+    uint8_t windows[MEMORY_MAX_PORTS];     // 6 bytes, port n+1 is saved as a summary of windows[n] samples
+    uint8_t bands[MEMORY_MAX_PORTS];       // 6 bytes, deadband of port n+1 in native units
+    uint16_t silences[MEMORY_MAX_PORTS];   // 12 bytes, most periods between saved samples of port n+1
 }ExperimentBlock;
 
+//Settings that are kept between power cycles but are not part of an experiment. A setting that
+//has never been saved reads back as 0xFF.
+//This struct is 1 byte
+typedef struct SettingsBlock_TAG{
+    uint8_t baudCode;              // 1 byte, no longer used, the DAQ always starts at BAUD_DEFAULT. Kept so the log does not move
+}SettingsBlock;
 
-//Block types must be the same size.
-//9 bytes
+//A time to the millisecond, see periodTime.
+//6 bytes
+typedef struct Timestamp_TAG{
+    uint32_t seconds;              //4 bytes, unix time
+    uint16_t ms;                   //2 bytes, milliseconds after seconds
+}Timestamp;
+
+//Every sample taken in one period. Bit n of portMask is set if data[n] holds a sample from port
+//n+1. Samples are in the sensors native units, see Sensor.
+//A block with a count is a summary of a window of count samples from the one port in portMask,
+//see Aggregator. data holds their mean, low and high the smallest and largest of them and
+//periodNumber the period of the last of them. count is 0 for every other block.
+//22 bytes
 typedef struct DataBlock_TAG{
-    uint32_t periodNumber;         //4 bytes
-    uint8_t port;                  //1 byte
-    uint32_t data;                   //4 bytes
+    uint32_t periodNumber;                 //4 bytes
+    uint8_t portMask;                      //1 byte
+    int16_t data[MEMORY_MAX_PORTS];        //12 bytes
+    uint8_t count;                         //1 byte, samples in a summary, 0 if not a summary
+    int16_t low;                           //2 bytes, summary only
+    int16_t high;                          //2 bytes, summary only
 }DataBlock;
 
+//Written at the start of every page. seq goes up by one for every page opened so the newest page
+//is the one that is not followed by seq+1. A page is only part of the log if its epoch is the
+//current log epoch, pages left over from an old experiment never are. check is a CRC-16/XMODEM of
+//the rest of the header, a header half written when power was lost fails it.
+//9 bytes
+typedef struct PageHeader_TAG{
+    uint8_t seq;                   //1 byte
+    uint16_t epoch;                //2 bytes, log epoch the page was written in
+    uint32_t basePeriod;           //4 bytes, period number of the first frame in the page
+    uint16_t check;                //2 bytes
+}PageHeader;
+
+//A position in the log and the values needed to decode the frame found there.
+//18 bytes
+typedef struct LogCursor_TAG{
+    uint8_t page;                          //1 byte
+    uint8_t offset;                        //1 byte, offset of the next frame. 0 when finished
+    uint32_t period;                       //4 bytes, period number of the last frame
+    int16_t last[MEMORY_MAX_PORTS];        //12 bytes, last value of each port
+}LogCursor;
+
 
 /**
 Class: Memory
-    The memory class interfaces and manages the EEPROM on the DAQ. The purpose of this class is to 
+    The memory class interfaces and manages the EEPROM on the DAQ. The purpose of this class is to
     keep the memroyBlock struct up to date, read data, and write data to the EEPROM. The memory class
-    usees the memoryBlock struct to store current pointers in memory. This block is always stored 
-    at address 0 in the EEPROM then the ExperimentBlock is stored just after that. The rest of EEPROM
-    memory is used to store DataBlocks and is organised in a circular FIFO structure. 
-Constructor: 
+    usees the memoryBlock struct to store current pointers in memory. The ExperimentBlock is always
+    stored at address 0 in the EEPROM, followed by the SettingsBlock. The rest of EEPROM memory is a log of pages organised in a
+    circular FIFO structure. The memoryBlock is never written to EEPROM, it is rebuilt on startup
+    by scanning the log. Resetting memory does not move the tail back to the start of the log so
+    every page gets written the same number of times. Writes are not made directly, they are
+    queued in a WriteQueue and written one byte at a time by the EE_READY inturrupt so the main loop
+    and serial reception keep running while data is saved.
+
+    Each page is a PageHeader, up to MEMORY_SKEW_MASK unused bytes and then one frame per DataBlock:
+      port mask        1 byte, never 0
+      period delta     varint, periods since the last frame in the page. Left out if
+                       MEMORY_NEXT_PERIOD is set in the port mask, the delta is then 1
+      values           zig-zag varint for each bit set in the port mask, change since the last
+                       value of that port in the page
+    A summary has MEMORY_SUMMARY set in its port mask and only one port. Its value is the mean and
+    it is followed by:
+      low              varint, mean - low
+      high             varint, high - mean
+      count            varint
+    The first frame in a page is encoded against period basePeriod and values of 0 so a page can be
+    decoded without the page before it. A port mask of 0 after the last frame marks the end of the
+    page. Samples that change slowly take one byte, which stores 4-8 times as many samples as
+    saving a whole DataBlock for every sample.
+
+    Every byte of a frame is written once, and the byte after it is written twice, first as the end
+    of page marker and then as the port mask of the next frame. Frames of a steady sensor are all
+    the same length, so the first frame of a page is skewed by the sequence number of the page
+    and the doubly written bytes move every time the page is reused. The tail moves through every
+    page in turn, so every cell of the log wears at about the same rate. Saving one port every
+    second for a year writes the busiest byte about 118k times and saving six ports about 400k
+    times, against a rated endurance of 100k writes, test/wear.cpp works these out. Use dividers,
+    windows or deadbands to save less often on experiments that run for months at short periods,
+    windows of 60 samples bring six ports down to about 32k writes a year.
+Constructor:
   Memory (void)
     Postcondition: The memroy object has been created.
 Public Variables:
@@ -61,34 +156,80 @@ Public Variables:
 Public Functions:
   void memorySetup ():
     precondition: Memory object must be declared.
-    postcondition: The size of memory header is stored in headerBlockSize. The size of a dataBlock
-      is stored in dataBlockSize.The maximum number of data blocks that can be stored in memory is 
-      stored in maxBlocks. The last MemBlock struct that was saved to memory is loaded into memoryBlock.
+    postcondition: The size of memory header is stored in headerBlockSize. The number of pages that
+      fit in memory is stored in maxPages. The log has been scanned and the pointers in memoryBlock
+      rebuilt.
   void updateExperimentBlock (ExperimentBlock experimentBlock);
-    postcondition: experimentBlock is saved into memory at location EXPERIMENT_BLOCK_ADDRESS
-  void saveDataBlock (DataBlock dataBlock); 
-    postcondition: dataBlock is saved into memory at the address pointed to by tailPtr in memoryBlock.
-      memoryBlock pointers are updated.
+    postcondition: experimentBlock is queued to be saved into memory at location EXPERIMENT_BLOCK_ADDRESS
+  void updateSettingsBlock (SettingsBlock settingsBlock);
+    postcondition: settingsBlock is queued to be saved into memory at location SETTINGS_BLOCK_ADDRESS
+  void saveDataBlock (DataBlock dataBlock);
+    postcondition: dataBlock is queued to be saved as a frame at the end of the log. A new page is
+      opened if it does not fit in the page being written. A DataBlock with no ports is not saved.
+      A summary must only hold one port.
   void loadExperimentBlock (ExperimentBlock* experimentBlock);
     postcondition: The experiment block is read from the EEPROM and stored on the heap.
       ExperimentBlock* points to this new experimentBlock.
-  void loadDataBlock (uint16_t effectiveAddress, DataBlock* dataBlock); 
-    postcondition: The dataBlock stored at the effetiveAddress is read form the EEPROM
-      and stored on the heap. DataBlock* points to this new dataBlock.
-  uint16_t getPtr(uint16_t numValues);
-    postcondition: Returns the address of tailPtr - numValues
-  void updatePtr(uint16_t* ptr);
-    postcondition: the contense of ptr are updated by 1
-  uint16_t tail(void);
-    postcondition: returns the tail pointer from the memroy block
-  void reset (void);
-    postcondition: resets head and tail pointer to the beginning of memory. effectivly
-      resetting memroy.
+  void loadSettingsBlock (SettingsBlock* settingsBlock);
+    postcondition: The settings block is read from the EEPROM into settingsBlock.
+  void firstBlock (LogCursor* cursor);
+    postcondition: cursor points at the oldest DataBlock in the log.
+  void seekBlock (LogCursor* cursor, uint32_t period);
+    postcondition: cursor points at the oldest DataBlock with a period number of at least period,
+      found with a binary search of the page headers. If there is none loadDataBlock returns false.
+  boolean lastPeriod (uint32_t* period);
+    postcondition: period holds the period number of the newest DataBlock in the log. Returns false
+      if the log is empty.
+  boolean loadDataBlock (LogCursor* cursor, DataBlock* dataBlock);
+    postcondition: the DataBlock at cursor is decoded into dataBlock and cursor is moved on to the
+      next one. Returns false if there are no more DataBlocks.
+  uint16_t reset (void);
+    postcondition: moves the head pointer up to a new page and changes the log epoch so
+      records saved before the reset are no longer valid. effectivly resetting memroy. Returns the
+      new log epoch, which must be saved in the experiment block.
+  static Timestamp periodTime (uint32_t startTime, uint32_t periodMs, uint32_t period);
+    postcondition: returns the time period number period of an experiment started at startTime
+      was due.
+  static uint32_t timePeriod (uint32_t startTime, uint32_t periodMs, uint32_t time);
+    precondition: time is not before startTime.
+    postcondition: returns the number of the last period due at or before the unix time time.
+  void flush (void);
+    precondition: inturrupts are on.
+    postcondition: every queued write has been made to the EEPROM.
+  void eepromReady (void);
+    precondition: only called from the EE_READY inturrupt.
+    postcondition: the next queued byte is being written to the EEPROM.
 Private Functions:
     void setEqual (ExperimentBlock* block1, ExperimentBlock* block2);
       postcondition: block1 = block2
-    void setEqual (DataBlock* block1, DataBlock* block2);
-      postcondition: block1 = block2
+    void scanLog (void);
+      postcondition: head and tail pointers in memoryBlock point at the oldest and newest pages
+        that are valid for the current log epoch. writer is at the end of the newest page. With
+        no valid pages both point at the page oldTail returns.
+    uint16_t oldTail (void);
+      postcondition: returns the page after the newest page of the most recent earlier log epoch,
+        0 if there is none.
+    void openPage (uint32_t basePeriod);
+      postcondition: a new page has been started after the tail page and writer points at its
+        first frame.
+    boolean startPage (LogCursor* cursor);
+      postcondition: cursor points at the first frame of the page it holds. Returns false if the
+        page header is not valid.
+    static uint8_t firstFrame (PageHeader* header);
+      postcondition: returns the offset of the first frame of the page with header.
+    boolean decodeFrame (LogCursor* cursor, DataBlock* dataBlock);
+      postcondition: the frame at cursor is decoded into dataBlock and cursor is moved past it.
+        Returns false if there are no more frames in the page.
+    uint8_t encodeFrame (DataBlock* dataBlock, uint8_t* buffer);
+      postcondition: dataBlock has been encoded against writer into buffer. Returns the length.
+    boolean loadHeader (uint16_t page, PageHeader* header);
+      postcondition: the PageHeader of page has been read into header. Returns true if it was
+        written in the current log epoch and its check matches.
+    boolean checkHeader (uint16_t page, PageHeader* header);
+      postcondition: the PageHeader of page has been read into header. Returns true if its check
+        matches, whatever log epoch it was written in.
+    uint16_t checksum (PageHeader* header);
+      postcondition: returns the CRC-16/XMODEM of every byte of header except check.
 **/
 class Memory{
     public:
@@ -98,26 +239,45 @@ class Memory{
     MemoryBlock memoryBlock;
     //public functions
     void memorySetup ();
-    
+
     void updateExperimentBlock (ExperimentBlock experimentBlock);
+    void updateSettingsBlock (SettingsBlock settingsBlock);
     void saveDataBlock (DataBlock dataBlock);
-    
+
     void loadExperimentBlock (ExperimentBlock* experimentBlock);
-    void loadDataBlock (uint16_t effectiveAddress, DataBlock* dataBlock);
-    
-    uint16_t getPtr(uint16_t numValues);
-    void updatePtr(uint16_t* ptr);
-    uint16_t tail(void){return memoryBlock.tailPtr;};
-    void reset (void);
-    
+    void loadSettingsBlock (SettingsBlock* settingsBlock);
+    void firstBlock (LogCursor* cursor);
+    void seekBlock (LogCursor* cursor, uint32_t period);
+    boolean lastPeriod (uint32_t* period);
+    boolean loadDataBlock (LogCursor* cursor, DataBlock* dataBlock);
+
+    uint16_t reset (void);
+    static Timestamp periodTime (uint32_t startTime, uint32_t periodMs, uint32_t period);
+    static uint32_t timePeriod (uint32_t startTime, uint32_t periodMs, uint32_t time);
+    void flush (void){writeQueue.flush();};
+    void eepromReady (void){writeQueue.writeNext();};
+
     private:
     //private variables
     void setEqual (ExperimentBlock* block1, ExperimentBlock* block2);
-    void setEqual (DataBlock* block1, DataBlock* block2);
+    void scanLog (void);
+    uint16_t oldTail (void);
+    void openPage (uint32_t basePeriod);
+    boolean startPage (LogCursor* cursor);
+    static uint8_t firstFrame (PageHeader* header){return sizeof(PageHeader) + (header -> seq & MEMORY_SKEW_MASK);};
+    boolean decodeFrame (LogCursor* cursor, DataBlock* dataBlock);
+    uint8_t encodeFrame (DataBlock* dataBlock, uint8_t* buffer);
+    boolean loadHeader (uint16_t page, PageHeader* header);
+    boolean checkHeader (uint16_t page, PageHeader* header);
+    uint16_t checksum (PageHeader* header);
+    uint16_t pageAddress (uint16_t page){return page*MEMORY_PAGE_SIZE + headerBlockSize;};
+    WriteQueue writeQueue;
+    LogCursor writer;
+    uint16_t logEpoch;
+    uint8_t nextSeq;
     int headerBlockSize;
-    int dataBlockSize;
-    int maxBlocks;
+    int maxPages;
 };
 
 #endif
-    
+
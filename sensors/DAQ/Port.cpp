@@ -10,7 +10,7 @@ Port.cpp
 /**
 Port::Port (void)
   Constructor for port objects. Declares all sensor objects on the heap and stores a pointer to each
-  object in the array ports.
+  object in the array ports. No port has a cached sample.
 @param void
 @return
 **/
@@ -33,44 +33,52 @@ Port::Port (void){
     tempPtr = new Adafruit_MAX31855(PORT_CLOCK, PORT_TEMP5, PORT_DATA_BUS);
     ports[4] = new SensorTemp(tempPtr, false);
     
-    //light sensor declarations
-    Adafruit_GA1A12S202* lightPtr;
-    //light sensor 1
-    lightPtr = new Adafruit_GA1A12S202 (PORT_LIGHT1);
-    ports[5] = new SensorLight(lightPtr, false);
+    //light sensor 1, kept so portSetup can give it a sampler
+    light = new Adafruit_GA1A12S202 (PORT_LIGHT1);
+    ports[5] = new SensorLight(light, false);
+    cached = 0;
 }
 
 /**
-void Port::portSetup (Memory* memoryPtr)
-  Marks which ports are active and saves the total number of active ports. Since port addresses start
+void Port::portSetup (Memory* memoryPtr, WallClock* clockPtr, AnalogSampler* samplerPtr)
+  Starts the analog sampler on the light sensor pin so the light sensor is read without waiting for
+  the ADC. Marks which ports are active and saves the total number of active ports. Since port addresses start
   at one, per miniSDI_12, there is a one number offset between a ports address and its index in the
-  Sensor array.
-Known Bug:
-  There is an issue with correctly reading the error code from the Adafruit_MAX31855 class. 
-  some sensors return the correct error code and some do now. Not sure why this happens. DAQ
-  works fine with all ports active.
+  Sensor array. Each port is read once with takeSample so the error code and the temperature it is
+  checked against come from the same frame.
+Known Bug (fixed):
+  Ports used to be checked with getError and then measureTemp, two separate reads of the
+  Adafruit_MAX31855. A fault that came and went between the two reads made some sensors report the
+  wrong error code. Both are now taken from the same sample.
 @param Memory* memoryPtr
   Takes a pointer to a memory object and saves it in the memory variable.
+@param WallClock* clockPtr
+  Takes a pointer to the wall clock and saves it in the clock variable.
+@param AnalogSampler* samplerPtr
+  Takes a pointer to the analog sampler and gives it to the light sensor.
 @return void
 **/
-//TODO: change this function so that it properly activates ports.
-void Port::portSetup (Memory* memoryPtr){
+void Port::portSetup (Memory* memoryPtr, WallClock* clockPtr, AnalogSampler* samplerPtr){
     memory = memoryPtr;
+    clock = clockPtr;
+    (*samplerPtr).samplerSetup(PORT_LIGHT1);
+    (*light).setSampler(samplerPtr);
     activePorts = 0;
     for (uint8_t portAddress = 0; portAddress < PORT_MAX; portAddress++){
-        // if read error returns the following errors
+        // sample fault code is
         //000 if everything is fine
         //001 if open connection
         //010 if shorted to ground
         //100 if shorted to vcc
-        if ((*ports[portAddress]).getType() == SENSOR_TYPE_A && (*ports[portAddress]).getError() == 0){
-            if ((*ports[portAddress]).measureTemp() != 0){
+        Sample sample = (*ports[portAddress]).takeSample();
+        if ((*ports[portAddress]).getType() == SENSOR_TYPE_A && sample.fault == 0){
+            if (sample.raw != 0){
                 (*ports[portAddress]).setState(true);
                 lastPort = portAddress+1;
                 activePorts++;
             }
         }
-        else if ((*ports[portAddress]).getType() == SENSOR_TYPE_B && (*ports[portAddress]).getError() ==0){
+        else if ((*ports[portAddress]).getType() == SENSOR_TYPE_B && sample.fault == 0){
             (*ports[portAddress]).setState(true);
             lastPort = portAddress+1;
             activePorts++;
@@ -97,26 +105,45 @@ boolean Port::isActive (uint8_t portAddress){
 }
 
 /**
-void Port::sendPortData (uint8_t portAddress)
-  Sends port data to SCIO app via miniSDI_12 protocol.
+void Port::sendPortData (uint8_t portAddress, boolean lastVal, Timestamp* time)
+  Sends port data to SCIO app via miniSDI_12 protocol. A live query, with no time stamp, is answered
+  from the cached sample of the port while it is fresh, so polling the DAQ does not read a
+  thermocouple over SPI again while an experiment is sampling it. Reports clocked by an R
+  experiment always take a new sample.
 @param uint8_t portAddress
   portAddress must be a valid port address between 0 and PORT_MAX.Since port addresses start at 1
   there is an offset of 1 between array position and port address.
+@param boolean lastVal
+  Optional parameter the if true ends the last line sent with the response terminator.
+@param Timestamp* time
+  Optional time stamp for the data, the default NULL time stamps it with the wall clock time the
+  sample was taken.
 @return void
 **/
-void Port::sendPortData (uint8_t portAddress){
+void Port::sendPortData (uint8_t portAddress, boolean lastVal, Timestamp* time){
     if (portAddress == 0){
-        sendAll();
+        sendAll(lastVal, time);
     }
-    else if (portAddress > PORT_MAX || portAddress < 0 || !(*ports[portAddress-1]).isActive()){
+    else if (portAddress > PORT_MAX || !(*ports[portAddress-1]).isActive()){
         respond(0);
     }
     else if ((*ports[portAddress-1]).isActive()){
-        if ((*ports[portAddress-1]).getType() == SENSOR_TYPE_A){
-            dataReport(portAddress, RTC.now().unixtime(), (*ports[portAddress-1]).measureTemp());
-        }
-        else if ((*ports[portAddress-1]).getType() == SENSOR_TYPE_B){
-            dataReport(portAddress, RTC.now().unixtime(), (*ports[portAddress-1]).measureLight());
+        if ((*ports[portAddress-1]).getType() == SENSOR_TYPE_A || (*ports[portAddress-1]).getType() == SENSOR_TYPE_B){
+            Sample sample;
+            Timestamp taken;
+            if (time != NULL || !freshSample(portAddress, &sample, &taken)){
+                sample = readPort(portAddress);
+                taken = cacheTime[portAddress-1];
+            }
+            //only convert to the sensors units once the sample is being reported
+            int32_t value = SDI_NO_VALUE;
+            if (sample.fault == 0){
+                value = (*ports[portAddress-1]).rawToValue(sample.raw);
+            }
+            if (time == NULL){
+                time = &taken;
+            }
+            dataReport(portAddress, time -> seconds, time -> ms, value, (*ports[portAddress-1]).getFracBits(), lastVal);
         }
         else{
             respond(0);
@@ -125,129 +152,504 @@ void Port::sendPortData (uint8_t portAddress){
 }
 
 /**
-void Port::savePortData (uint8_t portAddress, uint32_t currentPeriod)
-  Formats and saves sensor data to EEPROM
+void Port::savePortData (uint8_t portAddress, uint32_t currentPeriod, uint8_t dueMask, Timestamp* liveTime)
+  Formats and saves sensor data to EEPROM. Only the ports in dueMask are sampled, so ports with a
+  slower rate are not read or saved in periods they are not due. Nothing is saved if no port is
+  due. The same data can be sent to the SCIO app as it is saved so the app does not have to wait
+  for the experiment to finish and read it back.
 @param uint8_t portAddress
   portAddress must be a valid port address between 0 and PORT_MAX.Since port addresses start at 1
   there is an offset of 1 between array position and port address.
 @param uint32_t currentPeriod
   The current period of the experiemnt.
+@param uint8_t dueMask
+  Bit n is set if port n+1 is due to be sampled this period.
+@param Timestamp* liveTime
+  Optional time stamp to send the saved data with, the default NULL only saves it.
 @return void
 **/
-void Port::savePortData (uint8_t portAddress, uint32_t currentPeriod){
+void Port::savePortData (uint8_t portAddress, uint32_t currentPeriod, uint8_t dueMask, Timestamp* liveTime){
     //checking boundry conditions
-    if (portAddress < 0 || portAddress > PORT_MAX){
+    if (portAddress > PORT_MAX){
         respond(SDI_ABORT);
     }
-    //if portAddress is 0 save data from all ports
+    //if portAddress is 0 save data from all ports that are due
     else if (portAddress == 0){
-        saveAll(currentPeriod);
+        saveAll(currentPeriod, dueMask, liveTime);
     }
-    else {
+    else if (dueMask & (1 << (portAddress-1))){
         //create a data block to formate and store data in EEPROM
         DataBlock newData;
-        newData.port = portAddress;
         newData.periodNumber = currentPeriod;
-        //need to switch on sensor type to take the correct measurment.
-        if ((*ports[portAddress -1]).getType() == SENSOR_TYPE_A){
-            SENSOR_RETURN_TYPE_A temp = (*ports[portAddress -1]).measureTemp();
-            newData.data = *(reinterpret_cast <uint32_t*> (&temp));
+        newData.portMask = 0;
+        newData.count = 0;
+        samplePort(portAddress, &newData);
+        //save block to memory
+        saveBlock(&newData);
+        if (liveTime != NULL){
+            sendBlock(&newData, *liveTime, false, true);
         }
-        else if ((*ports[portAddress -1]).getType() == SENSOR_TYPE_B){
-            SENSOR_RETURN_TYPE_B temp = (*ports[portAddress -1]).measureLight();
-            newData.data = *(reinterpret_cast <uint32_t*> (&temp));
+    }
+}
+
+/**
+void Port::startWindows (uint8_t* windows)
+  Sets how many samples of each port are summarised in one record, see Aggregator. Called as an
+  M experiment starts or is recovered.
+@param uint8_t* windows
+  The window of each port, port n+1 is windows[n].
+@return void
+**/
+void Port::startWindows (uint8_t* windows){
+    aggregator.start(windows, ports);
+}
+
+/**
+void Port::startDeadbands (uint8_t* bands, uint16_t* silences)
+  Sets the deadband and maximum silence of each port for change driven logging, see Deadband.
+  Called as an M experiment starts or is recovered.
+@param uint8_t* bands
+  The deadband of each port in native units, port n+1 is bands[n].
+@param uint16_t* silences
+  The most periods between saved samples of each port, 0 for no limit and 1 to save every sample.
+@return void
+**/
+void Port::startDeadbands (uint8_t* bands, uint16_t* silences){
+    deadband.start(bands, silences);
+}
+
+/**
+void Port::closeWindows (uint32_t currentPeriod)
+  Saves a summary of the samples waiting in each window as an experiment stops, so a window that
+  was not full is not lost. Each summary is saved at currentPeriod, after any period already
+  saved, so the log stays in period order.
+@param uint32_t currentPeriod
+  The period the experiment stopped in.
+@return void
+**/
+void Port::closeWindows (uint32_t currentPeriod){
+    DataBlock summary;
+    summary.periodNumber = currentPeriod;
+    for (uint8_t port = 0; port < PORT_MAX; port++){
+        if (aggregator.close(port, &summary)){
+            (*memory).saveDataBlock(summary);
         }
-        //save block to memory
-        (*memory).saveDataBlock(newData);
     }
 }
 
 /**
 void Port::sendSavedData (uint16_t amount)
-  Reads sensor data from EEPROM and sends to SCIO app
+  Reads sensor data from EEPROM and sends to SCIO app. Every sample saved in a period is sent as
+  its own data report, and every block saved for a period is sent with it.
 @param uint8_t amount
-  The number of previous measurments to be sent to the scio application. If there are no 
-  measurments stored on the EEPROM and ABORT response is sent. If the requested amount is greater
-  than the number of measurments stored on the EEPROM all data is sent.
+  The number of previous periods to be sent to the scio application. If there are no 
+  measurments stored on the EEPROM and ABORT response is sent. If the requested amount is 0 or
+  greater than the number of periods stored on the EEPROM all data is sent.
 @return void
 **/
 void Port::sendSavedData (uint16_t amount){
     //create information block to store data once it is read from memory
     ExperimentBlock experiment;
     DataBlock dataBlock;
+    LogCursor cursor;
     //load experiement parameters from memory.
     (*memory).loadExperimentBlock(&experiment);
-    //get memory pointers
-    uint16_t ptr = (*memory).getPtr(amount*activePorts);
-    uint16_t tail = (*memory).tail();
+    uint16_t remaining = seekSavedData(amount, &cursor);
     //check if there is no sensor information
-    if (ptr == (*memory).tail()){
+    if (remaining == 0){
         respond(SDI_ABORT);
+        return;
     }
     //itterate through in time forwards order
-    for (ptr ;  ptr != tail; (*memory).updatePtr(&ptr)){
-        //load current data block
-        (*memory).loadDataBlock(ptr, &dataBlock);
+    while ((*memory).loadDataBlock(&cursor, &dataBlock)){
+        remaining--;
         //recover time measurment was taken.
-        uint32_t Time = experiment.startTime + dataBlock.periodNumber* experiment.periodLgth;
-        //recover port address
-        uint8_t port = dataBlock.port;
-        //recovering stored data type
-        if ((*ports[port-1]).getType() == SENSOR_TYPE_A){
-            SENSOR_RETURN_TYPE_A data = *(reinterpret_cast <SENSOR_RETURN_TYPE_A*> (&dataBlock.data));
-            //send data report with correclty formateed sensor data
-            dataReport(port, Time, data);
+        Timestamp time = Memory::periodTime(experiment.startTime, experiment.periodMs, dataBlock.periodNumber);
+        //send the terminator after the newest sample
+        sendBlock(&dataBlock, time, remaining == 0, false);
+    }
+}
+
+/**
+void Port::sendSavedPage (uint32_t cursor, uint16_t pageSize)
+  Reads one page of sensor data from EEPROM and sends it to the SCIO app. The cursor is a period
+  number, the page starts at the oldest saved period at or after it. The response always ends with
+  the cursor of the next page, so a dump that was cut short can carry on from the last page
+  received and a master that polls only gets periods it has not seen. If nothing has been saved
+  since cursor only the cursor is sent back. Period numbers start again at 1 with every experiment.
+  A page holds whole periods, every block saved for a period is sent with it.
+Known Bug (fixed):
+  A period saved as several blocks, the summary of a window and the samples of the other ports,
+  was counted once for each block and the page could end part way through it. The next page started
+  after that period, so the rest of its blocks were never sent.
+@param uint32_t cursor
+  The period number to start at.
+@param uint16_t pageSize
+  The most periods to send. 0 sends every period after cursor.
+@return void
+**/
+void Port::sendSavedPage (uint32_t cursor, uint16_t pageSize){
+    ExperimentBlock experiment;
+    DataBlock dataBlock;
+    LogCursor logCursor;
+    uint16_t sent = 0;
+    (*memory).loadExperimentBlock(&experiment);
+    (*memory).seekBlock(&logCursor, cursor);
+    while ((*memory).loadDataBlock(&logCursor, &dataBlock)){
+        //a period can be saved as several blocks, the page only ends before a new period
+        if (dataBlock.periodNumber + 1 != cursor){
+            if (pageSize != 0 && sent == pageSize){
+                break;
+            }
+            sent++;
         }
-        else if ((*ports[port-1]).getType() == SENSOR_TYPE_B){
-            SENSOR_RETURN_TYPE_B data = *(reinterpret_cast <SENSOR_RETURN_TYPE_B*> (&dataBlock.data));
-            //semd data report with correctly formated sensor data
-            dataReport(port, Time, data);
+        Timestamp time = Memory::periodTime(experiment.startTime, experiment.periodMs, dataBlock.periodNumber);
+        sendBlock(&dataBlock, time, false, false);
+        cursor = dataBlock.periodNumber + 1;
+    }
+    endReport(cursor);
+}
+
+/**
+void Port::sendQuery (uint8_t portMask, uint32_t start, uint32_t end)
+  Sends the saved samples from some ports over a range of time. The times are turned into period
+  numbers with the start time and period length of the experiment, the first period is found with
+  Memory::seekBlock and periods are read from there until the last one in the range. Only the
+  periods in the range are decoded, not the whole log. A period that is not due on a whole second
+  is in the range if the second it is due in is. A range that ends after the newest saved period,
+  such as an open ended query, stops at the log tail.
+Known Bug (fixed):
+  An open ended query has an end of SDI_NO_COUNT and end + 1 wrapped round to 0, so nothing was
+  sent. A far off end could also overflow Memory::timePeriod.
+@param uint8_t portMask
+  Bit n is set to send samples from port n+1. 0 for every port.
+@param uint32_t start
+  The unix time of the first sample to send.
+@param uint32_t end
+  The unix time of the last sample to send, SDI_NO_COUNT for every sample from start on.
+@return void
+**/
+void Port::sendQuery (uint8_t portMask, uint32_t start, uint32_t end){
+    ExperimentBlock experiment;
+    DataBlock dataBlock;
+    LogCursor cursor;
+    uint32_t sent = 0;
+    uint32_t lastPeriod;
+    if (portMask == 0){
+        portMask = MEMORY_PORT_MASK;
+    }
+    (*memory).loadExperimentBlock(&experiment);
+    //nothing after the log tail is saved, times up to it are inside the experiment so the period
+    //numbers below can not overflow
+    if (experiment.periodMs != 0 && end >= start && end >= experiment.startTime
+        && (*memory).lastPeriod(&lastPeriod)
+        && start <= Memory::periodTime(experiment.startTime, experiment.periodMs, lastPeriod).seconds){
+        //first period due in or after second start and last period due in or before second end
+        uint32_t firstPeriod = 0;
+        if (start > experiment.startTime){
+            firstPeriod = Memory::timePeriod(experiment.startTime, experiment.periodMs, start);
+            if (Memory::periodTime(experiment.startTime, experiment.periodMs, firstPeriod).seconds < start){
+                firstPeriod++;
+            }
         }
-        //send terminator
-        if (ptr == tail-1){
-            terminate();
+        if (end != SDI_NO_COUNT
+            && end < Memory::periodTime(experiment.startTime, experiment.periodMs, lastPeriod).seconds){
+            lastPeriod = Memory::timePeriod(experiment.startTime, experiment.periodMs, end + 1);
+            if (Memory::periodTime(experiment.startTime, experiment.periodMs, lastPeriod).seconds > end){
+                lastPeriod--;
+            }
+        }
+        (*memory).seekBlock(&cursor, firstPeriod);
+        while ((*memory).loadDataBlock(&cursor, &dataBlock) && dataBlock.periodNumber <= lastPeriod){
+            dataBlock.portMask &= portMask;
+            Timestamp time = Memory::periodTime(experiment.startTime, experiment.periodMs, dataBlock.periodNumber);
+            sent += sendBlock(&dataBlock, time, false, false);
         }
-        //send endline
-        endLine();
     }
+    endReport(sent);
 }
 
-
+/**
+void Port::sendSavedFrames (uint16_t amount)
+  Reads sensor data from EEPROM and sends it to the SCIO app as binary frames, see sendFrame. A
+  header frame with the experiment start time, period length in milliseconds and the fractional bits of each
+  port is sent first, then one data frame for every saved block and an end frame with the number
+  of periods sent, a period saved as several blocks is sent as a data frame for each. A summary has MEMORY_SUMMARY set in its port mask and its value is followed by
+  its min, max and a byte with its count. Values are sent as 32 bit fixed point numbers so the app does not need to know
+  how to convert any sensors native units. Nothing is sent as text, if there is no saved data the
+  end frame holds a count of 0.
+@param uint16_t amount
+  The number of previous periods to be sent to the scio application. If the requested amount is
+  0 or greater than the number of periods stored on the EEPROM all data is sent.
+@return void
+**/
+void Port::sendSavedFrames (uint16_t amount){
+    ExperimentBlock experiment;
+    DataBlock dataBlock;
+    LogCursor cursor;
+    uint8_t body[SDI_FRAME_MAX_BODY];
+    uint8_t length = 0;
+    uint16_t sent = 0;
+    uint32_t period = 0;
+    (*memory).loadExperimentBlock(&experiment);
+    //header frame
+    length += putLong(&body[length], experiment.startTime);
+    length += putLong(&body[length], experiment.periodMs);
+    for (uint8_t port = 0; port < PORT_MAX; port++){
+        body[length++] = (*ports[port]).getFracBits();
+    }
+    sendFrame(SDI_FRAME_HEADER, body, length);
+    //one data frame for each block in time forwards order
+    seekSavedData(amount, &cursor);
+    while ((*memory).loadDataBlock(&cursor, &dataBlock)){
+        length = 0;
+        length += putLong(&body[length], dataBlock.periodNumber);
+        body[length++] = dataBlock.portMask | (dataBlock.count != 0 ? MEMORY_SUMMARY : 0);
+        for (uint8_t port = 0; port < PORT_MAX; port++){
+            if (dataBlock.portMask & (1 << port)){
+                length += putLong(&body[length], (*ports[port]).rawToValue(dataBlock.data[port]));
+                if (dataBlock.count != 0){
+                    length += putLong(&body[length], (*ports[port]).rawToValue(dataBlock.low));
+                    length += putLong(&body[length], (*ports[port]).rawToValue(dataBlock.high));
+                    body[length++] = dataBlock.count;
+                }
+            }
+        }
+        sendFrame(SDI_FRAME_DATA, body, length);
+        if (sent == 0 || dataBlock.periodNumber != period){
+            sent++;
+            period = dataBlock.periodNumber;
+        }
+    }
+    //end frame
+    body[0] = sent & 0xFF;
+    body[1] = sent >> 8;
+    sendFrame(SDI_FRAME_END, body, 2);
+}
 
 /**
-void Port::sendAll (void)
+void Port::sendAll (boolean lastVal, Timestamp* time)
   Sends sensor data from each active port.
-@param void
+@param boolean lastVal
+  If true the line for the last active port ends with the response terminator.
+@param Timestamp* time
+  The time stamp for the data, NULL to read it from the wall clock.
 @return void
 **/
-void Port::sendAll (void){
+void Port::sendAll (boolean lastVal, Timestamp* time){
     for (uint8_t portAddress = 1; portAddress <= PORT_MAX; portAddress++){
         if((*ports[portAddress-1]).isActive()){
-            sendPortData (portAddress);
-            if (portAddress != lastPort){
-                endLine();
-            }
+            sendPortData (portAddress, lastVal && portAddress == lastPort, time);
         }
     }
 }
 
 /**
-void Port::saveAll (uint32_t currentPeriod)
-  Saves all active port data to memroy.
+void Port::saveAll (uint32_t currentPeriod, uint8_t dueMask, Timestamp* liveTime)
+  Saves the data of every active port that is due to memroy as a single data block. The port mask
+  of the block records which ports it covers. Ports that are summarised are left out of the block
+  and added to their windows, see saveBlock. The master is still sent every sample live.
 @param uint32_t currentPeriod
   The current period of the running experiment.
+@param uint8_t dueMask
+  Bit n is set if port n+1 is due to be sampled this period.
+@param Timestamp* liveTime
+  The time stamp to send the block with, NULL to only save it.
 @return void
 **/
-void Port::saveAll (uint32_t currentPeriod){
+void Port::saveAll (uint32_t currentPeriod, uint8_t dueMask, Timestamp* liveTime){
+    DataBlock newData;
+    newData.periodNumber = currentPeriod;
+    newData.portMask = 0;
+    newData.count = 0;
     for (uint8_t portAddress = 1; portAddress <= PORT_MAX; portAddress++){
-        if((*ports[portAddress-1]).isActive()){
-            savePortData (portAddress, currentPeriod);
+        if((*ports[portAddress-1]).isActive() && (dueMask & (1 << (portAddress-1)))){
+            samplePort (portAddress, &newData);
         }
     }
+    saveBlock(&newData);
+    if (liveTime != NULL){
+        sendBlock(&newData, *liveTime, false, true);
+    }
 }
 
+/**
+void Port::saveBlock (DataBlock* dataBlock)
+  The aggregation stage between sampling and memory. Samples from a port with a window are added
+  to it instead of being saved, and the summary of each window that fills is saved as a frame of
+  its own. The rest are saved as one data block, leaving out the samples the deadband drops. Each
+  frame has its own period number so the time of a sample is known however many periods were
+  dropped before it. dataBlock is left as it was.
+@param DataBlock* dataBlock
+  The samples taken in one period.
+@return void
+**/
+void Port::saveBlock (DataBlock* dataBlock){
+    DataBlock summary;
+    uint8_t portMask = (*dataBlock).portMask;
+    summary.periodNumber = (*dataBlock).periodNumber;
+    for (uint8_t port = 0; port < PORT_MAX; port++){
+        if (!(portMask & (1 << port))){
+            continue;
+        }
+        if (!aggregator.isSummarised(port)){
+            if (!deadband.keep(port, (*dataBlock).data[port], (*dataBlock).periodNumber)){
+                (*dataBlock).portMask &= ~(1 << port);
+            }
+            continue;
+        }
+        (*dataBlock).portMask &= ~(1 << port);
+        if (aggregator.add(port, (*dataBlock).data[port], &summary)){
+            (*memory).saveDataBlock(summary);
+        }
+    }
+    (*memory).saveDataBlock(*dataBlock);
+    (*dataBlock).portMask = portMask;
+}
 
+/**
+void Port::samplePort (uint8_t portAddress, DataBlock* dataBlock)
+  Takes one sample from a port and adds it to a data block in native units. A sample with a
+  fault is left out of the data block.
+@param uint8_t portAddress
+  portAddress must be a valid port address between 1 and PORT_MAX.
+@param DataBlock* dataBlock
+  The data block to add the sample to.
+@return void
+**/
+void Port::samplePort (uint8_t portAddress, DataBlock* dataBlock){
+    Sample sample = readPort(portAddress);
+    if (sample.fault == 0){
+        dataBlock -> data[portAddress-1] = sample.raw;
+        dataBlock -> portMask |= (1 << (portAddress-1));
+    }
+}
 
+/**
+Sample Port::readPort (uint8_t portAddress)
+  Takes a new sample from a port and caches it with the wall clock time it was taken. Every sample taken by an
+  experiment goes through here, so the cache of a port being sampled is never older than its rate.
+@param uint8_t portAddress
+  portAddress must be a valid port address between 1 and PORT_MAX.
+@return Sample
+  The new sample.
+**/
+Sample Port::readPort (uint8_t portAddress){
+    Sample sample = (*ports[portAddress -1]).takeSample();
+    cache[portAddress-1] = sample;
+    cacheTime[portAddress-1] = (*clock).now();
+    cachedAt[portAddress-1] = millis();
+    cached |= (1 << (portAddress-1));
+    return sample;
+}
 
+/**
+boolean Port::freshSample (uint8_t portAddress, Sample* sample, Timestamp* time)
+  Looks up the cached sample of a port. Its age is taken from millis, the wall clock only moves
+  once a tick of the timer and jumps when it is synced to the RTC.
+@param uint8_t portAddress
+  portAddress must be a valid port address between 1 and PORT_MAX.
+@param Sample* sample
+  Set to the cached sample if it is fresh.
+@param Timestamp* time
+  Set to the wall clock time the cached sample was taken if it is fresh.
+@return boolean
+  True if the port has a sample taken less than PORT_CACHE_TTL ms ago.
+  False if it has to be read again.
+**/
+boolean Port::freshSample (uint8_t portAddress, Sample* sample, Timestamp* time){
+    if (!(cached & (1 << (portAddress-1))) || millis() - cachedAt[portAddress-1] >= PORT_CACHE_TTL){
+        return false;
+    }
+    *sample = cache[portAddress-1];
+    *time = cacheTime[portAddress-1];
+    return true;
+}
 
+/**
+uint8_t Port::sendBlock (DataBlock* dataBlock, Timestamp time, boolean lastVal, boolean live)
+  Sends every sample in a data block as its own data report, converted from native units. A
+  summary is sent as a summary report with its mean, min, max and count.
+@param DataBlock* dataBlock
+  The data block to send.
+@param Timestamp time
+  The time stamp the samples were taken at.
+@param boolean lastVal
+  If true the report for the last port in the block ends with the response terminator.
+@param boolean live
+  If true the reports are marked as sent live, see dataReport.
+@return uint8_t
+  The number of data reports sent.
+**/
+uint8_t Port::sendBlock (DataBlock* dataBlock, Timestamp time, boolean lastVal, boolean live){
+    uint8_t sent = 0;
+    for (uint8_t port = 1; port <= PORT_MAX; port++){
+        if (!(dataBlock -> portMask & (1 << (port-1)))){
+            continue;
+        }
+        boolean last = lastVal && (dataBlock -> portMask >> port) == 0;
+        Sensor* sensor = ports[port-1];
+        if (dataBlock -> count != 0){
+            summaryReport(port, time.seconds, time.ms, (*sensor).rawToValue(dataBlock -> data[port-1]), (*sensor).rawToValue(dataBlock -> low),
+                          (*sensor).rawToValue(dataBlock -> high), dataBlock -> count, (*sensor).getFracBits(), last, live);
+        }
+        else{
+            dataReport(port, time.seconds, time.ms, (*sensor).rawToValue(dataBlock -> data[port-1]), (*sensor).getFracBits(), last, live);
+        }
+        sent++;
+    }
+    return sent;
+}
 
+/**
+uint16_t Port::seekSavedData (uint16_t amount, LogCursor* cursor)
+  Points cursor at the first block of the last amount of periods saved in EEPROM. A period can be
+  saved as several blocks, a summary and the samples of other ports, so periods are counted by
+  their period number and not by block. The log is read forwards once to count the saved periods
+  and again up to the first one to be sent. Any queued writes are made first so every saved period
+  is found.
+Known Bug (fixed):
+  Every block used to be counted as a period, so with windows fewer periods were sent than were
+  asked for and the first one could be cut part way through.
+@param uint16_t amount
+  The number of periods wanted. 0 for every saved period.
+@param LogCursor* cursor
+  The cursor to set.
+@return uint16_t
+  The number of blocks that can be read from cursor, 0 if nothing is saved.
+**/
+uint16_t Port::seekSavedData (uint16_t amount, LogCursor* cursor){
+    DataBlock dataBlock;
+    uint16_t stored = 0;
+    uint16_t blocks = 0;
+    uint32_t period = 0;
+    (*memory).flush();
+    //count the saved periods so the last amount of them can be found
+    (*memory).firstBlock(cursor);
+    while ((*memory).loadDataBlock(cursor, &dataBlock)){
+        if (blocks == 0 || dataBlock.periodNumber != period){
+            stored++;
+            period = dataBlock.periodNumber;
+        }
+        blocks++;
+    }
+    if (amount == 0 || amount > stored){
+        amount = stored;
+    }
+    //skip the blocks of the older periods, cursor is left on the first block of the next one
+    (*memory).firstBlock(cursor);
+    LogCursor start = *cursor;
+    uint16_t periods = 0;
+    while ((*memory).loadDataBlock(cursor, &dataBlock)){
+        if (periods == 0 || dataBlock.periodNumber != period){
+            if (periods++ == stored - amount){
+                break;
+            }
+            period = dataBlock.periodNumber;
+        }
+        blocks--;
+        start = *cursor;
+    }
+    *cursor = start;
+    return blocks;
+}
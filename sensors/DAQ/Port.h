@@ -12,10 +12,12 @@ Port.h
 
 #ifndef PORT_H
 #define PORT_H
-#include <Wire.h>              //I2C library used to communicate with RTC
-#include "RTClib.h"            //RTC library from Adafruit
 #include "Sensor.h"            //Sensor library used to interface with sensors
 #include "Memory.h"            //Memory library used to interface with EEPROM on DAQ
+#include "WallClock.h"         //unix time kept from the RTC square wave
+#include "Aggregator.h"        //summaries of windows of samples
+#include "Deadband.h"          //change driven logging
+#include "AnalogSampler.h"     //free running oversampled ADC for the light sensor
 // max ports avalibale
 #define PORT_MAX 6
 // global constants for this class. All constants contributed to this class will begin with PORT_
@@ -33,14 +35,19 @@ Port.h
 #define PORT_TEMP5 10
 // light sensors
 #define PORT_LIGHT1 A0
+// milliseconds a cached sample is fresh enough to answer a live query
+#define PORT_CACHE_TTL 1000
 
 /**
 Class: Port
   The port class manages all of the ports on the DAQ. The purpose of this class is to 
   maintain the ports array. It consists of an array of Sensor pointers that point to 
   the different sensor objects implemented in the Sensor class, a pointer to the memory 
-  class, a real time clock object. It also stores the number of active ports in activePorts 
-  and the last port in the array in lastPort. To make it easier to interface with the 
+  class, a pointer to the wall clock, the aggregator that summarises windows of samples before
+  they are saved and the deadband that drops samples that have not changed. It also stores the number of active ports in activePorts 
+  and the last port in the array in lastPort. The last sample taken from each port is cached with
+  the time it was taken, so live queries are answered without reading the sensor again while an
+  experiment is already sampling it. To make it easier to interface with the 
   Experiment class the Sensors* array is left public.
 Constructor: Port(void)
   Postcondition: All sensors are decalred on the heap and pointers to sensor objects are stored 
@@ -49,36 +56,90 @@ Public Varibales:
   Sensor* Ports[]
      An array of ports objects that must be maintained by this class.
 Public Functions:
-  void portSetup (Memory* memoryPtr):
-    precondistion: memoryPtr must not be null.
-    postcondition: Memory contains a pointer to the memory class. Active ports contains the number
-    of active ports. The highest array value with an active port is stored in lastPort.
+  void portSetup (Memory* memoryPtr, WallClock* clockPtr, AnalogSampler* samplerPtr):
+    precondistion: memoryPtr, clockPtr and samplerPtr must not be null.
+    postcondition: Memory contains a pointer to the memory class. Clock contains a pointer to the
+    wall clock. samplerPtr is converting the light sensor pin and the light sensor reads from it.
+    Active ports contains the number of active ports. The highest array value with an
+    active port is stored in lastPort.
   boolean isActive (uint8_t portAddress):
     precondition: port address must be valid. If a invalid port address is entered an abort command
     is sent via miniSDI_12 protocol.
     postcondition: The state of a sensor with a portAddress is returned.
   uint8_t getNumberActive(void):
     postcondition: the number of active ports on the DAQ is returned.
-  void sendPortData (uint8_t portAddress):
+  void sendPortData (uint8_t portAddress, boolean lastVal = false, Timestamp* time = NULL):
     precondition: port address must be valid. If a invalid port address is entered an abort command
     is sent via miniSDI_12 protocol.
-    postcondition: Current port data from portAddress has been sent to SCIO app via miniSDI_12 protocol.
-  void savePortData (uint8_t portAddress, uint32_t currentPeriod):
+    postcondition: Current port data from portAddress has been sent to SCIO app via miniSDI_12 protocol,
+    time stamped time. If time is NULL the data is the cached sample of the port if it was taken
+    less than PORT_CACHE_TTL ms ago, time stamped when it was taken, otherwise a new sample time
+    stamped from the wall clock. If lastVal is true the
+    last line ends with the response terminator.
+  void savePortData (uint8_t portAddress, uint32_t currentPeriod, uint8_t dueMask, Timestamp* liveTime = NULL):
     precondition: port address must be valid. If a invalid port address is entered an abort command
     is sent via miniSDI_12 protocol.
-    postcondition: current port data from portAddress has been saved to memory at the next avaliable 
-    slot
+    postcondition: current port data from the ports of portAddress that are in dueMask has been
+    saved to memory at the next avaliable slot, or added to the window of a port that is summarised. Unless liveTime is NULL the saved data has also been sent to the SCIO app via
+    miniSDI_12 protocol as live data reports, time stamped liveTime.
+  void startWindows (uint8_t* windows):
+    precondition: windows holds PORT_MAX window sizes.
+    postcondition: the samples of port n+1 are saved as a summary of every windows[n] samples, a
+      window of 1 saves every sample. No samples are waiting in a window.
+  void startDeadbands (uint8_t* bands, uint16_t* silences):
+    precondition: bands and silences hold PORT_MAX settings.
+    postcondition: a sample of port n+1 is only saved if it differs from the last one saved by
+      more than bands[n] native units, or silences[n] periods have passed since it. See Deadband.
+  void closeWindows (uint32_t currentPeriod):
+    postcondition: the samples waiting in every window have been saved as a summary at period
+      currentPeriod.
   void sendSavedData (uint16_t amount):
     precondition: There must be at least one measurment saved in memory and Amount must be valid. 
     If a invalid amount is entered or there are no saved measurments then an abort command is 
     sent via miniSDI_12 protocol.
-    postcondition: the last amount of saved measurments has been sent to the SCIO app via miniSDI_12
-    protocol. These are sent in time forward order meaning the oldest recorded measurment is sent first.
+    postcondition: the measurments from the last amount of saved periods have been sent to the SCIO
+    app via miniSDI_12 protocol. These are sent in time forward order meaning the oldest recorded
+    measurment is sent first.
+  void sendSavedPage (uint32_t cursor, uint16_t pageSize):
+    postcondition: up to pageSize saved periods, starting at the period number cursor, have been sent
+    to the SCIO app via miniSDI_12 protocol in time forward order, followed by the cursor of the
+    next page.
+  void sendQuery (uint8_t portMask, uint32_t start, uint32_t end):
+    postcondition: every saved sample from a port in portMask taken between the unix times start
+    and end, inclusive, has been sent to the SCIO app via miniSDI_12 protocol in time forward order,
+    followed by the number of samples sent. A portMask of 0 is every port. An end of SDI_NO_COUNT
+    is every sample from start on.
+  void sendSavedFrames (uint16_t amount):
+    precondition: Amount must be valid.
+    postcondition: the measurments from the last amount of saved periods have been sent to the SCIO
+    app as binary frames, in time forward order, between a header frame and an end frame that holds
+    the number of periods sent.
 Private Functions:
-  void sendAll (void):
-    postcondition: all saved measurments are sent to the SCIO app via miniSDI_12 protocol.
-  void saveAll (uint32_t currentPeriod):
-    postcondition: data from every active port is saved to memeory.
+  void sendAll (boolean lastVal, Timestamp* time):
+    postcondition: all saved measurments are sent to the SCIO app via miniSDI_12 protocol. If lastVal
+    is true the last line ends with the response terminator.
+  void saveAll (uint32_t currentPeriod, uint8_t dueMask, Timestamp* liveTime):
+    postcondition: data from every active port in dueMask is saved to memeory in one data block. Unless liveTime
+    is NULL the block has also been sent to the SCIO app as live data reports.
+  void saveBlock (DataBlock* dataBlock):
+    postcondition: the samples in dataBlock from ports that are not summarised have been saved to
+      memory unless they are in the deadband, the rest added to their windows and the summary of
+      any window that is full saved.
+  void samplePort (uint8_t portAddress, DataBlock* dataBlock):
+    postcondition: a sample from portAddress has been added to dataBlock unless the sensor reported
+    a fault.
+  Sample readPort (uint8_t portAddress):
+    postcondition: returns a new sample from portAddress, it is now the cached sample of the port.
+  boolean freshSample (uint8_t portAddress, Sample* sample, Timestamp* time):
+    postcondition: if the cached sample of portAddress was taken less than PORT_CACHE_TTL ms ago it
+      has been stored in sample, the time it was taken in time and true is returned.
+  uint8_t sendBlock (DataBlock* dataBlock, Timestamp time, boolean lastVal, boolean live):
+    postcondition: every sample in dataBlock has been sent to the SCIO app via miniSDI_12 protocol
+    as its own data report, or a summary report if dataBlock is a summary. If lastVal is true the last report ends with the response terminator.
+    If live is true every report starts with SDI_LIVE. Returns the number of data reports sent.
+  uint16_t seekSavedData (uint16_t amount, LogCursor* cursor):
+    postcondition: cursor points at the first block of the last amount of saved periods. Returns how
+    many blocks can be read from cursor.
 **/
 
 class Port{
@@ -88,20 +149,39 @@ class Port{
     //public variables
     Sensor* ports[PORT_MAX];
     //public functions
-    void portSetup (Memory* memoryPtr);
+    void portSetup (Memory* memoryPtr, WallClock* clockPtr, AnalogSampler* samplerPtr);
     boolean isActive (uint8_t portAddress);
     uint8_t getNumberActive(void){return activePorts;};
-    void sendPortData (uint8_t portAddress);
-    void savePortData (uint8_t portAddress, uint32_t currentPeriod);
+    void sendPortData (uint8_t portAddress, boolean lastVal = false, Timestamp* time = NULL);
+    void savePortData (uint8_t portAddress, uint32_t currentPeriod, uint8_t dueMask, Timestamp* liveTime = NULL);
+    void startWindows (uint8_t* windows);
+    void startDeadbands (uint8_t* bands, uint16_t* silences);
+    void closeWindows (uint32_t currentPeriod);
     void sendSavedData (uint16_t amount);
+    void sendSavedPage (uint32_t cursor, uint16_t pageSize);
+    void sendQuery (uint8_t portMask, uint32_t start, uint32_t end);
+    void sendSavedFrames (uint16_t amount);
     
     private:
     Memory* memory;
-    RTC_DS1307 RTC;
+    WallClock* clock;
+    Adafruit_GA1A12S202* light;
+    Aggregator aggregator;
+    Deadband deadband;
     uint8_t lastPort;
     uint8_t activePorts;
-    void sendAll (void);
-    void saveAll (uint32_t currentPeriod);
+    Sample cache[PORT_MAX];          //last sample taken from each port
+    Timestamp cacheTime[PORT_MAX];   //wall clock time each cached sample was taken
+    uint32_t cachedAt[PORT_MAX];     //millis when each cached sample was taken, for its age
+    uint8_t cached;                  //bit n is set once port n+1 has a cached sample
+    void sendAll (boolean lastVal, Timestamp* time);
+    void saveAll (uint32_t currentPeriod, uint8_t dueMask, Timestamp* liveTime);
+    void saveBlock (DataBlock* dataBlock);
+    void samplePort (uint8_t portAddress, DataBlock* dataBlock);
+    Sample readPort (uint8_t portAddress);
+    boolean freshSample (uint8_t portAddress, Sample* sample, Timestamp* time);
+    uint8_t sendBlock (DataBlock* dataBlock, Timestamp time, boolean lastVal, boolean live);
+    uint16_t seekSavedData (uint16_t amount, LogCursor* cursor);
 
 };
 #endif
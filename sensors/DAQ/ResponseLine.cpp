@@ -0,0 +1,146 @@
+/**
+ResponseLine.cpp
+  Implementation for the ResponseLine class.
+**/
+#include "ResponseLine.h"
+#include "miniSDI_12.h"
+#include <avr/pgmspace.h>
+
+//powers of ten that fit in 32 bits, largest first
+static const uint32_t powersOfTen[] PROGMEM = {
+    1000000000UL, 100000000UL, 10000000UL, 1000000UL, 100000UL, 10000UL, 1000UL, 100UL, 10UL, 1UL
+};
+
+/**
+ResponseLine::ResponseLine (void)
+  Constructor for a response line. Starts with an empty line.
+@param void
+@return
+**/
+ResponseLine::ResponseLine (void){
+    length = 0;
+}
+
+/**
+void ResponseLine::put (char c)
+  Adds a character to the line. There is always room left for the <CR><LF> added by send.
+@param char c
+  The character to add.
+@return void
+**/
+void ResponseLine::put (char c){
+    if (length < LINE_LENGTH - 2){
+        buffer[length++] = c;
+    }
+}
+
+/**
+void ResponseLine::putNumber (uint32_t value)
+  Adds a number in decimal. Each digit is found by counting how many times its power of ten can
+  be taken away, at most 9 subtractions a digit. Leading zeros are skipped.
+@param uint32_t value
+  The number to add.
+@return void
+**/
+void ResponseLine::putNumber (uint32_t value){
+    boolean started = false;
+    for (uint8_t i = 0; i < sizeof(powersOfTen)/sizeof(powersOfTen[0]); i++){
+        uint32_t power = pgm_read_dword(&powersOfTen[i]);
+        char digit = '0';
+        while (value >= power){
+            value -= power;
+            digit++;
+        }
+        if (digit != '0' || started || power == 1){
+            put(digit);
+            started = true;
+        }
+    }
+}
+
+/**
+void ResponseLine::putSigned (int32_t value)
+  Adds a signed number in decimal.
+@param int32_t value
+  The number to add.
+@return void
+**/
+void ResponseLine::putSigned (int32_t value){
+    if (value < 0){
+        put('-');
+        putNumber(-(uint32_t)value);
+    }
+    else{
+        putNumber(value);
+    }
+}
+
+/**
+void ResponseLine::putFixed (int32_t value, uint8_t fracBits)
+  Adds a fixed point value as a signed decimal with two decimal places. Only integer math is used
+  so the float printing code is never linked in. The fraction is rounded to the nearest hundredth.
+@param int32_t value
+  The fixed point value, SDI_NO_VALUE is added as nan.
+@param uint8_t fracBits
+  The number of fractional bits in value, at most 16.
+@return void
+**/
+void ResponseLine::putFixed (int32_t value, uint8_t fracBits){
+    if (value == SDI_NO_VALUE){
+        put('n');
+        put('a');
+        put('n');
+        return;
+    }
+    uint32_t magnitude = value;
+    if (value < 0){
+        put('-');
+        magnitude = -(uint32_t)value;
+    }
+    else{
+        put('+');
+    }
+    uint32_t whole = magnitude >> fracBits;
+    uint32_t fraction = magnitude & ((1UL << fracBits) - 1);
+    //scale the fraction to hundredths, adding half of the last bit rounds to nearest
+    fraction = (fraction * 100 + ((1UL << fracBits) >> 1)) >> fracBits;
+    if (fraction == 100){
+        whole++;
+        fraction = 0;
+    }
+    putNumber(whole);
+    put('.');
+    //an 8 bit division, the fraction is 0 to 99
+    uint8_t hundredths = fraction;
+    put('0' + hundredths / 10);
+    put('0' + hundredths % 10);
+}
+
+/**
+void ResponseLine::putHeader (int a)
+  Adds the start of every response, the DAQ id and an address.
+@param int a
+  The address.
+@return void
+**/
+void ResponseLine::putHeader (int a){
+    put('0');
+    put('0');
+    putNumber(SDI_DAQ_ID);
+    put(',');
+    putSigned(a);
+}
+
+/**
+void ResponseLine::send (void)
+  Ends the line with <CR><LF>, the same as Serial.println, and writes it to the serial port in one
+  call. The line is emptied so the object can be used again.
+@param void
+@return void
+**/
+void ResponseLine::send (void){
+    buffer[length++] = '\r';
+    buffer[length++] = '\n';
+    Serial.write((const uint8_t*)buffer, length);
+    length = 0;
+}
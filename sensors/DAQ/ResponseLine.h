@@ -0,0 +1,60 @@
+/**
+ResponseLine.h
+  Class definiton for the ResponseLine class.
+**/
+#if (ARDUINO >= 100)
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#ifndef RESPONSELINE_H
+#define RESPONSELINE_H
+
+// global constants for this class. All constants contributed to this class will begin with LINE_
+// longest line that can be built, a summary report
+// "002,6,4294967295.999,-2147483648.00,-2147483648.00,-2147483648.00,255:<CR><LF>" is 72
+#define LINE_LENGTH 72
+
+/**
+Class: ResponseLine
+  Builds one line of a miniSDI_12 response in a fixed buffer so the whole line can be handed to the
+  UART in a single write. Numbers are converted by subtracting powers of ten instead of the
+  division by ten Print uses, a 32 bit division is a slow library call on the AVR. Nothing is
+  allocated, a ResponseLine is meant to live on the stack for as long as it takes to send one line.
+  Anything added once the buffer is full is dropped.
+Constructor: ResponseLine (void)
+  postcondition: the line is empty.
+Public Functions:
+  void put (char c):
+    postcondition: c has been added to the line.
+  void putNumber (uint32_t value):
+    postcondition: value has been added to the line in decimal.
+  void putSigned (int32_t value):
+    postcondition: value has been added to the line in decimal, with a "-" if it is negative.
+  void putFixed (int32_t value, uint8_t fracBits):
+    postcondition: value has been added to the line with a sign and two decimal places, +23.25 for
+      93 quarter degrees. SDI_NO_VALUE is added as nan.
+  void putHeader (int a):
+    postcondition: the DAQ id and address a have been added to the line, "002,a".
+  void send (void):
+    postcondition: the line has been written to the serial port followed by <CR><LF>, and emptied.
+**/
+class ResponseLine{
+    public:
+    //constructor
+    ResponseLine (void);
+    //public functions
+    void put (char c);
+    void putNumber (uint32_t value);
+    void putSigned (int32_t value);
+    void putFixed (int32_t value, uint8_t fracBits);
+    void putHeader (int a);
+    void send (void);
+
+    private:
+    char buffer[LINE_LENGTH];
+    uint8_t length;
+};
+
+#endif
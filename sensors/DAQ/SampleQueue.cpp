@@ -0,0 +1,71 @@
+/**
+SampleQueue.cpp
+  Implementation for the SampleQueue class.
+**/
+#include "SampleQueue.h"
+
+/**
+SampleQueue::SampleQueue (void)
+  Constructor for the sample queue. Starts with an empty queue.
+@param void
+@return
+**/
+SampleQueue::SampleQueue (void){
+    head = 0;
+    tail = 0;
+    overruns = 0;
+}
+
+/**
+boolean SampleQueue::post (uint32_t period)
+  Adds a sample due token to the queue. The token is stored before head is moved so the consumer
+  never sees a slot that has not been written yet. Both are volatile, so the compiler keeps the
+  stores in that order.
+@param uint32_t period
+  The period number the sample is due for.
+@return boolean
+  True if the token was queued.
+  False if the queue was full and the token was dropped.
+**/
+boolean SampleQueue::post (uint32_t period){
+    uint8_t next = (head + 1) & SAMPLEQUEUE_MASK;
+    if (next == tail){
+        overruns++;
+        return false;
+    }
+    tokens[head] = period;
+    head = next;
+    return true;
+}
+
+/**
+boolean SampleQueue::fetch (uint32_t* period)
+  Removes the oldest token from the queue. The 32 bit token is copied out before tail is moved so
+  the producer can not overwrite it while it is being read. Both are volatile, so the compiler
+  keeps the load ahead of the store to tail.
+@param uint32_t* period
+  Pointer to the location to store the period number.
+@return boolean
+  True if a token was removed.
+  False if the queue was empty.
+**/
+boolean SampleQueue::fetch (uint32_t* period){
+    uint8_t current = tail;
+    if (current == head){
+        return false;
+    }
+    *period = tokens[current];
+    tail = (current + 1) & SAMPLEQUEUE_MASK;
+    return true;
+}
+
+/**
+void SampleQueue::clear (void)
+  Discards any waiting tokens by moving tail up to head.
+@param void
+@return void
+**/
+void SampleQueue::clear (void){
+    tail = head;
+    overruns = 0;
+}
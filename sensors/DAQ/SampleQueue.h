@@ -0,0 +1,62 @@
+/**
+SampleQueue.h
+  Class definiton for the SampleQueue class.
+**/
+#if (ARDUINO >= 100)
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#ifndef SAMPLEQUEUE_H
+#define SAMPLEQUEUE_H
+
+// global constants for this class. All constants contributed to this class will begin with SAMPLEQUEUE_
+// the size must be a power of two so the indices can wrap with a mask.
+#define SAMPLEQUEUE_SIZE 8
+#define SAMPLEQUEUE_MASK (SAMPLEQUEUE_SIZE - 1)
+
+/**
+Class: SampleQueue
+  A lock free single producer, single consumer ring of "sample due" tokens. The experiment
+  inturrupt is the only producer and the main loop is the only consumer. Each token is the
+  period number the sample belongs to, which together with the experiment block is enough to
+  recover the time the sample was due. Each side only writes its own 8 bit index and the AVR
+  stores a byte in a single instruction, so neither side needs to turn off inturrupts. The tokens
+  are volatile as well as the indices so the compiler can not move a token store or load past the
+  index store that hands the slot over.
+Constructor: SampleQueue (void)
+  postcondition: the queue is empty.
+Public Functions:
+  boolean post (uint32_t period):
+    precondition: only called from the experiment inturrupt.
+    postcondition: a token for period has been added to the queue. If the queue is full the token
+      is dropped, the overrun count is incremented and false is returned.
+  boolean fetch (uint32_t* period):
+    precondition: only called from the main loop.
+    postcondition: the oldest token has been removed from the queue and stored in period. Returns
+      false if the queue was empty.
+  void clear (void):
+    precondition: only called from the main loop.
+    postcondition: all waiting tokens are discarded and the overrun count is reset.
+  uint8_t getOverruns (void):
+    postcondition: returns the number of tokens dropped since the last clear.
+**/
+class SampleQueue{
+    public:
+    //constructor
+    SampleQueue (void);
+    //public functions
+    boolean post (uint32_t period);
+    boolean fetch (uint32_t* period);
+    void clear (void);
+    uint8_t getOverruns (void){return overruns;};
+
+    private:
+    volatile uint32_t tokens[SAMPLEQUEUE_SIZE];   //volatile so it stays ordered with head and tail
+    volatile uint8_t head;        //written only by the producer
+    volatile uint8_t tail;        //written only by the consumer
+    volatile uint8_t overruns;
+};
+
+#endif
@@ -56,28 +56,30 @@ SensorTemp::SensorTemp (Adafruit_MAX31855* sensorInit, boolean stateInit){
     sensor = sensorInit;
     setState(stateInit);
     setType(SENSOR_TYPE_A);
+    setFracBits(SENSOR_FRAC_BITS_A);
 }
 
 /**
-double SensorTemp::measureTemp (void)
-  Takes a temperature reading from an Adafruit_MAX31855 object
+int16_t SensorTemp::measureTemp (void)
+  Takes a temperature reading from an Adafruit_MAX31855 object. Use takeSample to get the fault
+  code that goes with the reading.
 @param void
-@return double
-  Returns the temperature in degrees celsius
+@return int16_t
+  Returns the temperature in quarter degrees celsius
 **/
-double SensorTemp::measureTemp(void){
-    return (*sensor).readCelsius();
+int16_t SensorTemp::measureTemp(void){
+    return Adafruit_MAX31855::frameToRaw((*sensor).readFrame());
 }
 
 /**
-float SensorTemp::measureLight (void)
+uint32_t SensorTemp::measureLight (void)
   Because this is a virtual function it needs to be defined. It has no function in the SensorTemp class.
 @param void
-@return float
-  Returns null
+@return uint32_t
+  Returns 0
 **/
-float SensorTemp::measureLight(void){
-    return NULL;
+uint32_t SensorTemp::measureLight(void){
+    return 0;
 }
 
 /**
@@ -95,6 +97,50 @@ uint8_t SensorTemp::getError(void){
     return (*sensor).readError();
 }
 
+/**
+Sample SensorTemp::takeSample (void)
+  Reads one frame from an Adafruit_MAX31855 object and decodes every field from it. Calling
+  getError and measureTemp reads two different frames which may not agree with each other.
+@param void
+@return Sample
+  The temperature in quarter degrees celsius.
+  The fault code, see getError.
+  The cold junction temperature in sixteenths of a degree celsius.
+**/
+Sample SensorTemp::takeSample(void){
+    Sample sample;
+    uint32_t frame = (*sensor).readFrame();
+    sample.raw = Adafruit_MAX31855::frameToRaw(frame);
+    sample.fault = Adafruit_MAX31855::frameToError(frame);
+    sample.internal = Adafruit_MAX31855::frameToInternalRaw(frame);
+    return sample;
+}
+
+/**
+int32_t SensorTemp::rawToValue (int16_t raw)
+  Converts a reading in native units to fixed point degrees celsius. Quarter degrees are already
+  fixed point with SENSOR_FRAC_BITS_A fractional bits so nothing is changed.
+@param int16_t raw
+  The temperature in quarter degrees celsius.
+@return int32_t
+  The temperature in quarter degrees celsius.
+**/
+int32_t SensorTemp::rawToValue(int16_t raw){
+    return raw;
+}
+
+/**
+int16_t SensorTemp::valueToRaw (int32_t value)
+  Converts fixed point degrees celsius to a reading in native units, the reverse of rawToValue.
+@param int32_t value
+  The temperature in quarter degrees celsius.
+@return int16_t
+  The temperature in quarter degrees celsius.
+**/
+int16_t SensorTemp::valueToRaw(int32_t value){
+    return value;
+}
+
 
 
 //*************************Light functions****************************//
@@ -111,28 +157,29 @@ SensorLight::SensorLight (Adafruit_GA1A12S202* sensorInit, boolean stateInit){
     sensor = sensorInit;
     setState(stateInit);
     setType(SENSOR_TYPE_B);
+    setFracBits(SENSOR_FRAC_BITS_B);
 }
 
 /**
-float SensorLight::measureTemp (void)
+int16_t SensorLight::measureTemp (void)
   Because this is a virtual function it needs to be defined. It has no function in the SensorLight class.
 @param void
-@return double
-  Returns null
+@return int16_t
+  Returns 0
 **/
-double SensorLight::measureTemp(void){
-    return NULL;
+int16_t SensorLight::measureTemp(void){
+    return 0;
 }
 
 /**
-double SensorLight::measureLight (void)
+uint32_t SensorLight::measureLight (void)
   Takes a light intensity reading from an Adafruit_GA1A12S202 object
 @param void
-@return float
-  Returns the current light intensity in lumens
+@return uint32_t
+  Returns the current light intensity in lumens with SENSOR_FRAC_BITS_B fractional bits
 **/
-float SensorLight::measureLight(void){
-    return (*sensor).readLux ();
+uint32_t SensorLight::measureLight(void){
+    return Adafruit_GA1A12S202::rawToLuxFixed((*sensor).readRaw());
 }
 
 /**
@@ -147,3 +194,47 @@ uint8_t SensorLight::getError(void){
     return 0;
 }
 
+/**
+Sample SensorLight::takeSample (void)
+  Takes a light intensity reading from an Adafruit_GA1A12S202 object.
+@param void
+@return Sample
+  The analog reading of the current light intensity with GA1A12S202_EXTRA_BITS fractional bits,
+  see rawToValue. Once the light sensor has a sampler this is the newest oversampled reading and
+  does not wait for the ADC. The fault code and internal temperature are always 0.
+**/
+Sample SensorLight::takeSample(void){
+    Sample sample;
+    sample.raw = (*sensor).readRaw();
+    sample.fault = 0;
+    sample.internal = 0;
+    return sample;
+}
+
+/**
+int32_t SensorLight::rawToValue (int16_t raw)
+  Converts a reading in native units to fixed point lumens.
+@param int16_t raw
+  The analog reading.
+@return int32_t
+  The light intensity in lumens with SENSOR_FRAC_BITS_B fractional bits.
+**/
+int32_t SensorLight::rawToValue(int16_t raw){
+    return Adafruit_GA1A12S202::rawToLuxFixed(raw);
+}
+
+/**
+int16_t SensorLight::valueToRaw (int32_t value)
+  Converts fixed point lumens to the nearest analog reading, the reverse of rawToValue.
+@param int32_t value
+  The light intensity in lumens with SENSOR_FRAC_BITS_B fractional bits.
+@return int16_t
+  The analog reading with GA1A12S202_EXTRA_BITS fractional bits.
+**/
+int16_t SensorLight::valueToRaw(int32_t value){
+    if (value < 0){
+        value = 0;
+    }
+    return Adafruit_GA1A12S202::luxToRawFixed(value);
+}
+
@@ -20,9 +20,20 @@ Provides the class definitions for each sensor that is usable on the DAQ
 
 // global constants for this class. All constants contributed to this class will begin with SENSOR_
 #define SENSOR_TYPE_A 1
-#define SENSOR_RETURN_TYPE_A double
+#define SENSOR_FRAC_BITS_A 2                          // quarter degrees
 #define SENSOR_TYPE_B 2
-#define SENSOR_RETURN_TYPE_B float
+#define SENSOR_FRAC_BITS_B GA1A12S202_LUX_FRAC_BITS   // 1/1024 lux
+
+//A single reading from a sensor. Every field is taken from the same transaction with the sensor
+//so the fault code always describes the value it was returned with. Readings are kept in the
+//sensors native units so no float math is done while sampling, rawToValue converts them when
+//they are reported.
+//This struct is 5 bytes
+typedef struct Sample_TAG{
+    int16_t raw;                   // 2 bytes, reading in the sensors native units
+    uint8_t fault;                 // 1 byte, sensor error code. 0 if everything is fine
+    int16_t internal;              // 2 bytes, cold junction temperature in native units. 0 if the sensor has none
+}Sample;
 
 /**
 Class: Sensor
@@ -31,46 +42,67 @@ Class: Sensor
   that are common to all sensors as well as a virtual function for each individual sensor.
   The purpose of this classs is to be able to iterate over all sensors regardless of type.
   The state and type of the sensor are stored in the state and type variables. The type
-  of sensor needs to be store to accomidate different return types.
+  of sensor needs to be store to accomidate different return types. Values are fixed point numbers
+  with fracBits fractional bits so no float math is needed to take or report a reading.
 Constructor: Sensor(void)
   Creates a sensor object
-  Postcondition: state and type are undeclared. These will be declared in child classes.
+  Postcondition: state, type and fracBits are undeclared. These will be declared in child classes.
 Virtual Functions:
-  virtual double measureTemp (void) = 0:
-    virtual function that is define in the child class used to measure temperature.
-  virtual float measureLight (void) = 0:
-    virtual function that is define in the child class used to measure light intensity
+  virtual int16_t measureTemp (void) = 0:
+    virtual function that is define in the child class used to measure temperature in quarter degrees.
+  virtual uint32_t measureLight (void) = 0:
+    virtual function that is define in the child class used to measure light intensity in fixed
+    point lux
   virtual uint8_t getError(void) = 0:
     virtual function this define in child class used to return any error codes specific to sensors
+  virtual Sample takeSample (void) = 0:
+    virtual function that is define in the child class used to take one reading. The raw reading,
+    fault code and internal temperature are all returned from a single transaction with the sensor.
+  virtual int32_t rawToValue (int16_t raw) = 0:
+    virtual function that is define in the child class used to convert a reading in native units
+    to the sensors units as a fixed point number with getFracBits fractional bits.
+  virtual int16_t valueToRaw (int32_t value) = 0:
+    virtual function that is define in the child class used to convert a value in the sensors units
+    back to the nearest reading in native units, the reverse of rawToValue.
 Getter Functions:
   boolean isActive (void):
     checks to see if a sensor is active returns true if it is
   int getType (void):
     returns the sensor type
+  uint8_t getFracBits (void):
+    returns the number of fractional bits in the values returned by rawToValue
 Setter Functions:
   void setState (boolean newState):
     postcondition: state is set to newState
   void setType (int newType):
     postcondition: type is set to newType
+  void setFracBits (uint8_t newFracBits):
+    postcondition: fracBits is set to newFracBits
 **/
 class Sensor{
   public:
     //constructor
     Sensor (void);
     //pure virtual functions to be define in child classes
-    virtual double measureTemp (void) = 0;
-    virtual float measureLight (void) = 0;
+    virtual int16_t measureTemp (void) = 0;
+    virtual uint32_t measureLight (void) = 0;
     virtual uint8_t getError(void) = 0;
+    virtual Sample takeSample (void) = 0;
+    virtual int32_t rawToValue (int16_t raw) = 0;
+    virtual int16_t valueToRaw (int32_t value) = 0;
     //member functions needed in each child class
     //getter
     boolean isActive (void);
     int getType (void){return type;};
+    uint8_t getFracBits (void){return fracBits;};
     //setter
     void setState (boolean newState);
     void setType (int newType){type = newType;};
+    void setFracBits (uint8_t newFracBits){fracBits = newFracBits;};
   private:
     boolean state;
     int type;
+    uint8_t fracBits;
 };
 
 /**
@@ -83,21 +115,32 @@ Constructor: SensorTemp(Adafruit_MAX31855* sensorInit, boolean stateInit)
   Adafruit_MAX31855* sensor is set to sensorInit.
   boolean state is set to statInit
   type is set to SENSOR_TYPE_A
-double measureTemp (void):
-  returns temperature in degreese celcius
-float measureLight (void):
-  returns NULL
+  fracBits is set to SENSOR_FRAC_BITS_A
+int16_t measureTemp (void):
+  returns temperature in quarter degrees celcius
+uint32_t measureLight (void):
+  returns 0
 uint8_t getEffor(void):
   returns error code from Adafruit_MAX31855 temperature sensor
+Sample takeSample (void):
+  returns the temperature in quarter degrees, the error code and the cold junction temperature in
+  sixteenths of a degree decoded from one frame read from the Adafruit_MAX31855.
+int32_t rawToValue (int16_t raw):
+  returns raw quarter degrees unchanged, they are already fixed point celcius.
+int16_t valueToRaw (int32_t value):
+  returns value unchanged.
 **/
 class SensorTemp: public Sensor {
   public:
     //constructor
     SensorTemp (Adafruit_MAX31855* sensorInit, boolean stateInit);
     //member functions
-    double measureTemp (void);
-    float measureLight (void);
+    int16_t measureTemp (void);
+    uint32_t measureLight (void);
     uint8_t getError(void);
+    Sample takeSample (void);
+    int32_t rawToValue (int16_t raw);
+    int16_t valueToRaw (int32_t value);
   private:
     Adafruit_MAX31855* sensor;
 };
@@ -112,22 +155,33 @@ Constructor: SensorTemp(Adafruit_GA1A12S202* sensorInit, boolean stateInit)
   Adafruit_GA1A12S202* sensor is set to sensorInit.
   boolean state is set to statInit
   type is set to SENSOR_TYPE_B
-double measureTemp (void):
-  returns NULL
-float measureLight (void):
-  returns light intensity in lumens
+  fracBits is set to SENSOR_FRAC_BITS_B
+int16_t measureTemp (void):
+  returns 0
+uint32_t measureLight (void):
+  returns light intensity in fixed point lumens
 uint8_t getEffor(void):
   returns 0
   provides the possiblity to reutrn error codes for sensor
+Sample takeSample (void):
+  returns the analog reading of the light intensity, with GA1A12S202_EXTRA_BITS fractional bits,
+  with a fault code of 0.
+int32_t rawToValue (int16_t raw):
+  returns the raw analog reading converted to fixed point lumens.
+int16_t valueToRaw (int32_t value):
+  returns the analog reading nearest to value fixed point lumens.
 **/
 class SensorLight: public Sensor{
   public:
     //constructor
     SensorLight (Adafruit_GA1A12S202* sensorInit, boolean stateInit);
     //member functions
-    double measureTemp (void);
-    float measureLight (void);
+    int16_t measureTemp (void);
+    uint32_t measureLight (void);
     uint8_t getError(void);
+    Sample takeSample (void);
+    int32_t rawToValue (int16_t raw);
+    int16_t valueToRaw (int32_t value);
   private:
     Adafruit_GA1A12S202* sensor;
 };
@@ -0,0 +1,202 @@
+/**
+WallClock.cpp
+  Implementation for the WallClock class.
+**/
+#include "WallClock.h"
+
+/**
+WallClock::WallClock (void)
+  Constructor for the wall clock. The clock is not synced until the rate is set.
+@param void
+@return
+**/
+WallClock::WallClock (void){
+    seconds = 0;
+    ticks = 0;
+    shift = 0;
+    nextCheck = 0;
+}
+
+/**
+void WallClock::countEnded (void)
+  Called from the count start inturrupt as the timer goes back to 0. Adds the count that has just
+  ended to the ticks and carries whole seconds. The rate is a power of 2 so this is a shift and a
+  mask, no division inside the inturrupt.
+@param void
+@return void
+**/
+void WallClock::countEnded (void){
+    int32_t total = ticks + (int32_t)WALLCLOCK_TOP + 1;
+    seconds += total >> shift;
+    ticks = total & ((1L << shift) - 1);
+}
+
+/**
+void WallClock::setRate (uint16_t rate)
+  Sets the rate of the square wave the timer is counting. The part of a tick the timer had counted
+  at the old rate is lost when the rate changes, so the clock is synced to the RTC again. This waits
+  up to a second.
+@param uint16_t rate
+  The rate in Hz, a power of 2.
+@return void
+**/
+void WallClock::setRate (uint16_t rate){
+    uint8_t oldSREG = SREG;
+    cli();
+    shift = 0;
+    while ((1U << shift) < rate){
+        shift++;
+    }
+    SREG = oldSREG;
+    sync();
+}
+
+/**
+void WallClock::setCount (uint16_t top, uint16_t count)
+  Moves the timer to count ticks into a count of top+1 ticks without changing the time. The ticks
+  the timer had counted, including a count that has ended but not been added by the inturrupt yet,
+  are added to the clock and the new count taken off, so the clock reads the same after the move.
+@param uint16_t top
+  The new top of the timer.
+@param uint16_t count
+  The new value of the counter, no more than top.
+@return void
+**/
+void WallClock::setCount (uint16_t top, uint16_t count){
+    uint8_t oldSREG = SREG;
+    cli();
+    ticks += counted() - count;
+    WALLCLOCK_COUNTER = count;
+    WALLCLOCK_TOP = top;
+    TIFR1 = (1 << WALLCLOCK_COUNT_FLAG);     // the count is already added
+    SREG = oldSREG;
+}
+
+/**
+uint32_t WallClock::sync (void)
+  Reads the RTC until it starts a new second and sets the clock to it. The square wave edges line
+  up with the start of a second, so the clock is in step with the RTC to within the time of one
+  read, under a millisecond. Gives up after WALLCLOCK_SYNC_TIMEOUT in case the RTC is stopped.
+@param void
+@return uint32_t
+  the unix time of the second that has just started.
+**/
+uint32_t WallClock::sync (void){
+    RTC_DS1307 RTC;                                        //reading the time since i2c requires inturrupts
+    DateTime time = RTC.now();
+    uint8_t second = time.second();
+    unsigned long start = millis();
+    while (time.second() == second && millis() - start < WALLCLOCK_SYNC_TIMEOUT){
+        time = RTC.now();
+    }
+    uint8_t oldSREG = SREG;
+    cli();
+    seconds = time.unixtime();
+    ticks = -counted();
+    SREG = oldSREG;
+    nextCheck = time.unixtime() + WALLCLOCK_RESYNC;
+    return time.unixtime();
+}
+
+/**
+uint32_t WallClock::nextSecond (void)
+  Waits for the clock to start a new second. This reads the counter, not the RTC, so the second
+  starts on the square wave edge with no I2C in the way. Gives up after WALLCLOCK_SYNC_TIMEOUT in
+  case the square wave has stopped.
+@param void
+@return uint32_t
+  the unix time of the second that has just started.
+**/
+uint32_t WallClock::nextSecond (void){
+    uint32_t second = now().seconds;
+    unsigned long start = millis();
+    while (now().seconds == second && millis() - start < WALLCLOCK_SYNC_TIMEOUT){
+    }
+    return now().seconds;
+}
+
+/**
+uint32_t WallClock::countToSecond (void)
+  Moves the timer so its current count ends as the clock starts the next second, without changing
+  the time. The count start inturrupt then fires on the square wave edge that starts the second,
+  so nothing waits for it.
+@param void
+@return uint32_t
+  the unix time of the second the count ends on.
+**/
+uint32_t WallClock::countToSecond (void){
+    uint8_t oldSREG = SREG;
+    cli();
+    int32_t total = ticks + counted();
+    uint32_t second = seconds + (total >> shift) + 1;
+    setCount((1U << shift) - 1, total & ((1L << shift) - 1));
+    SREG = oldSREG;
+    return second;
+}
+
+/**
+Timestamp WallClock::now (void)
+  Reads the time from the clock and the counter, no I2C.
+@param void
+@return Timestamp
+  the unix time to the millisecond.
+**/
+Timestamp WallClock::now (void){
+    uint8_t oldSREG = SREG;
+    cli();
+    int32_t total = ticks + counted();
+    uint32_t time = seconds;
+    SREG = oldSREG;
+    Timestamp stamp;
+    stamp.seconds = time + (total >> shift);
+    stamp.ms = ((total & ((1L << shift) - 1)) * 1000) >> shift;
+    return stamp;
+}
+
+/**
+void WallClock::serviceClock (void)
+  Called from the main loop. Every WALLCLOCK_RESYNC seconds the RTC is read once and compared with
+  the clock read just before and just after it. The RTC is only wrong if it is outside that range,
+  so a read that crosses the start of a second is never taken for an error. The clock is moved by
+  whole seconds, the ticks were counted from the RTC and are already in step with it.
+@param void
+@return void
+**/
+void WallClock::serviceClock (void){
+    Timestamp before = now();
+    if ((int32_t)(before.seconds - nextCheck) < 0){
+        return;
+    }
+    RTC_DS1307 RTC;
+    uint32_t time = RTC.now().unixtime();
+    Timestamp after = now();
+    if (time < before.seconds || time > after.seconds){
+        uint8_t oldSREG = SREG;
+        cli();
+        seconds += time - after.seconds;
+        SREG = oldSREG;
+    }
+    nextCheck = time + WALLCLOCK_RESYNC;
+}
+
+/**
+int32_t WallClock::counted (void)
+  The ticks the timer has counted since the start of the current count. Called with inturrupts
+  off, so a count that has ended but not been added by the inturrupt is counted in full. The
+  counter is read again if the count ends during the read.
+@param void
+@return int32_t
+  The ticks counted.
+**/
+int32_t WallClock::counted (void){
+    uint8_t ended = TIFR1 & (1 << WALLCLOCK_COUNT_FLAG);
+    int32_t count = WALLCLOCK_COUNTER;
+    if (!ended && (TIFR1 & (1 << WALLCLOCK_COUNT_FLAG))){
+        ended = 1;
+        count = WALLCLOCK_COUNTER;
+    }
+    if (ended){
+        count += (int32_t)WALLCLOCK_TOP + 1;
+    }
+    return count;
+}
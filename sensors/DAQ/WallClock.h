@@ -0,0 +1,82 @@
+/**
+WallClock.h
+  Class definiton for the WallClock class.
+**/
+#if (ARDUINO >= 100)
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#ifndef WALLCLOCK_H
+#define WALLCLOCK_H
+#include <Wire.h>              //I2C library used to communicate with RTC
+#include "RTClib.h"            //RTC library from Adafruit
+#include "Memory.h"            //Timestamp
+
+// global constants for this class. All constants contributed to this class will begin with WALLCLOCK_
+// the timer counting the RTC square wave, it is shared with the experiment.
+#define WALLCLOCK_COUNTER TCNT1
+#define WALLCLOCK_TOP ICR1
+#define WALLCLOCK_COUNT_FLAG OCF1A      //set as the timer goes back to 0
+#define WALLCLOCK_SYNC_TIMEOUT 1100     //milliseconds to wait for a new second
+#define WALLCLOCK_RESYNC 3600           //seconds between checks of the clock against the RTC
+
+/**
+Class: WallClock
+  Keeps the unix time in RAM so time stamps do not need an I2C read of the RTC. The timer counting
+  the RTC square wave ticks it, whatever rate the experiment has picked, so it never drifts from the
+  RTC. The time is the seconds and ticks at the start of the timer's current count plus the
+  counter, the count start inturrupt adds each count to it as the timer goes back to 0. It is synced
+  to the RTC on startup and whenever the rate changes, and checked against it every
+  WALLCLOCK_RESYNC seconds from the main loop in case a count was ever missed.
+Constructor: WallClock (void)
+  postcondition: the clock is at 0 counting a 1 Hz square wave. It must be synced before it is used.
+Public Functions:
+  void countEnded (void):
+    precondition: only called from the count start inturrupt, before the length of the new count
+      is loaded.
+    postcondition: the count that has just ended has been added to the time.
+  void setRate (uint16_t rate):
+    precondition: rate is a power of 2 and the RTC square wave has just been set to it.
+    postcondition: the clock counts rate ticks a second and has been synced to the RTC.
+  void setCount (uint16_t top, uint16_t count):
+    postcondition: the timer is count ticks into a count of top+1 ticks and the time is unchanged.
+  uint32_t sync (void):
+    postcondition: the RTC has just started a new second and the clock has been set to it, returns
+      its unix time.
+  uint32_t nextSecond (void):
+    postcondition: the clock has just started a new second, returns its unix time.
+  uint32_t countToSecond (void):
+    postcondition: the current count of the timer ends as the clock starts the next second, returns
+      its unix time. The time is unchanged.
+  Timestamp now (void):
+    postcondition: returns the unix time to the millisecond.
+  void serviceClock (void):
+    precondition: called from the main loop.
+    postcondition: if WALLCLOCK_RESYNC seconds have passed since the last check the clock has been
+      compared with the RTC and corrected if it was out by a second or more.
+**/
+class WallClock{
+    public:
+    //constructor
+    WallClock (void);
+    //public functions
+    void countEnded (void);
+    void setRate (uint16_t rate);
+    void setCount (uint16_t top, uint16_t count);
+    uint32_t sync (void);
+    uint32_t nextSecond (void);
+    uint32_t countToSecond (void);
+    Timestamp now (void);
+    void serviceClock (void);
+
+    private:
+    volatile uint32_t seconds;    //unix time at the start of the current count
+    volatile int32_t ticks;       //ticks past seconds at the start of the current count
+    uint8_t shift;                //the rate is 1 << shift Hz
+    uint32_t nextCheck;           //unix time of the next check against the RTC
+    int32_t counted (void);
+};
+
+#endif
@@ -0,0 +1,96 @@
+/**
+WriteQueue.cpp
+  Implementation for the WriteQueue class.
+**/
+#include "WriteQueue.h"
+
+/**
+WriteQueue::WriteQueue (void)
+  Constructor for the write queue. Starts with an empty queue.
+@param void
+@return
+**/
+WriteQueue::WriteQueue (void){
+    head = 0;
+    tail = 0;
+}
+
+/**
+void WriteQueue::queueByte (uint16_t address, uint8_t value)
+  Adds a byte to the queue and turns on the EE_READY inturrupt. The byte is stored before head is
+  moved so the inturrupt never sees a slot that has not been written yet, the barrier keeps the
+  compiler from moving the stores to pending past the store to head. If the queue is full this
+  waits with inturrupts on for the EE_READY inturrupt to make room. With inturrupts off that
+  inturrupt can not fire, so the oldest byte is written from here instead of waiting forever.
+@param uint16_t address
+  The EEPROM address to write to.
+@param uint8_t value
+  The value to write.
+@return void
+**/
+void WriteQueue::queueByte (uint16_t address, uint8_t value){
+    uint8_t next = (head + 1) & WRITEQUEUE_MASK;
+    while (next == tail){
+        makeRoom();
+    }
+    pending[head].address = address;
+    pending[head].value = value;
+    asm volatile ("" ::: "memory");
+    head = next;
+    EECR |= (1 << EERIE);
+}
+
+/**
+void WriteQueue::writeNext (void)
+  Called from the EE_READY inturrupt, which only fires once the last write has finished. Starts
+  writing the next queued byte that differs from what is in the EEPROM. Turns off the EE_READY
+  inturrupt once the queue is empty, it would fire continuously otherwise.
+@param void
+@return void
+**/
+void WriteQueue::writeNext (void){
+    while (tail != head){
+        //read the slot only after head says it has been written
+        asm volatile ("" ::: "memory");
+        PendingByte byte = pending[tail];
+        tail = (tail + 1) & WRITEQUEUE_MASK;
+        if (eeprom_read_byte((const uint8_t*)(uintptr_t)byte.address) != byte.value){
+            EEAR = byte.address;
+            EEDR = byte.value;
+            //EEMPE then EEPE must be set within 4 cycles, inturrupts are already off in the ISR
+            EECR |= (1 << EEMPE);
+            EECR |= (1 << EEPE);
+            return;
+        }
+    }
+    EECR &= ~(1 << EERIE);
+}
+
+/**
+void WriteQueue::flush (void)
+  Waits for every queued byte to be written. If inturrupts are on they stay on so serial bytes
+  keep arriving while the queue drains, if they are off the bytes are written from here.
+@param void
+@return void
+**/
+void WriteQueue::flush (void){
+    while (!isEmpty()){
+        makeRoom();
+    }
+    eeprom_busy_wait();
+}
+
+/**
+void WriteQueue::makeRoom (void)
+  One turn of a wait for the queue to drain. The EE_READY inturrupt is on while anything is queued
+  and drains the queue by itself if inturrupts are on. With inturrupts off it can not fire, so the
+  oldest byte is written from here once the last write has finished.
+@param void
+@return void
+**/
+void WriteQueue::makeRoom (void){
+    if (!(SREG & (1 << SREG_I))){
+        eeprom_busy_wait();
+        writeNext();
+    }
+}
@@ -0,0 +1,79 @@
+/**
+WriteQueue.h
+  Class definiton for the WriteQueue class.
+**/
+#if (ARDUINO >= 100)
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#ifndef WRITEQUEUE_H
+#define WRITEQUEUE_H
+#include <avr/eeprom.h>
+
+// global constants for this class. All constants contributed to this class will begin with WRITEQUEUE_
+// the size must be a power of two so the indices can wrap with a mask.
+#define WRITEQUEUE_SIZE 32
+#define WRITEQUEUE_MASK (WRITEQUEUE_SIZE - 1)
+
+//One byte waiting to be written to EEPROM.
+//3 bytes
+typedef struct PendingByte_TAG{
+    uint16_t address;              // 2 bytes
+    uint8_t value;                 // 1 byte
+}PendingByte;
+
+/**
+Class: WriteQueue
+  A RAM write-back queue for the EEPROM. Writing a byte to the EEPROM takes about 3.3ms, instead of
+  waiting for each write with inturrupts off the bytes are queued and the EE_READY inturrupt writes
+  them one at a time. The main loop is the only producer and the EE_READY inturrupt is the only
+  consumer, each side only writes its own 8 bit index so neither side needs to turn off inturrupts.
+  Bytes that already hold the queued value are skipped so the queue wears the EEPROM no more than
+  EEPROM.updateBlock does.
+Constructor: WriteQueue (void)
+  postcondition: the queue is empty.
+Public Functions:
+  void queueByte (uint16_t address, uint8_t value):
+    precondition: only called from the main loop, not from an inturrupt.
+    postcondition: value has been queued to be written to address. If the queue is full this waits
+      for the EE_READY inturrupt to make room, or with inturrupts off writes the oldest byte itself.
+  void queueBlock (uint16_t address, const T& value):
+    precondition: only called from the main loop, not from an inturrupt.
+    postcondition: every byte of value has been queued starting at address.
+  void writeNext (void):
+    precondition: only called from the EE_READY inturrupt.
+    postcondition: the next queued byte that differs from the EEPROM has been written. The EE_READY
+      inturrupt is turned off once the queue is empty.
+  void flush (void):
+    precondition: only called from the main loop, not from an inturrupt.
+    postcondition: every queued byte has been written and the last write has finished. Anything read
+      from the EEPROM after this returns matches what was queued.
+  boolean isEmpty (void):
+    postcondition: returns true if there are no bytes waiting to be written.
+**/
+class WriteQueue{
+    public:
+    //constructor
+    WriteQueue (void);
+    //public functions
+    void queueByte (uint16_t address, uint8_t value);
+    template <class T> void queueBlock (uint16_t address, const T& value){
+        const uint8_t* bytePtr = (const uint8_t*)(const void*)&value;
+        for (uint16_t i = 0; i < sizeof(value); i++){
+            queueByte(address + i, bytePtr[i]);
+        }
+    };
+    void writeNext (void);
+    void flush (void);
+    boolean isEmpty (void){return head == tail;};
+
+    private:
+    void makeRoom (void);
+    PendingByte pending[WRITEQUEUE_SIZE];
+    volatile uint8_t head;        //written only by the main loop
+    volatile uint8_t tail;        //written only by the EE_READY inturrupt
+};
+
+#endif
@@ -4,12 +4,20 @@
 #include "Experiment.h"
 #include "Memory.h"
 #include "miniSDI_12.h"
+#include "BaudRate.h"
+#include "CommandParser.h"
+#include "WallClock.h"
+#include "AnalogSampler.h"
 
 //#include "RTClib.h"
 
 Memory memory;            //the memory class to manager EEPROM
 Port ports;               //the porst class to manage current sensors
 Experiment experiment;    //the experiment class to manage experiments
+BaudRate baud;            //the baud rate class to manage the serial port
+CommandParser parser;     //receives commands from the master a byte at a time
+WallClock wallClock;      //the unix time kept from the RTC square wave
+AnalogSampler analogSampler;   //oversampled readings of the light sensor
 
 //RTC_DS1307 RTC;
 
@@ -17,24 +25,31 @@ boolean newCmd;              //new command flag
 char command;                //command received from master
 uint8_t port;                //desired port
 uint32_t targetMeasurment;   //desired number of measurmnets.
+uint32_t count;              //number after the comma, SDI_NO_COUNT if there was none.
 
 void setup(){
-    Serial.begin(9600);                            //baud rate
     Wire.begin();                                  //I2C coms
     memory.memorySetup();                          //init memory
-    ports.portSetup(&memory);                      //init ports
-    experiment.experimentSetup(&ports, &memory);   //init experiment
+    baud.baudSetup();                              //baud rate
+    ports.portSetup(&memory, &wallClock, &analogSampler);   //init ports and start the ADC
+    experiment.experimentSetup(&ports, &memory, &wallClock);   //init experiment and sync the clock
 }
 
 void loop(){
-    //if serial command waiting to be recieved read it.
-    if (Serial.available() > 0){
-        //pars recieved command
-        newCmd = readNewCmd (&command, &port,  &targetMeasurment);
-        //bad command received send abort.
-        if (!newCmd){
-            respond(SDI_ABORT);
-        }
+    //read any bytes waiting, this never waits for a command to finish arriving.
+    uint8_t received = parser.poll();
+    //bad command received send abort.
+    if (received == PARSER_ERROR){
+        respond(SDI_ABORT);
+    }
+    //a good command shows the master is using the current baud rate.
+    else if (received == PARSER_COMMAND){
+        newCmd = true;
+        command = parser.getCommand();
+        port = parser.getPort();
+        targetMeasurment = parser.getNumber();
+        count = parser.getCount();
+        baud.commandReceived();
     }
     if (newCmd){
         //switch to proper command
@@ -47,7 +62,21 @@ void loop(){
                 respond(SDI_ABORT);
             break;
             case 'P':
-                experiment.setPeriod (targetMeasurment);
+                //aPs!; sets a period of s seconds, aPs,ms!; adds ms milliseconds
+                experiment.setPeriod (targetMeasurment, count);
+            break;
+            case 'I':
+                //aIn!; samples port a every n periods of an M experiment, 0In!; sets every port
+                experiment.setDivider (port, targetMeasurment);
+            break;
+            case 'W':
+                //aWn!; saves port a as a summary of every n samples of an M experiment, 0Wn!; sets every port
+                experiment.setWindow (port, targetMeasurment);
+            break;
+            case 'H':
+                //aHb,s!; only saves a sample of port a that changed by more than b native units or
+                //comes s periods after the last one saved, 0Hb,s!; sets every port
+                experiment.setDeadband (port, targetMeasurment, count);
             break;
             case 'R':
                 experiment.startR (port, targetMeasurment);
@@ -55,8 +84,28 @@ void loop(){
             case 'M':
                 experiment.startM (port, targetMeasurment);
             break;
+            case 'L':
+                experiment.subscribe (targetMeasurment);
+            break;
             case 'D':
-                ports.sendSavedData (targetMeasurment);
+                //aDn!; sends the last n periods, aDc,n!; sends n periods from cursor c
+                if (count == SDI_NO_COUNT){
+                    ports.sendSavedData (targetMeasurment);
+                }
+                else{
+                    ports.sendSavedPage (targetMeasurment, min(count, 0xFFFF));
+                }
+            break;
+            case 'Q':
+                //mQs,e!; sends the samples from the ports in mask m taken from time s to time e,
+                //without e every sample from time s on is sent
+                ports.sendQuery (port, targetMeasurment, count);
+            break;
+            case 'F':
+                ports.sendSavedFrames (targetMeasurment);
+            break;
+            case 'S':
+                baud.setBaud (targetMeasurment);
             break;
             default:
               respond(SDI_ABORT);
@@ -64,11 +113,30 @@ void loop(){
     }
     //command processes no new command. wait for next command.
     newCmd = false;
+    //save any samples the experiment inturrupt has marked as due.
+    experiment.serviceSamples();
+    //fall back to the default baud rate if the master did not follow a change.
+    baud.serviceBaud();
+    //check the wall clock against the RTC now and then.
+    wallClock.serviceClock();
+}
+
+//inturrupt service routine
+//called as the timer goes back to 0 at the start of every count, ticks the wall clock, marks the
+//sample as due at the end of an experiment period and loads the length of the count. The sensors
+//are read and saved from the main loop.
+ISR (EXPERIMENT_COUNT_START){
+    experiment.countStarted();
+}
+
+//inturrupt service routine
+//called as each conversion of the light sensor pin finishes, adds it to the oversampled reading.
+ISR (ADC_vect){
+    analogSampler.conversionDone();
 }
 
 //inturrupt service routine
-//called on overflow of IRC1 or when experiment period has finished
-ISR (EXPERIMENT_MEASURMENT){
-    uint32_t time = experiment.updateCurrentPeriod();            //get the current period
-    ports.savePortData(experiment.experimentBlock.port, time);   //read and save port data.
+//called while the EEPROM is ready and there are queued writes, writes the next queued byte.
+ISR (EE_READY_vect){
+    memory.eepromReady();
 }
@@ -9,6 +9,10 @@ https://github.com/crenshaw/sensor_hive/wiki/miniSDI-12
 @since: January 2015
 **/
 #include "miniSDI_12.h"
+#include "ResponseLine.h"
+#include <util/crc16.h>
+
+static void putTime(ResponseLine* line, uint32_t time, uint16_t ms);
 
 /**
 void respond(int)
@@ -19,10 +23,9 @@ void respond(int)
 @return void
 **/
 void respond(int a){
-    Serial.print(F("00"));
-    Serial.print(SDI_DAQ_ID);
-    Serial.print(F(","));
-    Serial.println(a);
+    ResponseLine line;
+    line.putHeader(a);
+    line.send();
 }
 
 /**
@@ -36,17 +39,18 @@ void respond(int, uint32_t)
 @return void
 **/
 void respond(int a, uint32_t n){
-    Serial.print(F("00"));
-    Serial.print(SDI_DAQ_ID);
-    Serial.print(F(","));
-    Serial.print(a);
-    Serial.print(F(","));
-    Serial.println(n);
+    ResponseLine line;
+    line.putHeader(a);
+    line.put(',');
+    line.putNumber(n);
+    line.send();
 }
 
 /**
 void respond(int, uint32_t, uint32_t)
-    Uses UART port and Serial communication to respond to an "M" command request. 
+    Uses UART port and Serial communication to respond to an "M" command request, or to a "P"
+    command request with milliseconds where ttt is the seconds and n the milliseconds of the period,
+    or to an "H" command request where ttt is the deadband and n the silence.
     iii,a,ttt,n<CR><LF>
 @param int a.
     Port address.
@@ -57,130 +61,253 @@ void respond(int, uint32_t, uint32_t)
 @return void
 **/
 void respond(int a, uint32_t ttt, uint32_t n){
-    Serial.print(F("00"));
-    Serial.print(SDI_DAQ_ID);
-    Serial.print(F(","));
-    Serial.print(a);
-    Serial.print(F(","));
-    Serial.print(ttt);
-    Serial.print(F(","));
-    Serial.println(n);
-}
-/**
-void endLine(void)
-    Supporting function for the miniSDI_12 protocol.
-    Uses UART port and Serial communication to send <CR><LF>.
-@param void
-@return void
-**/
-void endLine(void){
-    Serial.println();
+    ResponseLine line;
+    line.putHeader(a);
+    line.put(',');
+    line.putNumber(ttt);
+    line.put(',');
+    line.putNumber(n);
+    line.send();
 }
 
 /**
-void endLine(void)
-    Supporting function for the miniSDI_12 protocol.
-    Uses UART port and Serial communication to send response terminator ":"
-@param void
+void dataReport(int, uint32_t, uint16_t, int32_t, uint8_t, boolean, boolean)
+    Uses UART port and Serial communication to send a fixed point value to the Master. The value is
+    sent with a sign and two decimal places, the same as a double was, see ResponseLine::putFixed.
+    The time is sent in whole seconds unless it has milliseconds, they are sent as three decimal
+    places so a report from a period that is not a whole number of seconds still has its own time.
+    A report sent live, after an L command, starts with SDI_LIVE. It can arrive while the master
+    waits for the answer to another command and must not be taken for it.
+    iii,a,time,value<CR><LF>
+    iii,a,time.mmm,value<CR><LF>
+    *iii,a,time,value<CR><LF>
+@param int a.
+    Port address
+@param unit32_t time
+    Unix time stamp.
+@param uint16_t ms
+    Milliseconds after time, 0 to 999.
+@param int32_t value
+    The data measured from the port, SDI_NO_VALUE if the reading had a fault.
+@param uint8_t fracBits
+    The number of fractional bits in value.
+@param boolean lastVal
+    Optional parameter the if true places the response terminator ":" before the <CR><LF>.
+@param boolean live
+    Optional parameter the if true starts the report with SDI_LIVE.
 @return void
 **/
-void terminate(void){
-    Serial.print(":");
+void dataReport(int a, uint32_t time, uint16_t ms, int32_t value, uint8_t fracBits, boolean lastVal, boolean live){
+    ResponseLine line;
+    if (live){
+        line.put(SDI_LIVE);
+    }
+    line.putHeader(a);
+    line.put(',');
+    putTime(&line, time, ms);
+    line.put(',');
+    line.putFixed(value, fracBits);
+    if (lastVal){
+        line.put(':');
+    }
+    line.send();
 }
 
 /**
-void dataReport(int, uint32_t, double, boolean)
-    Uses UART port and Serial communication to send a data as type double to the Master.
+void summaryReport(int, uint32_t, uint16_t, int32_t, int32_t, int32_t, uint8_t, uint8_t, boolean, boolean)
+    Uses UART port and Serial communication to send a summary of a window of samples to the Master,
+    a data report with the smallest value, the largest value and the number of samples added after
+    the mean. The values are sent the same way as dataReport sends them, the time is the time of
+    the last sample in the window. A summary sent live starts with SDI_LIVE, see dataReport.
+    iii,a,time,mean,min,max,count<CR><LF>
 @param int a.
     Port address
 @param unit32_t time
     Unix time stamp.
-@param double value
-    The data measured from the port.
+@param uint16_t ms
+    Milliseconds after time, 0 to 999.
+@param int32_t mean
+    The mean of the samples in the window.
+@param int32_t low
+    The smallest sample in the window.
+@param int32_t high
+    The largest sample in the window.
+@param uint8_t count
+    The number of samples in the window.
+@param uint8_t fracBits
+    The number of fractional bits in mean, low and high.
 @param boolean lastVal
-    Optional parameter the if true places a semi colon at the end of a report.
+    Optional parameter the if true places the response terminator ":" before the <CR><LF>.
+@param boolean live
+    Optional parameter the if true starts the report with SDI_LIVE.
 @return void
 **/
-void dataReport(int a, uint32_t time, double value, boolean lastVal){
-    Serial.print(F("00"));
-    Serial.print(SDI_DAQ_ID);
-    Serial.print(F(","));
-    Serial.print(a);
-    Serial.print(F(","));
-    Serial.print(time);
-    Serial.print(F(","));
-    if (value >= 0){
-        Serial.print(F("+"));
+void summaryReport(int a, uint32_t time, uint16_t ms, int32_t mean, int32_t low, int32_t high, uint8_t count, uint8_t fracBits, boolean lastVal, boolean live){
+    ResponseLine line;
+    if (live){
+        line.put(SDI_LIVE);
+    }
+    line.putHeader(a);
+    line.put(',');
+    putTime(&line, time, ms);
+    line.put(',');
+    line.putFixed(mean, fracBits);
+    line.put(',');
+    line.putFixed(low, fracBits);
+    line.put(',');
+    line.putFixed(high, fracBits);
+    line.put(',');
+    line.putNumber(count);
+    if (lastVal){
+        line.put(':');
     }
-    Serial.print(value);
-//    if (lastVal){
-//        terminate();
-//        endLine();
-//    }
-//    else{
-//        endLine();
-//    }
+    line.send();
 }
 
 /**
-void dataReport(int, uint32_t, uint32_t, boolean)
-    Uses UART port and Serial communication to send a data as type uint32_t to the Master. 
-@param int a.
-    Port address
+void putTime(ResponseLine*, uint32_t, uint16_t)
+    Adds the time of a data report to a line, in whole seconds unless it has milliseconds.
+@param ResponseLine* line
+    The line being built.
 @param unit32_t time
     Unix time stamp.
-@param uint32_t value
-    The data measured from the port.
-@param boolean lastVal
-    Optional parameter the if true places a semi colon at the end of a report.
+@param uint16_t ms
+    Milliseconds after time, 0 to 999.
+@return void
+**/
+static void putTime(ResponseLine* line, uint32_t time, uint16_t ms){
+    (*line).putNumber(time);
+    if (ms != 0){
+        (*line).put('.');
+        (*line).put('0' + ms / 100);
+        (*line).put('0' + (ms / 10) % 10);
+        (*line).put('0' + ms % 10);
+    }
+}
+
+/**
+void endReport(uint32_t)
+    Uses UART port and Serial communication to end a response made of any number of data reports,
+    the master cannot tell which data report is the last one. Always the last line of the response.
+    iii,0,n:<CR><LF>
+@param uint32_t n
+    The number that ends the response, the cursor of the next page for a D command with a cursor
+    or the number of data reports sent for a Q command.
 @return void
 **/
-void dataReport(int a, uint32_t time, uint32_t value, boolean lastVal){
-    Serial.print(F("00"));
-    Serial.print(SDI_DAQ_ID);
-    Serial.print(F(","));
-    Serial.print(a);
-    Serial.print(F(","));
-    Serial.print(time);
-    Serial.print(F(","));
-    Serial.print(value, BIN);
-//    if (lastVal){
-//        terminate();
-//        endLine();
-//    }
-//    else{
-//        endLine();
-//    }
+void endReport(uint32_t n){
+    ResponseLine line;
+    line.putHeader(0);
+    line.put(',');
+    line.putNumber(n);
+    line.put(':');
+    line.send();
+}
+
+/**
+void sendFrame(uint8_t, const uint8_t*, uint8_t)
+    Sends a binary frame to the Master. A frame is
+      length    1 byte, number of bytes in type and body
+      type      1 byte, one of the SDI_FRAME_ types
+      body      length-1 bytes, multi byte numbers are little endian
+      crc       2 bytes, CRC-16/XMODEM of length, type and body, low byte first
+    COBS encoded so it has no zero bytes, followed by a single zero byte. The Master can always find
+    the start of the next frame by looking for a zero, even after a dropped byte.
+@param uint8_t type
+    The frame type.
+@param const uint8_t* body
+    The body of the frame.
+@param uint8_t length
+    The number of bytes in body, at most SDI_FRAME_MAX_BODY.
+@return void
+**/
+void sendFrame(uint8_t type, const uint8_t* body, uint8_t length){
+    uint8_t frame[SDI_FRAME_MAX_BODY + 4];
+    uint8_t encoded[SDI_FRAME_MAX_BODY + 6];
+    uint8_t frameLength = 0;
+    uint16_t crc = 0;
+    frame[frameLength++] = length + 1;
+    frame[frameLength++] = type;
+    for (uint8_t i = 0; i < length; i++){
+        frame[frameLength++] = body[i];
+    }
+    for (uint8_t i = 0; i < frameLength; i++){
+        crc = _crc_xmodem_update(crc, frame[i]);
+    }
+    frame[frameLength++] = crc & 0xFF;
+    frame[frameLength++] = crc >> 8;
+    //COBS, every zero is replaced by the distance to the next zero. The first byte holds the
+    //distance to the first zero. Frames are shorter than 254 bytes so a distance never overflows.
+    uint8_t codeIndex = 0;
+    uint8_t code = 1;
+    uint8_t encodedLength = 1;
+    for (uint8_t i = 0; i < frameLength; i++){
+        if (frame[i] == 0){
+            encoded[codeIndex] = code;
+            codeIndex = encodedLength++;
+            code = 1;
+        }
+        else{
+            encoded[encodedLength++] = frame[i];
+            code++;
+        }
+    }
+    encoded[codeIndex] = code;
+    encoded[encodedLength++] = 0;
+    Serial.write(encoded, encodedLength);
 }
 
+/**
+uint8_t putLong(uint8_t*, uint32_t)
+    Stores a 32 bit number in a frame body, little endian.
+@param uint8_t* buffer
+    The location to store the number.
+@param uint32_t value
+    The number to store.
+@return uint8_t
+    The number of bytes stored, always 4.
+**/
+uint8_t putLong(uint8_t* buffer, uint32_t value){
+    for (uint8_t i = 0; i < 4; i++){
+        buffer[i] = value >> (8*i);
+    }
+    return 4;
+}
 
 /**
-boolean readNewCmd( char* Command, int* port, int* numMeasurs)
-    Parses commands received from master on a daq device.
+boolean parseCommand(char* buffer, uint8_t numChars, char* command, uint8_t* port, uint32_t* numMeasures, uint32_t* count)
+    Parses a command received from master on a daq device. The command has already been read into
+    buffer by a CommandParser, up to but not including the ";".
     Returns true for following commands.
     <____>!;
       Where command = 'B', port = -1, numMeasures = -1.
     <int1><char><int2>!;
       Where command = char, port = int1, numMeasures = int2.
+    <int1><char><int2>,<int4>!;
+      Where command = char, port = int1, numMeasures = int2, count = int4.
     <int3>!;
       Where command = 0, port = int3, numMeausres = int3.
-    otherwise returns false.
+    otherwise returns false. count is SDI_NO_COUNT unless the command has one.
+@param char* buffer
+    The command, without the ";".
+@param uint8_t numChars
+    The number of characters in buffer.
 @param char* command
     Pointer to the location to store the command
 @param int* port
     Pointer to the location to store port
 @param int* numMeasures
     Pointer to the location to store the number of measurments to be taken
+@param uint32_t* count
+    Pointer to the location to store the number after the comma
 @return boolean
     If the commands recieved was parsed succesfully returns true otherwise the command is invalid
     and function returns false.
 **/
-boolean readNewCmd( char* command, uint8_t* port, uint32_t* numMeasures){
-    char buffer[17];                                                  //max size of command able to receive
-    int numChars = Serial.readBytesUntil(';', buffer, 17);            //read from serial buffer untill ";"
-                                                                      //or 17 characters
-    //check if command ends with '!'.
-    if (buffer[numChars -1] != '!'){
+boolean parseCommand(char* buffer, uint8_t numChars, char* command, uint8_t* port, uint32_t* numMeasures, uint32_t* count){
+    *count = SDI_NO_COUNT;
+    //check if command ends with '!' and has something before it.
+    if (numChars < 2 || buffer[numChars -1] != '!'){
         return false;
     }
     
@@ -189,6 +316,19 @@ boolean readNewCmd( char* command, uint8_t* port, uint32_t* numMeasures){
     char* cmdPtr = inputEnd;
     boolean noCmd = false;
     
+    //Split off the count after a comma, the rest is parsed as if there was no count
+    for (char* comma = inputHead; comma < inputEnd; comma++){
+        if (*comma == ','){
+            *count = parInt(comma+1, inputEnd);
+            if (*count == SDI_NO_COUNT || comma == inputHead){
+                return false;
+            }
+            inputEnd = comma-1;
+            cmdPtr = inputEnd;
+            break;
+        }
+    }
+    
     //Break Command <____>!;
     if (numChars == 5 && buffer[0] == ' ' && buffer[1] == ' '
                       && buffer[2] == ' ' && buffer[3] == ' '){
@@ -232,7 +372,7 @@ boolean readNewCmd( char* command, uint8_t* port, uint32_t* numMeasures){
     
     
     #ifdef DEBUG1
-    Serial.println("In readNewCmd:");
+    Serial.println("In parseCommand:");
     Serial.print("Sensor: ");
     Serial.println(*port);
     Serial.print("Command: ");
@@ -242,10 +382,11 @@ boolean readNewCmd( char* command, uint8_t* port, uint32_t* numMeasures){
     #endif
     
     
-    if (!noCmd && (*port < 0 || *numMeasures < 0)){
-        //command is not formatted correctly return false
+    //only a command can have a count
+    if (noCmd && *count != SDI_NO_COUNT){
         return false;
     }
+    
     return true;
 }
 
@@ -305,7 +446,7 @@ boolean isLetter(char letter)
     Returns true if char is an ascii value for a letter.
 **/
 boolean isLetter(char letter){
-    if ((letter >= 'A' && letter <= 'Z' || letter >='a' && letter <= 'z')){
+    if ((letter >= 'A' && letter <= 'Z') || (letter >='a' && letter <= 'z')){
         return true;
     }
     else{
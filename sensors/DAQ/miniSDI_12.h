@@ -15,15 +15,26 @@ Provides the function prototypes for the miniSDI_12 protocol used to use communi
 #define MINISDI_12_H
 #define SDI_DAQ_ID 2  //ID for the Specific DAQ. Should be changed for each DAQ in a system
 #define SDI_ABORT 0   //The abort code
+#define SDI_COMMAND_LENGTH 26   //The longest command that can be received, not counting the ";"
+#define SDI_COMMAND_TIMEOUT 1000  //Milliseconds a partly received command is kept waiting for the rest
+#define SDI_NO_VALUE ((int32_t)0x80000000)  //A data report value that is sent as nan, used for a reading with a fault
+#define SDI_NO_COUNT ((uint32_t)0xFFFFFFFF)  //The count of a command that was sent without one, see parseCommand
+#define SDI_LIVE '*'  //Starts a data report sent live after an L command, it is not part of the answer to a command
+//Binary frames sent by the F command. See sendFrame.
+#define SDI_FRAME_HEADER 'H'     //experiment start time, period length in milliseconds and fractional bits of each port
+#define SDI_FRAME_DATA 'D'       //period number, port mask and a value for each port in the mask, or a summary
+#define SDI_FRAME_END 'E'        //number of periods sent, marks the end of the dump
+#define SDI_FRAME_MAX_BODY 32    //largest body sendFrame can send
 
 void respond(int a);
 void respond(int a, uint32_t n);
 void respond(int a, uint32_t timeTill, uint32_t value);
-void endLine(void);
-void terminate(void);
-void dataReport(int a, uint32_t time, double value, boolean lastVal = false);
-void dataReport(int a, uint32_t time, uint32_t value, boolean lastVal = false);
-boolean readNewCmd(char* command, uint8_t* sensor, uint32_t* number);
+void dataReport(int a, uint32_t time, uint16_t ms, int32_t value, uint8_t fracBits, boolean lastVal = false, boolean live = false);
+void summaryReport(int a, uint32_t time, uint16_t ms, int32_t mean, int32_t low, int32_t high, uint8_t count, uint8_t fracBits, boolean lastVal = false, boolean live = false);
+void endReport(uint32_t n);
+void sendFrame(uint8_t type, const uint8_t* body, uint8_t length);
+uint8_t putLong(uint8_t* buffer, uint32_t value);
+boolean parseCommand(char* buffer, uint8_t numChars, char* command, uint8_t* port, uint32_t* number, uint32_t* count);
 uint32_t parInt (char* head, char* tail);
 boolean isNumber(char number);
 boolean isLetter(char letter);
@@ -0,0 +1,85 @@
+/**
+baud.cpp
+  Runs the whole sketch in the simulation in sim/ and checks how the master moves the DAQ to a
+  faster baud rate. The DAQ must start at BAUD_DEFAULT. At every supported rate the master asks for
+  the rate with an S command at the old rate, switches once it has the answer and acknowledges at
+  the new rate, then reads the whole log with a D command. The time the dump takes gives the
+  throughput at that rate. A master that does not follow an S command must find the DAQ back at
+  BAUD_DEFAULT after BAUD_TIMEOUT. The rates are simulated, see sim/sim.cpp, a real Uno and its USB
+  serial bridge may not reach them. The simulation charges time for the serial port, the EEPROM,
+  I2C and the inturrupts but not for the sketch's own code, so a dump that keeps the line busy runs
+  at the rate of the line. The cost of formatting each line is modelled in responseline.cpp.
+  Build and run with run.sh.
+**/
+#include <cstdio>
+#include <string>
+#include "sim.h"
+#include "BaudRate.h"
+
+#define BAUD_WAIT_US 30000000         //an answer that takes longer than this is missing
+
+static const uint32_t rates[BAUD_RATES] = {9600, 19200, 38400, 57600, 115200, 250000};
+static uint32_t failures = 0;
+
+/**
+static uint64_t answer (const char* text, const char* expected, uint64_t* bytes)
+  Sends text and runs the DAQ until the line expected, or a line ending with ":" if expected is
+  NULL, has been received. Returns the time in microseconds from the last byte of text arriving to
+  the last byte of the line, 0 if it never came. The bytes of every line received are added to
+  bytes unless it is NULL.
+**/
+static uint64_t answer (const char* text, const char* expected, uint64_t* bytes){
+    size_t seen = simLines().size();
+    uint64_t arrived = simSend(text, simNow());
+    while (simNow() < arrived + BAUD_WAIT_US){
+        simRun(simNow() + 100);
+        for (; seen < simLines().size(); seen++){
+            const std::string& line = simLines()[seen].text;
+            if (bytes != NULL){
+                *bytes += line.size();
+            }
+            if (expected != NULL ? line == expected : line[line.size() - 3] == ':'){
+                return simLines()[seen].at - arrived;
+            }
+        }
+    }
+    printf("%s got no %s", text, expected != NULL ? expected : "end of response\n");
+    failures++;
+    return 0;
+}
+
+int main (void){
+    char command[32];
+    char expected[32];
+    simStart();
+    //the master opens the port at BAUD_DEFAULT
+    simHostBaud(BAUD_DEFAULT);
+    answer("1!;", "002,1\r\n", NULL);
+    answer("0P0,100!;", "002,0,0,100\r\n", NULL);
+    simSend("0M100!;", simNow());
+    simRun(simNow() + 12000000);
+    for (uint8_t rate = 0; rate < BAUD_RATES; rate++){
+        snprintf(command, sizeof(command), "0S%u!;", rates[rate]);
+        snprintf(expected, sizeof(expected), "002,0,%u\r\n", rates[rate]);
+        answer(command, expected, NULL);
+        simHostBaud(rates[rate]);
+        answer("1!;", "002,1\r\n", NULL);
+        uint64_t bytes = 0;
+        uint64_t us = answer("0D0!;", NULL, &bytes);
+        if (us == 0){
+            continue;
+        }
+        double perSecond = bytes * 1000000.0 / us;
+        printf("%6u baud  %6llu bytes in %8.1f ms  %7.0f bytes/s  %3.0f%% of the line\n", rates[rate],
+               (unsigned long long)bytes, us / 1000.0, perSecond, perSecond * 1000 / rates[rate]);
+    }
+    //a master that does not follow is answered at BAUD_DEFAULT once the trial is over
+    snprintf(command, sizeof(command), "0S%u!;", BAUD_DEFAULT);
+    answer(command, "002,0,9600\r\n", NULL);
+    simHostBaud(BAUD_DEFAULT);
+    answer("0S115200!;", "002,0,115200\r\n", NULL);
+    simRun(simNow() + BAUD_TIMEOUT * 1000ULL + 100000);
+    answer("1!;", "002,1\r\n", NULL);
+    printf("simulated rates, %u failures\n", failures);
+    return failures != 0;
+}
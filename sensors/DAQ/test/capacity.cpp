@@ -0,0 +1,134 @@
+/**
+capacity.cpp
+  Works out how many samples the log holds. Synthetic traces in native sensor units, the quarter
+  degrees of the thermocouples and the counts of the light sensor, are saved a period at a time
+  with Memory::saveDataBlock until the log has wrapped many times. After every period the log is
+  read back, the samples in it counted and checked against the trace. The samples kept per KB of
+  log are compared with the DataBlock the log replaced, a 9 byte record of period, port and value
+  for every sample, CAPACITY_OLD_RECORD bytes. Build and run with run.sh.
+**/
+#include <cstdio>
+#include "Arduino.h"
+#include "Memory.h"
+
+#define CAPACITY_PERIODS 3000
+#define CAPACITY_OLD_RECORD 9             //4 byte period, 1 byte port, 4 byte value
+#define CAPACITY_MIN_MULTIPLE 4           //a slow trace must fit this many times as many samples
+
+static Memory memory;
+static int16_t trace[CAPACITY_PERIODS + 1][MEMORY_MAX_PORTS];
+static uint32_t seed = 1;
+
+static void eepromReady (void){
+    memory.eepromReady();
+}
+
+//a pseudo random number from -range to range, the same every run
+static int16_t noise (int16_t range){
+    seed = seed * 1103515245UL + 12345;
+    return (int16_t)((seed >> 8) % (2 * range + 1)) - range;
+}
+
+//five thermocouples in a room and the light sensor by a window, each changes a little a period
+static void roomTrace (uint32_t period, int16_t* values){
+    for (uint8_t port = 0; port < MEMORY_MAX_PORTS - 1; port++){
+        values[port] = 88 + port + (period / 60) % 4 + noise(1);
+    }
+    values[MEMORY_MAX_PORTS - 1] = 600 + (period / 30) % 50 + noise(2);
+}
+
+//the thermocouples in a kiln heating up a quarter degree a period, the light sensor under clouds
+static void kilnTrace (uint32_t period, int16_t* values){
+    for (uint8_t port = 0; port < MEMORY_MAX_PORTS - 1; port++){
+        values[port] = 80 + period + 4 * port + noise(2);
+    }
+    int16_t light = (period == 0) ? 500 : trace[period - 1][MEMORY_MAX_PORTS - 1];
+    values[MEMORY_MAX_PORTS - 1] = min(max(light + noise(20), 0), 1023);
+}
+
+//every port jumps around the whole range, nothing is gained from the deltas
+static void noiseTrace (uint32_t, int16_t* values){
+    for (uint8_t port = 0; port < MEMORY_MAX_PORTS; port++){
+        values[port] = noise(8000);
+    }
+}
+
+/**
+static uint32_t runTrace (const char* name, void (*makeTrace) (uint32_t, int16_t*), uint8_t minimum)
+  Saves CAPACITY_PERIODS periods of the trace and reports the samples the log holds, it must be at
+  least minimum times as many as the old DataBlock kept. Returns the number of failures.
+**/
+static uint32_t runTrace (const char* name, void (*makeTrace) (uint32_t, int16_t*), uint8_t minimum){
+    memset(hostEeprom, 0xFF, sizeof(hostEeprom));
+    memory = Memory();
+    memory.memorySetup();
+    ExperimentBlock experimentBlock;
+    memory.loadExperimentBlock(&experimentBlock);
+    experimentBlock.logEpoch = memory.reset();
+    memory.updateExperimentBlock(experimentBlock);
+    uint32_t failures = 0;
+    uint32_t least = 0xFFFFFFFF;
+    uint32_t most = 0;
+    uint64_t total = 0;
+    uint32_t counted = 0;
+    for (uint32_t period = 1; period <= CAPACITY_PERIODS; period++){
+        DataBlock dataBlock;
+        makeTrace(period, trace[period]);
+        dataBlock.periodNumber = period;
+        dataBlock.portMask = MEMORY_PORT_MASK;
+        dataBlock.count = 0;
+        memcpy(dataBlock.data, trace[period], sizeof(dataBlock.data));
+        memory.saveDataBlock(dataBlock);
+        memory.flush();
+        //count the samples kept, once the log has filled and started to overwrite itself
+        LogCursor cursor;
+        uint32_t samples = 0;
+        uint32_t oldest = 0;
+        memory.firstBlock(&cursor);
+        while (memory.loadDataBlock(&cursor, &dataBlock)){
+            oldest = (samples == 0) ? dataBlock.periodNumber : oldest;
+            for (uint8_t port = 0; port < MEMORY_MAX_PORTS; port++){
+                if ((dataBlock.portMask & (1 << port)) && dataBlock.data[port] != trace[dataBlock.periodNumber][port]){
+                    if (failures++ == 0){
+                        printf("%s: period %u port %u read back as %d, saved as %d\n", name, dataBlock.periodNumber,
+                               port + 1, dataBlock.data[port], trace[dataBlock.periodNumber][port]);
+                    }
+                }
+                samples += (dataBlock.portMask >> port) & 1;
+            }
+        }
+        if (oldest > 1){
+            least = (samples < least) ? samples : least;
+            most = (samples > most) ? samples : most;
+            total += samples;
+            counted++;
+        }
+    }
+    //the log is every whole page after the header blocks
+    uint32_t logBytes = (MEMORY_SIZE - sizeof(ExperimentBlock) - sizeof(SettingsBlock)) / MEMORY_PAGE_SIZE * MEMORY_PAGE_SIZE;
+    if (counted == 0){
+        printf("%s: the log never filled\n", name);
+        return failures + 1;
+    }
+    double mean = (double)total / counted;
+    double perKb = mean * 1024 / logBytes;
+    double multiple = perKb * CAPACITY_OLD_RECORD / 1024;
+    printf("%-36s samples kept %4u to %4u, %6.1f per KB, %4.2f times the 9 byte DataBlock\n",
+           name, least, most, perKb, multiple);
+    if (multiple < minimum){
+        printf("%s: less than %u times the samples\n", name, minimum);
+        failures++;
+    }
+    return failures;
+}
+
+int main (void){
+    hostEepromReady = eepromReady;
+    uint32_t failures = 0;
+    printf("the 9 byte DataBlock kept %.1f samples per KB\n", 1024.0 / CAPACITY_OLD_RECORD);
+    failures += runTrace("room, 6 ports", roomTrace, CAPACITY_MIN_MULTIPLE);
+    failures += runTrace("kiln heating, 6 ports", kilnTrace, CAPACITY_MIN_MULTIPLE);
+    failures += runTrace("noise over the whole range, 6 ports", noiseTrace, 0);
+    printf("%u failures\n", failures);
+    return failures != 0;
+}
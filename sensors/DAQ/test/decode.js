@@ -0,0 +1,181 @@
+/**
+ * decode.js
+ *
+ * Checks the app's frame decoder, box/public/js/frames.js, against
+ * the dumps dump.cpp writes to the directory given as the first
+ * argument.  The frames of the aF0!; dump are decoded and every
+ * value, summary and time must match the reports of the aD0!; dump
+ * to the hundredth the reports are rounded to.  The end frame must
+ * count every period.  The same bytes pushed in pieces of any size
+ * must give the same records, and a frame with one byte changed must
+ * be the only one lost.  Then the dump is decoded DECODE_ROUNDS times
+ * and the rate is reported, measured under node on this PC, not in
+ * Chrome.  Run with run.sh, it is skipped if node is not installed.
+ */
+
+var fs = require('fs');
+var path = require('path');
+var vm = require('vm');
+
+var DECODE_ROUNDS = 2000;  // times the dump is decoded, for a steady rate
+var DECODE_PIECE = 64;     // most bytes in one receive event
+
+vm.runInThisContext(fs.readFileSync(path.join(__dirname, '../../../box/public/js/frames.js'), 'utf8'));
+
+var failures = 0;
+var seed = 1;
+
+/**
+ * randomTo()
+ *
+ * A pseudo random number from 0 to range-1, the same every run.
+ */
+function randomTo(range) {
+    seed = (Math.imul(seed, 1103515245) + 12345) >>> 0;
+    return (seed >>> 8) % range;
+}
+
+/**
+ * decode()
+ *
+ * Pushes bytes through a new decoder, piece bytes at a time or in
+ * random pieces of up to DECODE_PIECE bytes if piece is 0.
+ *
+ * @returns The records and the number of frames thrown away.
+ */
+function decode(bytes, piece) {
+
+    var decoder = new bt.frames.decoder();
+    var records = [];
+
+    for (var i = 0; i < bytes.length; ) {
+	var length = (piece !== 0) ? piece : 1 + randomTo(DECODE_PIECE);
+	var buf = bytes.buffer.slice(bytes.byteOffset + i, bytes.byteOffset + Math.min(i + length, bytes.length));
+	records = records.concat(decoder.push(buf));
+	i += length;
+    }
+
+    return {records: records, errors: decoder.errors};
+}
+
+/**
+ * reports()
+ *
+ * Turns the records of a frame dump into one report for every port
+ * of every data record, in the order the text dump sends them.
+ */
+function reports(records) {
+
+    var out = [];
+
+    for (var i = 0; i < records.length; i++) {
+	var record = records[i];
+	if (record.type !== 'D') {
+	    continue;
+	}
+	for (var a in record.values) {
+	    var report = [Number(a), record.time, record.values[a]];
+	    if (record.count !== undefined) {
+		report.push(record.min, record.max, record.count);
+	    }
+	    out.push(report);
+	}
+    }
+
+    return out;
+}
+
+/**
+ * same()
+ *
+ * True if a report decoded from the frames matches a line of the
+ * text dump, iii,a,time,value with the min, max and count of a
+ * summary.
+ */
+function same(report, line) {
+
+    var fields = line.split(',');
+
+    if (fields.length !== report.length + 1 || Number(fields[1]) !== report[0] ||
+	Math.abs(Number(fields[2]) - report[1]) > 0.0005) {
+	return false;
+    }
+    for (var i = 3; i < fields.length; i++) {
+	var tolerance = (i === 6) ? 0 : 0.005 + 1e-9;
+	if (Math.abs(Number(fields[i]) - report[i - 1]) > tolerance) {
+	    return false;
+	}
+    }
+
+    return true;
+}
+
+var dir = process.argv[2];
+var bytes = new Uint8Array(fs.readFileSync(path.join(dir, 'dump.bin')));
+var lines = fs.readFileSync(path.join(dir, 'dump.txt'), 'latin1').split('\r\n').filter(function(line) {
+    return line !== '';
+}).map(function(line) {
+    return line.replace(/:$/, '');
+});
+
+// the frames hold the reports of the text dump
+var whole = decode(bytes, bytes.length);
+var decoded = reports(whole.records);
+var differ = 0;
+for (var i = 0; i < Math.max(decoded.length, lines.length); i++) {
+    if (i >= decoded.length || i >= lines.length || !same(decoded[i], lines[i])) {
+	if (differ++ === 0) {
+	    console.log('report ' + i + ' decoded as ' + JSON.stringify(decoded[i]) + ', sent as ' + lines[i]);
+	}
+    }
+}
+var periods = {};
+lines.forEach(function(line) {
+    periods[line.split(',')[2]] = true;
+});
+var end = whole.records[whole.records.length - 1];
+var counted = (end !== undefined && end.type === 'E') ? end.count : -1;
+console.log(decoded.length + ' reports decoded, ' + differ + ' of ' + lines.length + ' differ from aD0!;, ' +
+	    'the end frame counts ' + counted + ' of ' + Object.keys(periods).length + ' periods');
+if (differ !== 0 || whole.errors !== 0 || whole.records[0].type !== 'H' ||
+    counted !== Object.keys(periods).length) {
+    failures++;
+}
+
+// a frame split across receive events is put back together
+var pieces = decode(bytes, 0);
+if (JSON.stringify(pieces.records) !== JSON.stringify(whole.records) || pieces.errors !== 0) {
+    console.log('the dump pushed in pieces decodes differently');
+    failures++;
+}
+
+// a changed byte loses its own frame and no other
+var frames = whole.records.length + whole.errors;
+var changed = 0;
+for (var at = 0; at < bytes.length; at += 1 + randomTo(40)) {
+    if (bytes[at] === 0) {
+	continue;
+    }
+    var corrupt = new Uint8Array(bytes);
+    corrupt[at] ^= (corrupt[at] === 1) ? 2 : 1;
+    var result = decode(corrupt, bytes.length);
+    if (result.errors !== 1 || result.records.length !== frames - 1) {
+	if (changed++ === 0) {
+	    console.log('byte ' + at + ' changed: ' + result.errors + ' frames thrown away, ' +
+			(frames - result.records.length) + ' lost');
+	}
+    }
+}
+failures += (changed !== 0);
+
+// the rate of the decoder
+var start = process.hrtime.bigint();
+for (var round = 0; round < DECODE_ROUNDS; round++) {
+    decode(bytes, DECODE_PIECE);
+}
+var seconds = Number(process.hrtime.bigint() - start) / 1e9;
+console.log(bytes.length + ' bytes, ' + (bytes.length / Object.keys(periods).length).toFixed(1) +
+	    ' bytes a period, decoded at ' + (bytes.length * DECODE_ROUNDS / seconds / 1e6).toFixed(2) + ' MB/s, ' +
+	    (Object.keys(periods).length * DECODE_ROUNDS / seconds).toFixed(0) + ' periods/s under node on this PC');
+console.log(failures + ' failures');
+process.exit(failures !== 0 ? 1 : 0);
@@ -0,0 +1,143 @@
+/**
+dump.cpp
+  Runs the whole sketch in the simulation in sim/ and compares reading the whole log as text with
+  aD0!; and as binary frames with aF0!;. The experiment runs until the log has wrapped, so every
+  dump is a full EEPROM dump. Both dumps are read at BAUD_DEFAULT and again at DUMP_FAST_BAUD, the
+  bytes on the wire and the time from the command to the last byte are reported for each. The
+  frames are not decoded here, the reports of the text dump and the bytes of the frame dump at
+  BAUD_DEFAULT are written to the directory given as the first argument, dump.txt and dump.bin,
+  and decode.js checks them with the app's decoder. The times are simulated, see sim/sim.cpp, the
+  simulation does not charge for the sketch's own code. Build and run with run.sh.
+**/
+#include <cstdio>
+#include <string>
+#include "sim.h"
+#include "BaudRate.h"
+
+#define DUMP_PERIOD_MS 100
+#define DUMP_PERIODS 1500                //enough to wrap the log
+#define DUMP_FAST_BAUD 115200
+#define DUMP_WAIT_US 60000000            //a response that takes longer than this is missing
+#define DUMP_IDLE_US 1000000             //a frame dump has ended once nothing came for this long
+
+static uint32_t failures = 0;
+
+/**
+static uint64_t textDump (std::string* text)
+  Sends aD0!; and runs the DAQ until the line that ends the response, with a ":", has been
+  received. Every line is added to text. Returns the time in microseconds from the last byte of
+  the command arriving to the last byte of the response, 0 if it never came.
+**/
+static uint64_t textDump (std::string* text){
+    size_t seen = simLines().size();
+    uint64_t arrived = simSend("0D0!;", simNow());
+    while (simNow() < arrived + DUMP_WAIT_US){
+        simRun(simNow() + 100);
+        for (; seen < simLines().size(); seen++){
+            const std::string& line = simLines()[seen].text;
+            *text += line;
+            if (line[line.size() - 3] == ':'){
+                return simLines()[seen].at - arrived;
+            }
+        }
+    }
+    printf("0D0!; got no end of response\n");
+    failures++;
+    return 0;
+}
+
+/**
+static uint64_t frameDump (std::string* bytes)
+  Sends aF0!; and runs the DAQ until nothing has been received for DUMP_IDLE_US. Every byte
+  received is added to bytes. Returns the time in microseconds from the last byte of the command
+  arriving to the last byte received, 0 if nothing came.
+**/
+static uint64_t frameDump (std::string* bytes){
+    size_t seen = simReceived().size();
+    uint64_t arrived = simSend("0F0!;", simNow());
+    uint64_t last = 0;
+    while (simNow() < arrived + DUMP_WAIT_US && (last == 0 || simNow() < last + DUMP_IDLE_US)){
+        simRun(simNow() + 100);
+        if (simReceived().size() > seen){
+            *bytes += simReceived().substr(seen);
+            seen = simReceived().size();
+            last = simNow();
+        }
+    }
+    if (last == 0){
+        printf("0F0!; got no frames\n");
+        failures++;
+        return 0;
+    }
+    return last - arrived;
+}
+
+/**
+static void dumpAt (uint32_t baud, std::string* text, std::string* bytes)
+  Reads the whole log both ways at baud and reports the bytes and times of each.
+**/
+static void dumpAt (uint32_t baud, std::string* text, std::string* bytes){
+    uint64_t textUs = textDump(text);
+    uint64_t frameUs = frameDump(bytes);
+    printf("%6u baud  aD0!; %6u bytes in %7.1f ms  aF0!; %6u bytes in %7.1f ms  %4.2f times fewer bytes\n",
+           baud, (unsigned)text->size(), textUs / 1000.0, (unsigned)bytes->size(), frameUs / 1000.0,
+           (double)text->size() / bytes->size());
+    if (bytes->size() >= text->size()){
+        printf("the frames are no smaller than the text\n");
+        failures++;
+    }
+}
+
+/**
+static void writeFile (const char* directory, const char* name, const std::string& contents)
+  Writes contents to the file name in directory.
+**/
+static void writeFile (const char* directory, const char* name, const std::string& contents){
+    std::string path = std::string(directory) + "/" + name;
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == NULL || fwrite(contents.data(), 1, contents.size(), file) != contents.size()){
+        printf("can not write %s\n", path.c_str());
+        failures++;
+    }
+    if (file != NULL){
+        fclose(file);
+    }
+}
+
+int main (int argc, char** argv){
+    char command[32];
+    simStart();
+    //port 1 summarised every 3 samples, port 6 every 4, port 3 sampled every other period
+    snprintf(command, sizeof(command), "0P0,%u!;", DUMP_PERIOD_MS);
+    const char* settings[] = {command, "1W3!;", "6W4!;", "3I2!;"};
+    for (uint8_t setting = 0; setting < sizeof(settings) / sizeof(settings[0]); setting++){
+        simSend(settings[setting], simNow());
+        simRun(simNow() + 100000);
+    }
+    snprintf(command, sizeof(command), "0M%u!;", DUMP_PERIODS);
+    simSend(command, simNow());
+    simRun(simNow() + (uint64_t)DUMP_PERIOD_MS * 1000 * DUMP_PERIODS + 2000000);
+    std::string text;
+    std::string bytes;
+    dumpAt(BAUD_DEFAULT, &text, &bytes);
+    if (argc > 1){
+        writeFile(argv[1], "dump.txt", text);
+        writeFile(argv[1], "dump.bin", bytes);
+    }
+    //the same dumps at a faster rate, see baud.cpp
+    std::string fastText;
+    std::string fastBytes;
+    snprintf(command, sizeof(command), "0S%u!;", DUMP_FAST_BAUD);
+    simSend(command, simNow());
+    simRun(simNow() + 100000);
+    simHostBaud(DUMP_FAST_BAUD);
+    simSend("1!;", simNow());
+    simRun(simNow() + 100000);
+    dumpAt(DUMP_FAST_BAUD, &fastText, &fastBytes);
+    if (fastText != text || fastBytes != bytes){
+        printf("the dumps at %u baud differ from the dumps at %u baud\n", DUMP_FAST_BAUD, BAUD_DEFAULT);
+        failures++;
+    }
+    printf("simulated times, %u failures\n", failures);
+    return failures != 0;
+}
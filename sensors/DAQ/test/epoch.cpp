@@ -0,0 +1,78 @@
+/**
+epoch.cpp
+  Checks that pages left from an old experiment are never taken for part of the log after the DAQ
+  is reset. Runs 600 short experiments, more than enough to wrap a byte wide epoch or sequence
+  number, and after each one rebuilds the log from EEPROM the way memorySetup does on startup. The
+  rebuilt log must hold exactly the frames of the last experiment. Every other experiment the DAQ
+  is also reset between the log reset and the first frame, the log must still start where the last
+  experiment stopped. Build and run with run.sh.
+**/
+#include <cstdio>
+#include "Arduino.h"
+#include "Memory.h"
+
+#define EPOCH_EXPERIMENTS 600
+
+static Memory memory;
+
+static void eepromReady (void){
+    memory.eepromReady();
+}
+
+int main (void){
+    hostEepromReady = eepromReady;
+    memset(hostEeprom, 0xFF, sizeof(hostEeprom));
+    memory.memorySetup();
+    uint32_t seed = 1;
+    uint32_t failures = 0;
+    for (uint32_t experiment = 0; experiment < EPOCH_EXPERIMENTS; experiment++){
+        ExperimentBlock experimentBlock;
+        memory.loadExperimentBlock(&experimentBlock);
+        experimentBlock.logEpoch = memory.reset();
+        memory.updateExperimentBlock(experimentBlock);
+        if (experiment % 2){
+            uint16_t tail = memory.memoryBlock.tailPtr;
+            memory.flush();
+            memory = Memory();
+            memory.memorySetup();
+            if (memory.memoryBlock.tailPtr != tail){
+                printf("experiment %u: log moved from page %u to %u by a reset before the first frame\n",
+                       experiment, tail, memory.memoryBlock.tailPtr);
+                failures++;
+            }
+        }
+        //1 to 60 periods of 2 ports, a few pages at most
+        seed = seed * 1103515245UL + 12345;
+        uint32_t periods = 1 + (seed >> 16) % 60;
+        for (uint32_t period = 1; period <= periods; period++){
+            DataBlock dataBlock;
+            dataBlock.periodNumber = period;
+            dataBlock.portMask = 0x03;
+            dataBlock.count = 0;
+            dataBlock.data[0] = experiment;
+            dataBlock.data[1] = period;
+            memory.saveDataBlock(dataBlock);
+        }
+        memory.flush();
+        //reset the DAQ
+        memory = Memory();
+        memory.memorySetup();
+        LogCursor cursor;
+        DataBlock dataBlock;
+        uint32_t found = 0;
+        memory.firstBlock(&cursor);
+        while (memory.loadDataBlock(&cursor, &dataBlock)){
+            found++;
+            if (dataBlock.data[0] != (int16_t)experiment || dataBlock.periodNumber != found
+                || dataBlock.data[1] != (int16_t)found){
+                break;
+            }
+        }
+        if (found != periods){
+            printf("experiment %u: %u periods saved, %u read back after a reset\n", experiment, periods, found);
+            failures++;
+        }
+    }
+    printf("%u experiments, %u read back wrong after a reset\n", EPOCH_EXPERIMENTS, failures);
+    return failures != 0;
+}
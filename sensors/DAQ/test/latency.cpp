@@ -0,0 +1,122 @@
+/**
+latency.cpp
+  Runs the whole sketch in the simulation in sim/ and checks how long the DAQ keeps the master
+  waiting while an experiment is running. An M experiment samples every port every
+  LATENCY_PERIOD_MS, then an R experiment reports LATENCY_R_PERIODS samples of one port at the same
+  period. From the moment each is started the master sends an acknowledge command at a random point
+  of every period, over and over. The time from the last byte of the command arriving to the last byte of the
+  answer leaving must stay under LATENCY_MAX_US, no inturrupt may run longer than
+  LATENCY_MAX_ISR_US and the main loop may not turn inturrupts off for longer than
+  LATENCY_MAX_OFF_US. The times are simulated, see sim/sim.cpp. Build and run with run.sh.
+**/
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "sim.h"
+
+#define LATENCY_PERIOD_MS 100         //EXPERIMENT_MIN_PERIOD
+#define LATENCY_R_PERIODS 1000
+#define LATENCY_WAIT_US 2000000       //an answer that takes longer than this is missing
+#define LATENCY_MAX_US 50000          //an answer can wait behind a report already being sent
+#define LATENCY_MAX_ISR_US 50
+#define LATENCY_MAX_OFF_US 100
+
+static uint32_t failures = 0;
+static uint32_t seed = 1;
+
+//a pseudo random number from 0 to range-1, the same every run
+static uint32_t randomUs (uint32_t range){
+    seed = seed * 1103515245UL + 12345;
+    return (seed >> 8) % range;
+}
+
+/**
+static uint64_t command (const char* text, const char* answer)
+  Sends text and runs the DAQ until the line answer has been received. Returns the time in
+  microseconds from the last byte of text arriving to the last byte of answer, 0 if it never came.
+**/
+static uint64_t command (const char* text, const char* answer){
+    size_t seen = simLines().size();
+    uint64_t arrived = simSend(text, simNow());
+    while (simNow() < arrived + LATENCY_WAIT_US){
+        simRun(simNow() + 100);
+        for (; seen < simLines().size(); seen++){
+            if (simLines()[seen].text == answer){
+                return simLines()[seen].at - arrived;
+            }
+        }
+    }
+    printf("%s got no %s", text, answer);
+    failures++;
+    return 0;
+}
+
+/**
+static void experiment (const char* name, const char* start, uint32_t periods)
+  Sends start and then an acknowledge command at a random point of every period until periods
+  periods have passed, and checks the answers and the inturrupts against the limits.
+**/
+static void experiment (const char* name, const char* start, uint32_t periods){
+    simClearStats();
+    simSend(start, simNow());
+    uint64_t end = simNow() + (uint64_t)LATENCY_PERIOD_MS * 1000 * periods;
+    uint64_t worst = 0;
+    uint64_t total = 0;
+    uint32_t commands = 0;
+    while (simNow() + LATENCY_PERIOD_MS * 1000 < end){
+        //the first right behind start, while the experiment is starting
+        if (commands > 0){
+            simRun(simNow() + randomUs(LATENCY_PERIOD_MS * 1000));
+        }
+        uint64_t latency = command("1!;", "002,1\r\n");
+        worst = (latency > worst) ? latency : worst;
+        total += latency;
+        commands++;
+    }
+    simRun(end + LATENCY_WAIT_US);
+    printf("%s, %u periods of %u ms, %u commands\n", name, periods, LATENCY_PERIOD_MS, commands);
+    printf("  command to answer  worst %6llu us  mean %6llu us\n", (unsigned long long)worst,
+           (unsigned long long)(total / commands));
+    printf("  longest inturrupt  timer %llu us  ADC %llu us  EEPROM %llu us, inturrupts off %llu us\n",
+           (unsigned long long)simStats.worstIsrNs[SIM_TIMER1_COMPA] / 1000,
+           (unsigned long long)simStats.worstIsrNs[SIM_ADC] / 1000,
+           (unsigned long long)simStats.worstIsrNs[SIM_EEPROM_READY] / 1000,
+           (unsigned long long)simStats.worstOffNs / 1000);
+    if (worst > LATENCY_MAX_US){
+        printf("an answer took longer than %u us\n", LATENCY_MAX_US);
+        failures++;
+    }
+    for (uint8_t vector = 0; vector < SIM_VECTORS; vector++){
+        if (simStats.worstIsrNs[vector] > LATENCY_MAX_ISR_US * 1000ULL){
+            printf("inturrupt %u ran longer than %u us\n", vector, LATENCY_MAX_ISR_US);
+            failures++;
+        }
+    }
+    if (simStats.worstOffNs > LATENCY_MAX_OFF_US * 1000ULL){
+        printf("inturrupts were off for longer than %u us\n", LATENCY_MAX_OFF_US);
+        failures++;
+    }
+    if (simStats.rxOverruns != 0 || simStats.i2cWithInterruptsOff != 0){
+        printf("%u bytes lost, %u I2C transactions with inturrupts off\n", simStats.rxOverruns, simStats.i2cWithInterruptsOff);
+        failures++;
+    }
+}
+
+int main (void){
+    simStart();
+    command("0P0,100!;", "002,0,0,100\r\n");
+    experiment("M experiment of every port", "0M300!;", 300);
+    //the R experiment reports port 1 only, six ports every 100 ms is more than 9600 baud can carry
+    size_t before = simLines().size();
+    experiment("R experiment of port 1", "1R1000!;", LATENCY_R_PERIODS + 10);
+    uint32_t reports = 0;
+    for (size_t line = before; line < simLines().size(); line++){
+        reports += (simLines()[line].text.compare(0, 6, "002,1,") == 0);
+    }
+    if (reports != LATENCY_R_PERIODS){
+        printf("the R experiment sent %u reports, not %u\n", reports, LATENCY_R_PERIODS);
+        failures++;
+    }
+    printf("%u failures\n", failures);
+    return failures != 0;
+}
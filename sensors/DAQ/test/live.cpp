@@ -0,0 +1,79 @@
+/**
+live.cpp
+  Runs the whole sketch in the simulation in sim/ and checks the data reports an M experiment sends
+  live after an L command. The master subscribes to LIVE_CREDIT periods and then keeps sending
+  acknowledge commands, so live reports and answers share the line. Every live report must start
+  with SDI_LIVE so the master can tell it from an answer, no other data report may be sent, one
+  period of live reports must be sent for every period of credit and every acknowledge must be
+  answered. Build and run with run.sh.
+**/
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <set>
+#include "sim.h"
+#include "miniSDI_12.h"
+
+#define LIVE_PERIOD_MS 500            //six ports of live reports take about 150 ms at 9600 baud
+#define LIVE_PERIODS 60
+#define LIVE_CREDIT 40
+
+static uint32_t failures = 0;
+static uint32_t seed = 1;
+
+//a pseudo random number from 0 to range-1, the same every run
+static uint32_t randomUs (uint32_t range){
+    seed = seed * 1103515245UL + 12345;
+    return (seed >> 8) % range;
+}
+
+int main (void){
+    char command[32];
+    simStart();
+    snprintf(command, sizeof(command), "0P0,%u!;", LIVE_PERIOD_MS);
+    simSend(command, simNow());
+    simRun(simNow() + 100000);
+    size_t start = simLines().size();
+    snprintf(command, sizeof(command), "0M%u!;", LIVE_PERIODS);
+    simSend(command, simNow());
+    simRun(simNow() + 100000);
+    snprintf(command, sizeof(command), "0L%u!;", LIVE_CREDIT);
+    simSend(command, simNow());
+    uint64_t end = simNow() + (uint64_t)LIVE_PERIOD_MS * 1000 * LIVE_PERIODS;
+    uint32_t acknowledges = 0;
+    while (simNow() < end){
+        simRun(simNow() + randomUs(LIVE_PERIOD_MS * 1000));
+        simSend("1!;", simNow());
+        acknowledges++;
+    }
+    simRun(end + 2000000);
+    uint32_t answers = 0;
+    uint32_t live = 0;
+    uint32_t unmarked = 0;
+    std::set<std::string> periods;
+    for (size_t line = start; line < simLines().size(); line++){
+        const std::string& text = simLines()[line].text;
+        if (text[0] == SDI_LIVE){
+            live++;
+            size_t time = text.find(',', text.find(',') + 1) + 1;
+            periods.insert(text.substr(time, text.find(',', time) - time));
+        }
+        else if (text == "002,1\r\n"){
+            answers++;
+        }
+        else if (text.compare(0, 4, "002,") == 0 && strtoul(text.c_str() + text.find(',', 4) + 1, NULL, 10) >= SIM_EPOCH){
+            //a data report with a unix time
+            if (unmarked++ == 0){
+                printf("unmarked data report %s", text.c_str());
+            }
+        }
+    }
+    printf("%u live reports in %u periods, %u of %u acknowledges answered, %u unmarked data reports\n",
+           live, (unsigned)periods.size(), answers, acknowledges, unmarked);
+    if (periods.size() != LIVE_CREDIT || answers != acknowledges || unmarked != 0){
+        printf("expected %u periods of live reports and every acknowledge answered\n", LIVE_CREDIT);
+        failures++;
+    }
+    printf("%u failures\n", failures);
+    return failures != 0;
+}
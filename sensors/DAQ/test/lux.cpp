@@ -0,0 +1,44 @@
+/**
+lux.cpp
+  Checks the fixed point lux conversion of the light sensor against pow. Every analog reading, and
+  every oversampled reading between them, must be within LUX_TOLERANCE of 10 to the power of its
+  share of GA1A12S202_LOG_RANGE decades, and luxToRawFixed must turn the lux back into the same
+  reading. The table is worked out in float, which is also what double is for avr-gcc, so this
+  checks the same table the sketch gets. Build and run with run.sh.
+**/
+#include <cstdio>
+#include <cmath>
+#include "Arduino.h"
+#include "Adafruit_GA1A12S202.h"
+
+#define LUX_TOLERANCE 0.001          //0.1%
+
+int main (void){
+    uint32_t failures = 0;
+    double worstStep = 0;
+    double worstBetween = 0;
+    int readings = (GA1A12S202_RAW_RANGE - 1) << GA1A12S202_EXTRA_BITS;
+    for (int raw = 0; raw <= readings; raw++){
+        double expected = pow(10, raw * GA1A12S202_LOG_RANGE / GA1A12S202_RAW_RANGE / (1 << GA1A12S202_EXTRA_BITS));
+        uint32_t fixed = Adafruit_GA1A12S202::rawToLuxFixed(raw);
+        double error = fabs(fixed / (double)(1UL << GA1A12S202_LUX_FRAC_BITS) - expected) / expected;
+        if (raw % (1 << GA1A12S202_EXTRA_BITS) == 0){
+            worstStep = fmax(worstStep, error);
+        }
+        else{
+            worstBetween = fmax(worstBetween, error);
+        }
+        if (error > LUX_TOLERANCE){
+            printf("reading %d: %u/%lu lux, pow gives %f\n", raw, fixed, 1UL << GA1A12S202_LUX_FRAC_BITS, expected);
+            failures++;
+        }
+        if (Adafruit_GA1A12S202::luxToRawFixed(fixed) != raw){
+            printf("reading %d: %u/%lu lux turns back into %d\n", raw, fixed, 1UL << GA1A12S202_LUX_FRAC_BITS,
+                   Adafruit_GA1A12S202::luxToRawFixed(fixed));
+            failures++;
+        }
+    }
+    printf("worst error %.4f%% on a step of the table, %.4f%% between steps, %u failures\n",
+           worstStep * 100, worstBetween * 100, failures);
+    return failures != 0;
+}
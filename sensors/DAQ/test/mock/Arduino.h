@@ -0,0 +1,80 @@
+/**
+Arduino.h
+  Just enough of the Arduino core to build the EEPROM log, the light sensor table, the
+  thermocouple driver and the command parser on a PC for the host tests. Structs are packed like they are on the AVR so the log has the same layout, the
+  C++ library headers a test needs must be included before this one.
+**/
+#ifndef ARDUINO_H
+#define ARDUINO_H
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <avr/interrupt.h>
+
+#define ARDUINO 106
+#define EXTERNAL 0
+#define A0 14
+#define BIN 2
+#define DEC 10
+#define INPUT 0
+#define OUTPUT 1
+#define LOW 0
+#define HIGH 1
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define min(a,b) ((a)<(b)?(a):(b))
+#define max(a,b) ((a)>(b)?(a):(b))
+
+unsigned long millis (void);
+extern unsigned long hostMillis;   //what millis returns, a test moves it on
+int analogRead (uint8_t pin);
+void analogReference (uint8_t mode);
+void pinMode (uint8_t pin, uint8_t mode);
+void digitalWrite (uint8_t pin, uint8_t value);
+int digitalRead (uint8_t pin);
+
+//pins 0 to 7 are on port D, 8 to 13 on port B and 14 to 19 on port C, as on the Uno. The ports
+//are numbered 0 to 2 here.
+extern volatile uint8_t hostPort[3];
+extern volatile uint8_t hostPin[3];
+#define digitalPinToPort(pin) ((pin) < 8 ? 0 : (pin) < 14 ? 1 : 2)
+#define digitalPinToBitMask(pin) (1 << ((pin) < 8 ? (pin) : (pin) < 14 ? (pin) - 8 : (pin) - 14))
+#define portOutputRegister(port) (&hostPort[port])
+#define portInputRegister(port) (&hostPin[port])
+
+//output is counted and thrown away, only the start of the last write is kept. A test gives the
+//bytes that have arrived in input, read takes them from the front.
+struct HostSerial{
+    const char* input;
+    size_t waiting;
+    size_t written;
+    size_t writes;
+    char last[80];
+    size_t lastLength;
+    size_t println (const char*){return 0;};
+    size_t write (const uint8_t* data, size_t length){
+        lastLength = min(length, sizeof(last));
+        memcpy(last, data, lastLength);
+        written += length;
+        writes++;
+        return length;
+    };
+    int available (void){return waiting;};
+    int read (void){
+        if (waiting == 0){
+            return -1;
+        }
+        waiting--;
+        return (uint8_t)*input++;
+    };
+};
+extern HostSerial Serial;
+
+#pragma pack(1)
+#endif
@@ -0,0 +1,18 @@
+#ifndef AVR_EEPROM_H
+#define AVR_EEPROM_H
+#include <stdint.h>
+#include <stddef.h>
+uint8_t eeprom_read_byte (const uint8_t* address);
+void eeprom_read_block (void* destination, const void* source, size_t length);
+uint16_t eeprom_read_word (const uint16_t* address);
+//the AVR uint32_t is an unsigned long, EEPROMex casts to that
+uint32_t eeprom_read_dword (const void* address);
+float eeprom_read_float (const float* address);
+void eeprom_write_byte (uint8_t* address, uint8_t value);
+void eeprom_write_word (uint16_t* address, uint16_t value);
+void eeprom_write_dword (void* address, uint32_t value);
+void eeprom_write_float (float* address, float value);
+void eeprom_write_block (const void* source, void* destination, size_t length);
+#define eeprom_is_ready() 1
+#define eeprom_busy_wait()
+#endif
@@ -0,0 +1,5 @@
+#ifndef AVR_INTERRUPT_H
+#define AVR_INTERRUPT_H
+void cli (void);
+void sei (void);
+#endif
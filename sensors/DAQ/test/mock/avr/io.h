@@ -0,0 +1,43 @@
+/**
+avr/io.h
+  The registers the EEPROM log and the analog sampler use. EECR writes the EEPROM as soon as EEPE is
+  set and calls the EE_READY handler while EERIE is set, so queued writes are made straight away.
+**/
+#ifndef AVR_IO_H
+#define AVR_IO_H
+#include <stdint.h>
+
+#define SREG_I 7
+#define EERIE 3
+#define EEMPE 2
+#define EEPE 1
+#define ADEN 7
+#define ADSC 6
+#define ADATE 5
+#define ADIE 3
+#define ADPS2 2
+#define ADPS1 1
+#define ADPS0 0
+
+typedef struct EepromControl_TAG{
+    uint8_t bits;
+    operator uint8_t () const {return bits;};
+    EepromControl_TAG& operator|= (uint8_t set);
+    EepromControl_TAG& operator&= (uint8_t keep){bits &= keep; return *this;};
+}EepromControl;
+
+extern EepromControl EECR;
+extern volatile uint8_t EEDR;
+extern volatile uint16_t EEAR;
+extern volatile uint8_t SREG;
+extern volatile uint8_t ADCSRA, ADCSRB, ADMUX, DIDR0;
+extern volatile uint16_t ADC;
+
+//the EEPROM, how many times each byte has been written and how many bytes have been read
+#define E2END 0x3FF
+extern uint8_t hostEeprom[E2END + 1];
+extern uint32_t hostEepromWrites[E2END + 1];
+extern uint32_t hostEepromReads;
+//called while EERIE is set, Memory::eepromReady for the memory under test
+extern void (*hostEepromReady) (void);
+#endif
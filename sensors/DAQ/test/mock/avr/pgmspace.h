@@ -0,0 +1,9 @@
+#ifndef AVR_PGMSPACE_H
+#define AVR_PGMSPACE_H
+#include <stdint.h>
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t*)(address))
+#define pgm_read_word(address) (*(const uint16_t*)(address))
+#define pgm_read_dword(address) (*(const uint32_t*)(address))
+#define memcpy_P memcpy
+#endif
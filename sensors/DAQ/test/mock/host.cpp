@@ -0,0 +1,102 @@
+/**
+host.cpp
+  The EEPROM, registers and Arduino functions the host tests link against.
+**/
+#include "Arduino.h"
+#include <avr/eeprom.h>
+#include <util/delay.h>
+
+uint8_t hostEeprom[E2END + 1];
+uint32_t hostEepromWrites[E2END + 1];
+uint32_t hostEepromReads = 0;
+void (*hostEepromReady) (void) = NULL;
+
+EepromControl EECR = {0};
+volatile uint8_t EEDR;
+volatile uint16_t EEAR;
+volatile uint8_t SREG;
+volatile uint8_t ADCSRA, ADCSRB, ADMUX, DIDR0;
+volatile uint16_t ADC;
+volatile uint8_t hostPort[3];
+volatile uint8_t hostPin[3];
+void (*hostDelay) (double us) = NULL;
+HostSerial Serial;
+unsigned long hostMillis = 0;
+
+static boolean inEepromReady = false;
+
+EepromControl& EepromControl::operator|= (uint8_t set){
+    bits |= set;
+    if (bits & (1 << EEPE)){
+        hostEeprom[EEAR] = EEDR;
+        hostEepromWrites[EEAR]++;
+        bits &= ~((1 << EEPE) | (1 << EEMPE));
+    }
+    //the EE_READY inturrupt fires for as long as it is on
+    if (!inEepromReady && hostEepromReady != NULL){
+        inEepromReady = true;
+        while (bits & (1 << EERIE)){
+            hostEepromReady();
+        }
+        inEepromReady = false;
+    }
+    return *this;
+}
+
+void cli (void){SREG &= ~0x80;}
+void sei (void){SREG |= 0x80;}
+unsigned long millis (void){return hostMillis;}
+int analogRead (uint8_t){return 0;}
+void analogReference (uint8_t){}
+void pinMode (uint8_t, uint8_t){}
+void digitalWrite (uint8_t pin, uint8_t value){
+    if (value){
+        *portOutputRegister(digitalPinToPort(pin)) |= digitalPinToBitMask(pin);
+    }
+    else{
+        *portOutputRegister(digitalPinToPort(pin)) &= ~digitalPinToBitMask(pin);
+    }
+}
+int digitalRead (uint8_t pin){
+    return (*portInputRegister(digitalPinToPort(pin)) & digitalPinToBitMask(pin)) ? HIGH : LOW;
+}
+void _delay_us (double us){
+    if (hostDelay != NULL){
+        hostDelay(us);
+    }
+}
+void _delay_ms (double ms){_delay_us(ms * 1000);}
+
+uint8_t eeprom_read_byte (const uint8_t* address){
+    hostEepromReads++;
+    return hostEeprom[(uintptr_t)address];
+}
+void eeprom_read_block (void* destination, const void* source, size_t length){
+    hostEepromReads += length;
+    memcpy(destination, &hostEeprom[(uintptr_t)source], length);
+}
+uint16_t eeprom_read_word (const uint16_t* address){
+    uint16_t value;
+    eeprom_read_block(&value, address, sizeof(value));
+    return value;
+}
+uint32_t eeprom_read_dword (const void* address){
+    uint32_t value;
+    eeprom_read_block(&value, address, sizeof(value));
+    return value;
+}
+float eeprom_read_float (const float* address){
+    float value;
+    eeprom_read_block(&value, address, sizeof(value));
+    return value;
+}
+void eeprom_write_block (const void* source, void* destination, size_t length){
+    for (size_t i = 0; i < length; i++){
+        hostEeprom[(uintptr_t)destination + i] = ((const uint8_t*)source)[i];
+        hostEepromWrites[(uintptr_t)destination + i]++;
+    }
+}
+void eeprom_write_byte (uint8_t* address, uint8_t value){eeprom_write_block(&value, address, 1);}
+void eeprom_write_word (uint16_t* address, uint16_t value){eeprom_write_block(&value, address, 2);}
+void eeprom_write_dword (void* address, uint32_t value){eeprom_write_block(&value, address, 4);}
+void eeprom_write_float (float* address, float value){eeprom_write_block(&value, address, 4);}
@@ -0,0 +1,12 @@
+/**
+util/delay.h
+  The busy waits take no time on the host. Each one is handed to hostDelay instead, so a test can
+  count the time and move an emulated chip on.
+**/
+#ifndef UTIL_DELAY_H
+#define UTIL_DELAY_H
+void _delay_us (double us);
+void _delay_ms (double ms);
+//called with the length of each busy wait in microseconds
+extern void (*hostDelay) (double us);
+#endif
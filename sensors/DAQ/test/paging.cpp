@@ -0,0 +1,149 @@
+/**
+paging.cpp
+  Runs the whole sketch in the simulation in sim/ and checks that a log read a page at a time with
+  aDc,n!; holds the same reports as the whole log read with aD0!;. The experiment saves windows and
+  samples of ports with different dividers, so one period is often saved as several blocks, a
+  summary and the samples. Every page must hold whole periods, n of them, and the cursor it ends
+  with must start the next page where it left off. The last n periods read with aDn!; must be the
+  end of the whole log too. Build and run with run.sh.
+**/
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <set>
+#include "sim.h"
+
+#define PAGING_WAIT_US 30000000      //a response that takes longer than this is missing
+
+static uint32_t failures = 0;
+
+/**
+static std::vector<std::string> response (const char* text)
+  Sends text and runs the DAQ until the line that ends the response, with a ":", has been
+  received. Returns every line of it without the <CR><LF>.
+**/
+static std::vector<std::string> response (const char* text){
+    std::vector<std::string> lines;
+    size_t seen = simLines().size();
+    uint64_t arrived = simSend(text, simNow());
+    while (simNow() < arrived + PAGING_WAIT_US){
+        simRun(simNow() + 1000);
+        for (; seen < simLines().size(); seen++){
+            std::string line = simLines()[seen].text;
+            line.erase(line.size() - 2);
+            lines.push_back(line);
+            if (line[line.size() - 1] == ':'){
+                return lines;
+            }
+        }
+    }
+    printf("%s got no end of response\n", text);
+    failures++;
+    return lines;
+}
+
+//the time stamp of a data report, iii,p,time,value
+static std::string reportTime (const std::string& report){
+    size_t start = report.find(',', report.find(',') + 1) + 1;
+    return report.substr(start, report.find(',', start) - start);
+}
+
+/**
+static void readPages (const std::vector<std::string>& log, uint16_t pageSize)
+  Reads the log a page of pageSize periods at a time and checks the pages against log.
+**/
+static void readPages (const std::vector<std::string>& log, uint16_t pageSize){
+    std::vector<std::string> paged;
+    uint32_t cursor = 0;
+    uint32_t pages = 0;
+    for (;;){
+        char command[32];
+        snprintf(command, sizeof(command), "0D%u,%u!;", cursor, pageSize);
+        std::vector<std::string> page = response(command);
+        if (page.empty()){
+            return;
+        }
+        std::string end = page.back();
+        page.pop_back();
+        uint32_t next = strtoul(end.substr(end.rfind(',') + 1).c_str(), NULL, 10);
+        if (page.empty()){
+            break;
+        }
+        std::set<std::string> periods;
+        for (size_t line = 0; line < page.size(); line++){
+            periods.insert(reportTime(page[line]));
+            paged.push_back(page[line]);
+        }
+        pages++;
+        if (periods.size() > pageSize){
+            printf("%s: the page holds %u periods\n", command, (unsigned)periods.size());
+            failures++;
+        }
+        if (next <= cursor){
+            printf("%s: the next page starts at %u\n", command, next);
+            failures++;
+            break;
+        }
+        cursor = next;
+    }
+    uint32_t missing = 0;
+    for (size_t line = 0; line < log.size() || line < paged.size(); line++){
+        if (line >= log.size() || line >= paged.size() || paged[line] != log[line]){
+            missing++;
+        }
+    }
+    printf("pages of %u periods: %u pages, %u reports, %u of the %u reports of the whole log differ\n",
+           pageSize, pages, (unsigned)paged.size(), missing, (unsigned)log.size());
+    failures += (missing != 0);
+}
+
+/**
+static void readLast (const std::vector<std::string>& log, uint16_t amount)
+  Reads the last amount periods and checks they are the reports of the last amount periods of log.
+**/
+static void readLast (const std::vector<std::string>& log, uint16_t amount){
+    char command[32];
+    snprintf(command, sizeof(command), "0D%u!;", amount);
+    std::vector<std::string> last = response(command);
+    if (last.empty()){
+        return;
+    }
+    last.back().erase(last.back().size() - 1);
+    //the reports of log from the first line of the amount-th period from the end
+    std::set<std::string> periods;
+    size_t start = log.size();
+    while (start > 0 && (periods.size() < amount || periods.count(reportTime(log[start - 1])) != 0)){
+        periods.insert(reportTime(log[--start]));
+    }
+    std::vector<std::string> expected(log.begin() + start, log.end());
+    printf("the last %u periods: %u reports, %u expected\n", amount, (unsigned)last.size(), (unsigned)expected.size());
+    if (last != expected){
+        printf("%s is not the end of the whole log\n", command);
+        failures++;
+    }
+}
+
+int main (void){
+    simStart();
+    //port 1 summarised every 3 samples, port 6 every 4, port 3 sampled every other period
+    const char* settings[] = {"0P0,100!;", "1W3!;", "6W4!;", "3I2!;"};
+    for (uint8_t setting = 0; setting < sizeof(settings) / sizeof(settings[0]); setting++){
+        simSend(settings[setting], simNow());
+        simRun(simNow() + 100000);
+    }
+    simSend("0M40!;", simNow());
+    simRun(simNow() + 6000000);
+    std::vector<std::string> log = response("0D0!;");
+    //the whole log ends its last report with the terminator, a page ends with the cursor instead
+    if (!log.empty()){
+        log.back().erase(log.back().size() - 1);
+    }
+    printf("the whole log holds %u reports\n", (unsigned)log.size());
+    readPages(log, 1);
+    readPages(log, 3);
+    readLast(log, 1);
+    readLast(log, 5);
+    printf("%u failures\n", failures);
+    return failures != 0;
+}
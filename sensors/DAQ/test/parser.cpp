@@ -0,0 +1,165 @@
+/**
+parser.cpp
+  Feeds the command parser through the mock Serial and works out how many commands a second it
+  parses and how long the main loop waits on it. First every command is waiting at once and poll is
+  called until they are all parsed. Then the same commands trickle in the way a slow master or a
+  radio link sends them, a few bytes at a time with gaps of up to PARSER_MAX_GAP_MS between the
+  pieces, while the main loop calls poll every PARSER_LOOP_US. Now and then a command stops part
+  way and never finishes, it must time out, and now and then the loop is busy for longer than the
+  timeout while a command arrives, it must still be parsed.
+  The times of poll are measured on the PC, not the AVR. The wait of the blocking
+  Serial.readBytesUntil the parser replaced is modelled from the same arrival times, it waited from
+  the first byte of a command to its ";" or to a gap of SDI_COMMAND_TIMEOUT. Build and run with
+  run.sh.
+**/
+#include <stdio.h>
+#include <time.h>
+#include "Arduino.h"
+#include "CommandParser.h"
+
+#define PARSER_COMMANDS 4000
+#define PARSER_STREAM 65536          //room for every command sent
+#define PARSER_ROUNDS 20              //times the waiting commands are parsed, for a steady rate
+#define PARSER_BYTE_US 1042           //one byte with its start and stop bits at 9600 baud
+#define PARSER_LOOP_US 1000           //a pass of the main loop with nothing else to do
+#define PARSER_BUSY_US 1500000        //a pass of the main loop sending a long D dump
+#define PARSER_MAX_PIECE 4            //most bytes sent together
+#define PARSER_MAX_GAP_MS 300         //longest gap between the pieces of a command
+#define PARSER_STALL_EVERY 25         //every this many commands one stops part way
+#define PARSER_BUSY_EVERY 40          //every this many commands the loop is busy as it arrives
+
+static const char* commands[] = {"1!;", "0M300!;", "0D0!;", "0D1200,5!;", "3I2!;", "0P0,100!;",
+                                 "6W4!;", "2H5,60!;", "63Q1700000000,1700000100!;", "0L10!;"};
+#define PARSER_KINDS (sizeof(commands) / sizeof(commands[0]))
+
+static char stream[PARSER_STREAM];
+static size_t streamLength = 0;
+static uint64_t arrival[PARSER_STREAM];     //the time each byte of stream arrives, in us
+static boolean busy[PARSER_STREAM];         //true if the loop is busy as the byte arrives, after the first byte of a command
+static uint32_t failures = 0;
+static uint32_t seed = 1;
+
+//a pseudo random number from 0 to range-1, the same every run
+static uint32_t randomTo (uint32_t range){
+    seed = seed * 1103515245UL + 12345;
+    return (seed >> 8) % range;
+}
+
+static double nowUs (void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000.0 + now.tv_nsec / 1000.0;
+}
+
+/**
+static void waitingCommands (void)
+  Parses PARSER_COMMANDS commands that are all waiting in the serial port, PARSER_ROUNDS times.
+**/
+static void waitingCommands (void){
+    streamLength = 0;
+    for (uint32_t sent = 0; sent < PARSER_COMMANDS; sent++){
+        for (const char* c = commands[sent % PARSER_KINDS]; *c != 0; c++){
+            stream[streamLength++] = *c;
+        }
+    }
+    CommandParser parser;
+    uint32_t parsed = 0;
+    double start = nowUs();
+    for (uint8_t round = 0; round < PARSER_ROUNDS; round++){
+        Serial.input = stream;
+        Serial.waiting = streamLength;
+        while (Serial.available() > 0){
+            parsed += (parser.poll() == PARSER_COMMAND);
+        }
+    }
+    double seconds = (nowUs() - start) / 1000000;
+    printf("commands waiting    %9.0f commands/s  %10.0f bytes/s on this PC\n", parsed / seconds,
+           streamLength * PARSER_ROUNDS / seconds);
+    if (parsed != (uint32_t)PARSER_COMMANDS * PARSER_ROUNDS){
+        printf("%u of %u commands parsed\n", parsed, PARSER_COMMANDS * PARSER_ROUNDS);
+        failures++;
+    }
+}
+
+/**
+static void tricklingCommands (void)
+  Sends PARSER_COMMANDS commands a few bytes at a time and runs the main loop as they arrive.
+**/
+static void tricklingCommands (void){
+    streamLength = 0;
+    uint32_t expected = 0;
+    uint32_t stalls = 0;
+    uint64_t oldWorst = 0;
+    uint64_t time = 0;
+    for (uint32_t sent = 0; sent < PARSER_COMMANDS; sent++){
+        const char* text = commands[sent % PARSER_KINDS];
+        size_t textLength = strlen(text);
+        boolean stall = (sent % PARSER_STALL_EVERY == PARSER_STALL_EVERY - 1);
+        if (stall){
+            textLength = 1 + randomTo(textLength - 1);
+            stalls++;
+        }
+        else{
+            expected++;
+        }
+        uint64_t first = time;
+        for (size_t piece = 0; piece < textLength; ){
+            size_t length = 1 + randomTo(PARSER_MAX_PIECE);
+            for (size_t byte = 0; byte < length && piece < textLength; byte++, piece++){
+                time += PARSER_BYTE_US;
+                stream[streamLength] = text[piece];
+                arrival[streamLength] = time;
+                busy[streamLength++] = !stall && sent % PARSER_BUSY_EVERY == PARSER_BUSY_EVERY - 1 && piece == 1;
+            }
+            time += (uint64_t)randomTo(PARSER_MAX_GAP_MS) * 1000;
+        }
+        //readBytesUntil gave up once no byte came for the timeout
+        uint64_t oldWait = stall ? arrival[streamLength - 1] + SDI_COMMAND_TIMEOUT * 1000ULL - first : arrival[streamLength - 1] - first;
+        oldWorst = (oldWait > oldWorst) ? oldWait : oldWorst;
+        time += stall ? (SDI_COMMAND_TIMEOUT + PARSER_MAX_GAP_MS) * 1000ULL : randomTo(50) * 1000ULL;
+    }
+    CommandParser parser;
+    uint32_t parsed = 0;
+    uint32_t errors = 0;
+    uint32_t busyPasses = 0;
+    double worst = 0;
+    size_t arrived = 0;
+    Serial.input = stream;
+    for (uint64_t now = 0; now <= time; ){
+        while (arrived < streamLength && arrival[arrived] <= now){
+            arrived++;
+        }
+        Serial.waiting = arrived - (Serial.input - stream);
+        hostMillis = now / 1000;
+        double start = nowUs();
+        uint8_t result = parser.poll();
+        double took = nowUs() - start;
+        worst = (took > worst) ? took : worst;
+        parsed += (result == PARSER_COMMAND);
+        errors += (result == PARSER_ERROR);
+        //the loop is busy with the next pass if the next byte is marked, part of a command is waiting
+        size_t next = Serial.input - stream;
+        if (next < streamLength && busy[next] && arrival[next] <= now + PARSER_LOOP_US){
+            busyPasses++;
+            now += PARSER_BUSY_US;
+        }
+        else{
+            now += PARSER_LOOP_US;
+        }
+    }
+    printf("commands trickling  %u parsed, %u timed out, %u busy loop passes, worst poll %.1f us on this PC\n",
+           parsed, errors, busyPasses, worst);
+    printf("                    readBytesUntil would have held the loop for up to %llu ms, modelled\n",
+           (unsigned long long)(oldWorst / 1000));
+    if (parsed != expected || errors != stalls || busyPasses == 0){
+        printf("expected %u commands and %u time outs\n", expected, stalls);
+        failures++;
+    }
+}
+
+int main (void){
+    waitingCommands();
+    tricklingCommands();
+    printf("%u failures\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,104 @@
+/**
+query.cpp
+  Checks how much of the log a query reads. Fills the log with samples from every port, from one
+  port, and from one port saved every third period, then seeks every period from the oldest saved
+  one on. Each seek must land on the oldest saved period at or after the one asked for and read
+  no more than QUERY_MAX_SHARE of the EEPROM a full scan of the log reads. Also checks that
+  lastPeriod gives the log tail that Port::sendQuery stops at. Build and run with run.sh.
+**/
+#include <cstdio>
+#include "Arduino.h"
+#include "Memory.h"
+
+#define QUERY_PERIODS 3000
+#define QUERY_MAX_SHARE 4            //a seek reads at most a quarter of a full scan
+
+static Memory memory;
+
+static void eepromReady (void){
+    memory.eepromReady();
+}
+
+//fills the log with QUERY_PERIODS periods of the ports in portMask, saved every step periods,
+//and reports the EEPROM bytes read by seeks and by a full scan. Returns the number of failures.
+static uint32_t runLog (const char* name, uint8_t portMask, uint8_t step){
+    memset(hostEeprom, 0xFF, sizeof(hostEeprom));
+    memory = Memory();
+    memory.memorySetup();
+    ExperimentBlock experimentBlock;
+    memory.loadExperimentBlock(&experimentBlock);
+    experimentBlock.logEpoch = memory.reset();
+    memory.updateExperimentBlock(experimentBlock);
+    uint32_t failures = 0;
+    uint32_t tail;
+    if (memory.lastPeriod(&tail)){
+        printf("%s: empty log has a tail\n", name);
+        failures++;
+    }
+    int16_t value = 0;
+    for (uint32_t period = step; period <= QUERY_PERIODS; period += step){
+        DataBlock dataBlock;
+        dataBlock.periodNumber = period;
+        dataBlock.portMask = portMask;
+        dataBlock.count = 0;
+        for (uint8_t port = 0; port < MEMORY_MAX_PORTS; port++){
+            dataBlock.data[port] = value + port;
+        }
+        value += (period % 2) ? 1 : -1;
+        memory.saveDataBlock(dataBlock);
+    }
+    memory.flush();
+    if (!memory.lastPeriod(&tail) || tail != (uint32_t)(QUERY_PERIODS - QUERY_PERIODS % step)){
+        printf("%s: log tail is not the last period saved\n", name);
+        failures++;
+    }
+    //full scan
+    LogCursor cursor;
+    DataBlock dataBlock;
+    memory.firstBlock(&cursor);
+    if (!memory.loadDataBlock(&cursor, &dataBlock)){
+        printf("%s: nothing saved\n", name);
+        return failures + 1;
+    }
+    uint32_t oldest = dataBlock.periodNumber;
+    hostEepromReads = 0;
+    memory.firstBlock(&cursor);
+    while (memory.loadDataBlock(&cursor, &dataBlock)){
+    }
+    uint32_t fullScan = hostEepromReads;
+    //seek every period, saved or not
+    uint32_t worst = 0;
+    uint32_t total = 0;
+    uint32_t seeks = 0;
+    for (uint32_t period = oldest; period <= tail; period++){
+        hostEepromReads = 0;
+        memory.seekBlock(&cursor, period);
+        uint32_t reads = hostEepromReads;
+        uint32_t expected = (period + step - 1) / step * step;
+        if (!memory.loadDataBlock(&cursor, &dataBlock) || dataBlock.periodNumber != expected){
+            printf("%s: seek to period %u did not land on period %u\n", name, period, expected);
+            failures++;
+        }
+        if (reads > worst){
+            worst = reads;
+        }
+        total += reads;
+        seeks++;
+    }
+    printf("%-24s periods %4u to %4u  seek reads worst %3u mean %5.1f  full scan %5u\n",
+           name, oldest, tail, worst, (double)total / seeks, fullScan);
+    if (worst * QUERY_MAX_SHARE > fullScan){
+        printf("%s: a seek read more than 1/%u of a full scan\n", name, QUERY_MAX_SHARE);
+        failures++;
+    }
+    return failures;
+}
+
+int main (void){
+    hostEepromReady = eepromReady;
+    uint32_t failures = 0;
+    failures += runLog("6 ports", MEMORY_PORT_MASK, 1);
+    failures += runLog("1 port", 0x01, 1);
+    failures += runLog("1 port every 3 periods", 0x01, 3);
+    return failures != 0;
+}
@@ -0,0 +1,266 @@
+/**
+responseline.cpp
+  Formats the same data reports with ResponseLine and with the Serial.print calls it replaced and
+  works out how many lines a second each formats, how many calls to the serial port each line takes
+  and how many bytes each sample is sent as. The old calls are copied in below from miniSDI_12.cpp
+  as it was, over a Print that converts numbers the way the Arduino core does, dividing by the
+  base. Every line of the old and new code must be the same. The unused uint32_t dataReport
+  overload printed its value in binary, it is counted for the bytes too.
+  A PC divides as fast as it subtracts, so the rates measured on it say little about the AVR, where
+  a 32 bit division is a library call of hundreds of cycles. The AVR rates are modelled, not
+  measured: the divisions, subtractions, calls and bytes of each line are counted and given the
+  estimated cycles below. Build and run with run.sh.
+**/
+#include <stdio.h>
+#include <time.h>
+#include "Arduino.h"
+#include "miniSDI_12.h"
+
+#define RESPONSE_SAMPLES 1000         //different reports formatted
+#define RESPONSE_ROUNDS 200           //times every report is formatted, for a steady rate
+#define RESPONSE_LAST_EVERY 50        //every this many reports one ends a response with ":"
+#define RESPONSE_PORTS 6              //PORT_MAX, port 6 is the light sensor
+#define RESPONSE_CPU_MHZ 16
+#define RESPONSE_DIV32_CYCLES 650     //__udivmodsi4, a 32 bit division with its remainder
+#define RESPONSE_DIV8_CYCLES 60       //__udivmodqi4, an 8 bit division with its remainder
+#define RESPONSE_CALL_CYCLES 30       //a call to print or write through the Print vtable
+#define RESPONSE_WRITE_CYCLES 50      //HardwareSerial::write of one byte into the ring buffer
+#define RESPONSE_POWER_CYCLES 20      //reading a power of ten from flash and the digit loop
+#define RESPONSE_SUB_CYCLES 10        //one 32 bit compare and subtraction
+#define RESPONSE_PUT_CYCLES 8         //adding a byte to the line
+
+static uint32_t failures = 0;
+static uint32_t seed = 1;
+
+//a pseudo random number from 0 to range-1, the same every run
+static uint32_t randomTo (uint32_t range){
+    seed = seed * 1103515245UL + 12345;
+    return (seed >> 8) % range;
+}
+
+static double nowUs (void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000.0 + now.tv_nsec / 1000.0;
+}
+
+//the Print of the Arduino core, every byte is a call to write and numbers are divided by the base
+struct OldPrint{
+    char line[128];
+    size_t length;
+    size_t calls;                     //calls to print and println
+    size_t divisions;                 //32 bit divisions by the base
+    size_t write (uint8_t c){
+        if (length < sizeof(line)){
+            line[length++] = c;
+        }
+        return 1;
+    }
+    size_t write (const char* text){
+        size_t n = 0;
+        while (*text != 0){
+            n += write((uint8_t)*text++);
+        }
+        return n;
+    }
+    size_t printNumber (unsigned long n, uint8_t base){
+        char buf[8 * sizeof(long) + 1];
+        char* str = &buf[sizeof(buf) - 1];
+        *str = '\0';
+        do{
+            unsigned long m = n;
+            n /= base;
+            divisions++;
+            char c = m - base * n;
+            *--str = c < 10 ? c + '0' : c + 'A' - 10;
+        } while (n);
+        return write(str);
+    }
+    size_t print (const char* text){calls++; return write(text);}
+    size_t print (unsigned long n, int base = DEC){calls++; return printNumber(n, base);}
+    size_t print (long n, int base = DEC){
+        calls++;
+        if (base == DEC && n < 0){
+            return write('-') + printNumber(-n, 10);
+        }
+        return printNumber(n, base);
+    }
+    size_t print (int n, int base = DEC){return print((long)n, base);}
+    size_t println (void){calls++; return write("\r\n");}
+    size_t println (int n){size_t sent = print(n); return sent + println();}
+};
+static OldPrint oldSerial;
+
+//miniSDI_12.cpp before ResponseLine, F() strings are plain strings on the PC
+static void printFixed (int32_t value, uint8_t fracBits){
+    if (value == SDI_NO_VALUE){
+        oldSerial.print("nan");
+        return;
+    }
+    uint32_t magnitude = value;
+    if (value < 0){
+        oldSerial.print("-");
+        magnitude = -value;
+    }
+    else{
+        oldSerial.print("+");
+    }
+    uint32_t whole = magnitude >> fracBits;
+    uint32_t fraction = magnitude & ((1UL << fracBits) - 1);
+    fraction = (fraction * 100 + ((1UL << fracBits) >> 1)) >> fracBits;
+    if (fraction == 100){
+        whole++;
+        fraction = 0;
+    }
+    oldSerial.print((unsigned long)whole);
+    oldSerial.print(".");
+    if (fraction < 10){
+        oldSerial.print("0");
+    }
+    oldSerial.print((unsigned long)fraction);
+}
+
+static void oldDataReport (int a, uint32_t time, int32_t value, uint8_t fracBits, boolean lastVal){
+    oldSerial.print("00");
+    oldSerial.print(SDI_DAQ_ID);
+    oldSerial.print(",");
+    oldSerial.print(a);
+    oldSerial.print(",");
+    oldSerial.print((unsigned long)time);
+    oldSerial.print(",");
+    printFixed(value, fracBits);
+    //the callers ended the line, see sendSavedData
+    if (lastVal){
+        oldSerial.print(":");
+    }
+    oldSerial.println();
+}
+
+static void oldBinaryReport (int a, uint32_t time, uint32_t value){
+    oldSerial.print("00");
+    oldSerial.print(SDI_DAQ_ID);
+    oldSerial.print(",");
+    oldSerial.print(a);
+    oldSerial.print(",");
+    oldSerial.print((unsigned long)time);
+    oldSerial.print(",");
+    oldSerial.print((unsigned long)value, BIN);
+    oldSerial.println();
+}
+
+//the work ResponseLine does for a data report without milliseconds, see putNumber and putFixed
+static uint32_t powers = 0;
+static uint32_t subtractions = 0;
+static uint32_t smallDivisions = 0;
+
+static void countNumber (uint32_t value){
+    for (uint32_t power = 1000000000UL; power > 0; power /= 10){
+        powers++;
+        subtractions += (value / power) % 10;
+    }
+}
+
+static void countReport (int a, uint32_t time, int32_t value, uint8_t fracBits){
+    countNumber(SDI_DAQ_ID);
+    countNumber(a);
+    countNumber(time);
+    if (value != SDI_NO_VALUE){
+        uint32_t magnitude = (value < 0) ? -(uint32_t)value : value;
+        uint32_t fraction = magnitude & ((1UL << fracBits) - 1);
+        fraction = (fraction * 100 + ((1UL << fracBits) >> 1)) >> fracBits;
+        countNumber((magnitude >> fracBits) + (fraction == 100));
+        smallDivisions++;
+    }
+}
+
+//the reports, quarter degrees from the thermocouples and 1/1024 lux from the light sensor
+static uint8_t ports[RESPONSE_SAMPLES];
+static uint32_t times[RESPONSE_SAMPLES];
+static int32_t values[RESPONSE_SAMPLES];
+static uint8_t fracBits[RESPONSE_SAMPLES];
+
+int main (void){
+    for (uint16_t sample = 0; sample < RESPONSE_SAMPLES; sample++){
+        ports[sample] = 1 + sample % RESPONSE_PORTS;
+        times[sample] = 1700000000UL + sample;
+        if (ports[sample] == RESPONSE_PORTS){
+            fracBits[sample] = 10;
+            values[sample] = randomTo(80000UL << 10);
+        }
+        else{
+            fracBits[sample] = 2;
+            values[sample] = (int32_t)randomTo(6200) - 1080;
+        }
+        if (sample % 97 == 0){
+            values[sample] = SDI_NO_VALUE;
+        }
+    }
+    //the same lines
+    uint32_t differ = 0;
+    for (uint16_t sample = 0; sample < RESPONSE_SAMPLES; sample++){
+        boolean last = (sample % RESPONSE_LAST_EVERY == RESPONSE_LAST_EVERY - 1);
+        oldSerial.length = 0;
+        oldDataReport(ports[sample], times[sample], values[sample], fracBits[sample], last);
+        dataReport(ports[sample], times[sample], 0, values[sample], fracBits[sample], last);
+        if (oldSerial.length != Serial.lastLength || memcmp(oldSerial.line, Serial.last, Serial.lastLength) != 0){
+            if (differ++ == 0){
+                printf("old %.*s new %.*s", (int)oldSerial.length, oldSerial.line, (int)Serial.lastLength, Serial.last);
+            }
+        }
+    }
+    //old
+    oldSerial.calls = 0;
+    oldSerial.divisions = 0;
+    size_t oldBytes = 0;
+    double start = nowUs();
+    for (uint16_t round = 0; round < RESPONSE_ROUNDS; round++){
+        for (uint16_t sample = 0; sample < RESPONSE_SAMPLES; sample++){
+            oldSerial.length = 0;
+            oldDataReport(ports[sample], times[sample], values[sample], fracBits[sample],
+                          sample % RESPONSE_LAST_EVERY == RESPONSE_LAST_EVERY - 1);
+            oldBytes += oldSerial.length;
+        }
+    }
+    double oldSeconds = (nowUs() - start) / 1000000;
+    size_t oldCalls = oldSerial.calls;
+    //new
+    Serial.writes = 0;
+    Serial.written = 0;
+    start = nowUs();
+    for (uint16_t round = 0; round < RESPONSE_ROUNDS; round++){
+        for (uint16_t sample = 0; sample < RESPONSE_SAMPLES; sample++){
+            dataReport(ports[sample], times[sample], 0, values[sample], fracBits[sample],
+                       sample % RESPONSE_LAST_EVERY == RESPONSE_LAST_EVERY - 1);
+        }
+    }
+    double newSeconds = (nowUs() - start) / 1000000;
+    //the binary overload, only the bytes
+    size_t binaryBytes = 0;
+    for (uint16_t sample = 0; sample < RESPONSE_SAMPLES; sample++){
+        oldSerial.length = 0;
+        oldBinaryReport(ports[sample], times[sample], values[sample]);
+        binaryBytes += oldSerial.length;
+    }
+    for (uint16_t round = 0; round < RESPONSE_ROUNDS; round++){
+        for (uint16_t sample = 0; sample < RESPONSE_SAMPLES; sample++){
+            countReport(ports[sample], times[sample], values[sample], fracBits[sample]);
+        }
+    }
+    double lines = (double)RESPONSE_SAMPLES * RESPONSE_ROUNDS;
+    double oldCycles = ((double)oldSerial.divisions * RESPONSE_DIV32_CYCLES + (double)oldCalls * RESPONSE_CALL_CYCLES +
+                        (double)oldBytes * RESPONSE_WRITE_CYCLES) / lines;
+    double newCycles = ((double)powers * RESPONSE_POWER_CYCLES + (double)subtractions * RESPONSE_SUB_CYCLES +
+                        (double)smallDivisions * RESPONSE_DIV8_CYCLES + (double)Serial.writes * RESPONSE_CALL_CYCLES +
+                        (double)Serial.written * (RESPONSE_PUT_CYCLES + RESPONSE_WRITE_CYCLES)) / lines;
+    printf("                    lines/s on PC  lines/s on AVR  calls a line  bytes a sample\n");
+    printf("Serial.print calls  %13.0f  %14.0f  %12.1f  %14.2f\n", lines / oldSeconds,
+           RESPONSE_CPU_MHZ * 1000000.0 / oldCycles, oldCalls / lines, oldBytes / lines);
+    printf("ResponseLine        %13.0f  %14.0f  %12.1f  %14.2f\n", lines / newSeconds,
+           RESPONSE_CPU_MHZ * 1000000.0 / newCycles, Serial.writes / lines, Serial.written / lines);
+    printf("binary uint32_t report                                          %14.2f\n",
+           (double)binaryBytes / RESPONSE_SAMPLES);
+    printf("PC rates measured, AVR rates modelled, %u of %u lines differ\n", differ, RESPONSE_SAMPLES);
+    failures += (differ != 0);
+    printf("%u failures\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,101 @@
+#!/bin/sh
+# Builds and runs the host tests of the DAQ sketch with the mocks in mock/, the tests of the whole
+# sketch with the simulated Uno in sim/ and, if node is installed, the test of the app's frame
+# decoder. Needs a C++11 compiler, g++ by default. Run from anywhere: sh test/run.sh
+cd "$(dirname "$0")" || exit 1
+CXX=${CXX:-g++}
+FLAGS="-std=gnu++11 -O2 -Wall -Wextra -Imock -I.."
+# libraries copied in from elsewhere are built as they are, without warnings
+LIBRARIES="EEPROMex.cpp RTClib.cpp TSL2561.cpp"
+# RTClib declares a copy constructor for DateTime and no assignment
+SIMFLAGS="-std=gnu++11 -O2 -Wall -Wextra -Wno-deprecated-copy -Isim -Imock -I.."
+OUT=$(mktemp -d) || exit 1
+trap 'rm -rf "$OUT"' EXIT
+status=0
+
+# run <test> <sketch sources...>
+run (){
+    test=$1
+    shift
+    sources=""
+    for source in "$@"; do
+        case " $LIBRARIES " in
+        *" $source "*)
+            if ! $CXX $FLAGS -w -include Arduino.h -c -o "$OUT/$source.o" "../$source"; then
+                status=1
+                return
+            fi
+            sources="$sources $OUT/$source.o";;
+        *)
+            sources="$sources ../$source";;
+        esac
+    done
+    echo "== $test"
+    if ! $CXX $FLAGS -include Arduino.h -o "$OUT/$test" "$test.cpp" mock/host.cpp $sources; then
+        status=1
+        return
+    fi
+    "$OUT/$test" || status=1
+}
+
+# sim <test> <arguments...>
+# builds the whole sketch once, daq.ino and every source beside it, and links the test with it
+sim (){
+    test=$1
+    shift
+    if [ ! -d "$OUT/sim" ]; then
+        mkdir "$OUT/sim"
+        for source in ../*.cpp ../daq.ino; do
+            source=$(basename "$source")
+            case " $LIBRARIES " in
+            *" $source "*) quiet=-w;;
+            *) quiet=;;
+            esac
+            if ! $CXX $SIMFLAGS $quiet -x c++ -include Arduino.h -c -o "$OUT/sim/$source.o" "../$source"; then
+                status=1
+                rm -rf "$OUT/sim"
+                return
+            fi
+        done
+        if ! $CXX $SIMFLAGS -c -o "$OUT/sim/sim.o" sim/sim.cpp; then
+            status=1
+            rm -rf "$OUT/sim"
+            return
+        fi
+    fi
+    echo "== $test"
+    if ! $CXX $SIMFLAGS -o "$OUT/$test" "$test.cpp" "$OUT"/sim/*.o; then
+        status=1
+        return
+    fi
+    "$OUT/$test" "$@" || status=1
+}
+
+# js <test> <arguments...>
+# runs a test of the app's javascript with node, skipped if node is not installed
+js (){
+    test=$1
+    shift
+    echo "== $test.js"
+    if ! command -v node >/dev/null 2>&1; then
+        echo "node not found, skipped"
+        return
+    fi
+    node "$test.js" "$@" || status=1
+}
+
+run epoch Memory.cpp WriteQueue.cpp EEPROMex.cpp
+run wear Memory.cpp WriteQueue.cpp EEPROMex.cpp
+run query Memory.cpp WriteQueue.cpp EEPROMex.cpp
+run capacity Memory.cpp WriteQueue.cpp EEPROMex.cpp
+run lux Adafruit_GA1A12S202.cpp AnalogSampler.cpp
+run thermo Adafruit_MAX31855.cpp
+run parser CommandParser.cpp miniSDI_12.cpp ResponseLine.cpp
+run responseline miniSDI_12.cpp ResponseLine.cpp
+sim latency
+sim paging
+sim live
+sim baud
+sim dump "$OUT"
+js decode "$OUT"
+exit $status
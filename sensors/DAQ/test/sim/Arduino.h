@@ -0,0 +1,103 @@
+/**
+Arduino.h
+  The Arduino core the whole sketch is built against for the simulation in sim.cpp. Time only
+  passes when the sketch does something that takes time on the Uno: waiting, reading the time or
+  the status register, sending a byte when the serial buffer is full, or using the I2C bus. Structs
+  are packed like they are on the AVR, the C++ library headers a test needs must be included
+  before this one.
+**/
+#ifndef ARDUINO_H
+#define ARDUINO_H
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <avr/interrupt.h>
+
+#define ARDUINO 106
+#define F_CPU 16000000UL
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define EXTERNAL 0
+#define A0 14
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define min(a,b) ((a)<(b)?(a):(b))
+#define max(a,b) ((a)>(b)?(a):(b))
+
+unsigned long millis (void);
+unsigned long micros (void);
+void delay (unsigned long ms);
+void delayMicroseconds (unsigned int us);
+int analogRead (uint8_t pin);
+void analogReference (uint8_t mode);
+void pinMode (uint8_t pin, uint8_t mode);
+void digitalWrite (uint8_t pin, uint8_t value);
+int digitalRead (uint8_t pin);
+
+//pins 0 to 7 are on port D, 8 to 13 on port B and 14 to 19 on port C, as on the Uno. The ports
+//are numbered 0 to 2 here.
+extern volatile uint8_t simPort[3];
+extern volatile uint8_t simPin[3];
+#define digitalPinToPort(pin) ((pin) < 8 ? 0 : (pin) < 14 ? 1 : 2)
+#define digitalPinToBitMask(pin) (1 << ((pin) < 8 ? (pin) : (pin) < 14 ? (pin) - 8 : (pin) - 14))
+#define portOutputRegister(port) (&simPort[port])
+#define portInputRegister(port) (&simPin[port])
+
+class __FlashStringHelper;
+#define F(text) (reinterpret_cast<const __FlashStringHelper*>(text))
+
+class Print{
+    public:
+    virtual size_t write (uint8_t value) = 0;
+    size_t write (const uint8_t* buffer, size_t length);
+    size_t write (const char* text){return write((const uint8_t*)text, strlen(text));};
+    size_t print (const __FlashStringHelper* text){return print((const char*)text);};
+    size_t print (const char* text){return write(text);};
+    size_t print (char value){return write((uint8_t)value);};
+    size_t print (unsigned char value, int base = DEC){return print((unsigned long)value, base);};
+    size_t print (int value, int base = DEC){return print((long)value, base);};
+    size_t print (unsigned int value, int base = DEC){return print((unsigned long)value, base);};
+    size_t print (long value, int base = DEC);
+    size_t print (unsigned long value, int base = DEC);
+    size_t print (double value, int digits = 2);
+    size_t println (void){return write("\r\n");};
+    template <class T> size_t println (T value){size_t n = print(value); return n + println();};
+    template <class T> size_t println (T value, int format){size_t n = print(value, format); return n + println();};
+};
+
+class Stream : public Print{
+    public:
+    virtual int available (void) = 0;
+    virtual int read (void) = 0;
+    virtual int peek (void) = 0;
+};
+
+class HardwareSerial : public Stream{
+    public:
+    void begin (unsigned long baud);
+    void end (void);
+    int available (void);
+    int read (void);
+    int peek (void);
+    void flush (void);
+    size_t write (uint8_t value);
+    using Print::write;
+    operator bool (void){return true;};
+};
+extern HardwareSerial Serial;
+
+#pragma pack(1)
+#endif
@@ -0,0 +1,27 @@
+/**
+Wire.h
+  The I2C bus with a DS1307 on it, see sim.cpp. Every transaction takes the time it would at
+  100 kHz. Only the RTC answers, a read from any other address gets nothing.
+**/
+#ifndef WIRE_H
+#define WIRE_H
+#include "Arduino.h"
+
+class TwoWire{
+    public:
+    void begin (void);
+    void beginTransmission (uint8_t address);
+    void beginTransmission (int address){beginTransmission((uint8_t)address);};
+    uint8_t endTransmission (void);
+    uint8_t endTransmission (uint8_t){return endTransmission();};
+    size_t write (uint8_t value);
+    size_t write (const uint8_t* values, size_t length);
+    uint8_t requestFrom (uint8_t address, uint8_t length);
+    uint8_t requestFrom (int address, int length){return requestFrom((uint8_t)address, (uint8_t)length);};
+    int available (void);
+    int read (void);
+};
+extern TwoWire Wire;
+//RTClib uses Wire1 when it is not built for the AVR
+#define Wire1 Wire
+#endif
@@ -0,0 +1,23 @@
+/**
+avr/eeprom.h
+  Reads come straight from the simulated EEPROM. Writes are made through EECR, each one takes
+  SIM_EEPROM_WRITE_US, so waiting for the EEPROM lets the simulated time pass.
+**/
+#ifndef AVR_EEPROM_H
+#define AVR_EEPROM_H
+#include <stdint.h>
+#include <stddef.h>
+#include <avr/io.h>
+uint8_t eeprom_read_byte (const uint8_t* address);
+void eeprom_read_block (void* destination, const void* source, size_t length);
+uint16_t eeprom_read_word (const uint16_t* address);
+uint32_t eeprom_read_dword (const void* address);
+float eeprom_read_float (const float* address);
+void eeprom_write_byte (uint8_t* address, uint8_t value);
+void eeprom_write_word (uint16_t* address, uint16_t value);
+void eeprom_write_dword (void* address, uint32_t value);
+void eeprom_write_float (float* address, float value);
+void eeprom_write_block (const void* source, void* destination, size_t length);
+#define eeprom_is_ready() (!(EECR & (1 << EEPE)))
+void eeprom_busy_wait (void);
+#endif
@@ -0,0 +1,14 @@
+/**
+avr/interrupt.h
+  An ISR is a plain function that sim.cpp calls when its inturrupt fires, with inturrupts off the
+  same as on the AVR.
+**/
+#ifndef AVR_INTERRUPT_H
+#define AVR_INTERRUPT_H
+#define ISR(vector) extern "C" void vector (void)
+#define TIMER1_COMPA_vect simTimer1CompA
+#define ADC_vect simAdc
+#define EE_READY_vect simEepromReady
+void cli (void);
+void sei (void);
+#endif
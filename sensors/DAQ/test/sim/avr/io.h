@@ -0,0 +1,64 @@
+/**
+avr/io.h
+  The registers of the whole sketch for the simulation in sim.cpp. The timer, EEPROM and ADC
+  registers are plain variables that sim.cpp reads and writes as the hardware would. SREG and
+  TIFR1 are wrapped: writing a 1 to a TIFR1 flag clears it like the hardware does, and SREG tells
+  sim.cpp when inturrupts go on and off and lets time pass each time it is read, so a loop waiting
+  on an inturrupt does not wait forever.
+**/
+#ifndef AVR_IO_H
+#define AVR_IO_H
+#include <stdint.h>
+
+#define SREG_I 7
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define WGM10 0
+#define WGM11 1
+#define WGM12 3
+#define WGM13 4
+#define OCIE1A 1
+#define OCF1A 1
+#define ICF1 5
+#define EERE 0
+#define EEPE 1
+#define EEMPE 2
+#define EERIE 3
+#define ADPS0 0
+#define ADPS1 1
+#define ADPS2 2
+#define ADIE 3
+#define ADIF 4
+#define ADATE 5
+#define ADSC 6
+#define ADEN 7
+
+//the status register, see simStatusRead and simStatusWrite in sim.cpp
+typedef struct SimStatus_TAG{
+    uint8_t bits;
+    operator uint8_t ();
+    SimStatus_TAG& operator= (uint8_t value);
+    SimStatus_TAG& operator|= (uint8_t set){return *this = bits | set;};
+    SimStatus_TAG& operator&= (uint8_t keep){return *this = bits & keep;};
+}SimStatus;
+
+//an inturrupt flag register, a flag is cleared by writing a 1 to it
+typedef struct SimFlags_TAG{
+    volatile uint8_t bits;
+    operator uint8_t () const {return bits;};
+    SimFlags_TAG& operator= (uint8_t clear){bits &= ~clear; return *this;};
+    SimFlags_TAG& operator|= (uint8_t clear){bits &= ~clear; return *this;};
+}SimFlags;
+
+extern SimStatus SREG;
+extern SimFlags TIFR1;
+extern volatile uint8_t TCCR1A, TCCR1B, TIMSK1;
+extern volatile uint16_t TCNT1, ICR1, OCR1A;
+extern volatile uint8_t EECR, EEDR;
+extern volatile uint16_t EEAR;
+extern volatile uint8_t ADCSRA, ADCSRB, ADMUX, DIDR0;
+extern volatile uint16_t ADC;
+
+#define E2END 0x3FF
+#endif
@@ -0,0 +1,7 @@
+/**
+avr/wdt.h
+  The watchdog is not simulated.
+**/
+#ifndef AVR_WDT_H
+#define AVR_WDT_H
+#endif
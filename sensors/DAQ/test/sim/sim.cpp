@@ -0,0 +1,664 @@
+/**
+sim.cpp
+  A simulated Uno for the whole sketch. Time only passes when the sketch does something that takes
+  time on the Uno, and the hardware is moved along with it: the RTC square wave clocks timer 1,
+  the ADC converts the light sensor, the EEPROM finishes its writes, serial bytes come and go at
+  the baud rate and the MAX31855 chips shift out their frames. Inturrupts fire between any two of
+  those steps while they are on, in the priority order of the AVR, and never inside an inturrupt.
+  The code between two steps is not timed, each pass of the main loop and each inturrupt is given
+  a fixed cost instead, so the worst inturrupt and the worst time with inturrupts off show the
+  code that waits on something, not the cycles of the code itself.
+**/
+#include <cstdio>
+#include <ctime>
+#include <deque>
+#include <string>
+#include <vector>
+#include "sim.h"
+#include <avr/eeprom.h>
+#include <util/delay.h>
+#include <Wire.h>
+#include "Memory.h"
+
+#define SIM_NEVER UINT64_MAX
+#define SIM_ISR_NS 10000               //saving the registers, the body and the return, an estimate
+#define SIM_SERIAL_WRITE_NS 2000       //putting a byte in the transmit buffer
+#define SIM_EEPROM_READ_NS 500
+#define SIM_RTC_ADDRESS 0x68
+#define SIM_RTC_CONTROL 7
+#define SIM_CLOCK_PIN 3                //the MAX31855 chips, see Port.h
+#define SIM_DATA_PIN 4
+#define SIM_CHIPS 5
+#define SIM_CHIP_INTERNAL 400          //25 C cold junction
+
+extern void setup (void);
+extern void loop (void);
+ISR (TIMER1_COMPA_vect);
+ISR (ADC_vect);
+ISR (EE_READY_vect);
+
+//registers
+SimStatus SREG = {1 << SREG_I};       //the core turns inturrupts on before setup
+SimFlags TIFR1 = {0};
+volatile uint8_t TCCR1A, TCCR1B, TIMSK1;
+volatile uint16_t TCNT1, ICR1, OCR1A;
+volatile uint8_t EECR, EEDR;
+volatile uint16_t EEAR;
+volatile uint8_t ADCSRA, ADCSRB, ADMUX, DIDR0;
+volatile uint16_t ADC;
+volatile uint8_t simPort[3];
+volatile uint8_t simPin[3];
+
+HardwareSerial Serial;
+TwoWire Wire;
+SimStats simStats;
+uint8_t simEeprom[E2END + 1];
+
+static int16_t defaultThermocouple (uint8_t port, uint64_t us){
+    return 4 * (20 + port) + (us / 10000000) % 4;
+}
+static uint16_t defaultLight (uint64_t us){
+    return 300 + (us / 1000000) % 50;
+}
+int16_t (*simThermocouple) (uint8_t port, uint64_t us) = defaultThermocouple;
+uint16_t (*simLight) (uint64_t us) = defaultLight;
+
+//the simulation
+static uint64_t now = 0;
+static boolean inIsr = false;
+static uint64_t offSince = 0;         //when the main loop last turned inturrupts off
+static uint64_t eepromDone = SIM_NEVER;
+static uint64_t adcDone = SIM_NEVER;
+static uint32_t sqwRate = 0;          //0 if the square wave is off
+static uint64_t sqwEdge = 0;          //number of the last square wave edge, counted from time 0
+
+//the serial port
+typedef struct SimByte_TAG{
+    uint64_t at;                      //when the last bit is on the wire
+    uint64_t queued;
+    uint8_t value;
+}SimByte;
+static uint32_t deviceBaud = 0;       //0 while the port is not started
+static uint32_t hostBaud = 9600;
+static std::deque<SimByte> rxWire;    //host to DAQ
+static std::deque<uint8_t> rxBuffer;
+static uint64_t rxLast = 0;
+static std::deque<SimByte> txWire;    //DAQ to host
+static uint64_t txLast = 0;
+static std::vector<SimLine> lines;
+static std::string received;
+static SimLine line = {0, 0, ""};
+
+//the RTC
+static uint8_t rtcPointer = 0;
+static uint8_t rtcControl = 0;
+static uint8_t wireAddress = 0;
+static std::vector<uint8_t> wireOut;
+static std::deque<uint8_t> wireIn;
+
+//the MAX31855 chips
+static const uint8_t chipSelect[SIM_CHIPS] = {6, 7, 8, 9, 10};
+static int8_t selected = -1;
+static int8_t bit = 0;
+static uint32_t frame = 0;
+static boolean clockWas = false;
+
+static void advance (uint64_t ns);
+
+static uint64_t byteNs (uint32_t baud){
+    return 10000000000ULL / baud;
+}
+
+static boolean pinHigh (uint8_t pin){
+    return simPort[digitalPinToPort(pin)] & digitalPinToBitMask(pin);
+}
+
+/**
+static void chipsStep (void)
+  Moves the chips on to the pins, each chip shifts out its frame the way the MAX31855 does: the
+  frame is latched and its first bit put out as chip select falls, the next bit on every falling
+  clock edge. Called as the pins change.
+**/
+static void chipsStep (void){
+    int8_t low = -1;
+    for (uint8_t chip = 0; chip < SIM_CHIPS; chip++){
+        if (!pinHigh(chipSelect[chip])){
+            low = (low < 0) ? chip : SIM_CHIPS;
+        }
+    }
+    boolean clock = pinHigh(SIM_CLOCK_PIN);
+    if (low == SIM_CHIPS){
+        selected = -1;
+    }
+    else if (low != selected){
+        selected = low;
+        bit = 31;
+        if (selected >= 0){
+            int16_t raw = simThermocouple(selected + 1, now / 1000);
+            frame = ((uint32_t)(raw & 0x3FFF) << 18) | ((uint32_t)(SIM_CHIP_INTERNAL & 0xFFF) << 4);
+        }
+    }
+    else if (selected >= 0 && clockWas && !clock){
+        bit--;
+    }
+    clockWas = clock;
+    uint8_t mask = digitalPinToBitMask(SIM_DATA_PIN);
+    if (selected >= 0 && bit >= 0 && (frame >> bit) & 1){
+        simPin[digitalPinToPort(SIM_DATA_PIN)] |= mask;
+    }
+    else{
+        simPin[digitalPinToPort(SIM_DATA_PIN)] &= ~mask;
+    }
+}
+
+/**
+static void hardwareStep (void)
+  Starts what the sketch has asked the hardware to do since the last step: an EEPROM write once
+  EEPE is set and a conversion once ADSC is set.
+**/
+static void hardwareStep (void){
+    if ((EECR & (1 << EEPE)) && eepromDone == SIM_NEVER){
+        eepromDone = now + SIM_EEPROM_WRITE_US * 1000ULL;
+    }
+    if (!(ADCSRA & (1 << ADEN))){
+        adcDone = SIM_NEVER;
+    }
+    else if ((ADCSRA & (1 << ADSC)) && adcDone == SIM_NEVER){
+        adcDone = now + SIM_ADC_FIRST_US * 1000ULL;
+    }
+}
+
+//when square wave edge number edge comes
+static uint64_t edgeTime (uint64_t edge){
+    return (edge * 1000000000ULL + sqwRate - 1) / sqwRate;
+}
+
+/**
+static void dispatch (void)
+  Runs the inturrupts that are waiting, highest priority first, while inturrupts are on. Each one
+  runs with inturrupts off and its time is recorded.
+**/
+static void dispatch (void){
+    while (!inIsr && (SREG.bits & (1 << SREG_I))){
+        hardwareStep();
+        uint8_t vector;
+        if ((TIFR1.bits & (1 << OCF1A)) && (TIMSK1 & (1 << OCIE1A))){
+            TIFR1.bits &= ~(1 << OCF1A);
+            vector = SIM_TIMER1_COMPA;
+        }
+        else if ((ADCSRA & (1 << ADIF)) && (ADCSRA & (1 << ADIE))){
+            ADCSRA &= ~(1 << ADIF);
+            vector = SIM_ADC;
+        }
+        else if ((EECR & (1 << EERIE)) && !(EECR & (1 << EEPE))){
+            vector = SIM_EEPROM_READY;
+        }
+        else{
+            return;
+        }
+        uint64_t start = now;
+        inIsr = true;
+        SREG.bits &= ~(1 << SREG_I);
+        advance(SIM_ISR_NS);
+        if (vector == SIM_TIMER1_COMPA){
+            simTimer1CompA();
+        }
+        else if (vector == SIM_ADC){
+            simAdc();
+        }
+        else{
+            simEepromReady();
+        }
+        SREG.bits |= (1 << SREG_I);
+        inIsr = false;
+        simStats.isrs[vector]++;
+        if (now - start > simStats.worstIsrNs[vector]){
+            simStats.worstIsrNs[vector] = now - start;
+        }
+    }
+}
+
+/**
+static void deliver (void)
+  Hands the host every byte that has finished arriving, a byte sent at another baud rate than the
+  host is using arrives as '?'. Lines end with <LF>.
+**/
+static void deliver (void){
+    while (!txWire.empty() && txWire.front().at <= now){
+        SimByte byte = txWire.front();
+        txWire.pop_front();
+        char value = (deviceBaud == hostBaud) ? (char)byte.value : '?';
+        received += value;
+        if (line.text.empty()){
+            line.queued = byte.queued / 1000;
+        }
+        line.text += value;
+        if (value == '\n'){
+            line.at = (byte.at + 999) / 1000;
+            lines.push_back(line);
+            line.text.clear();
+        }
+    }
+}
+
+/**
+static void advance (uint64_t ns)
+  Lets ns pass, moving the hardware along and running inturrupts as they come due. An inturrupt
+  that takes longer than ns carries the time on past it.
+**/
+static void advance (uint64_t ns){
+    uint64_t target = now + ns;
+    for (;;){
+        hardwareStep();
+        dispatch();
+        uint64_t edge = (sqwRate != 0) ? edgeTime(sqwEdge + 1) : SIM_NEVER;
+        uint64_t next = edge;
+        if (adcDone < next){
+            next = adcDone;
+        }
+        if (eepromDone < next){
+            next = eepromDone;
+        }
+        if (next > target){
+            break;
+        }
+        if (next > now){
+            now = next;
+        }
+        if (next == edge){
+            sqwEdge++;
+            //timer 1 counts the square wave on pin 5 in CTC mode with ICR1 as its top
+            if ((TCCR1B & 7) == 7){
+                TCNT1 = (TCNT1 == ICR1) ? 0 : (uint16_t)(TCNT1 + 1);
+                if (TCNT1 == OCR1A){
+                    TIFR1.bits |= (1 << OCF1A);
+                }
+            }
+        }
+        else if (next == adcDone){
+            ADC = simLight(now / 1000);
+            ADCSRA |= (1 << ADIF);
+            if (ADCSRA & (1 << ADATE)){
+                adcDone = now + SIM_ADC_US * 1000ULL;
+            }
+            else{
+                ADCSRA &= ~(1 << ADSC);
+                adcDone = SIM_NEVER;
+            }
+        }
+        else{
+            simEeprom[EEAR & E2END] = EEDR;
+            EECR &= ~((1 << EEPE) | (1 << EEMPE));
+            eepromDone = SIM_NEVER;
+        }
+    }
+    if (now < target){
+        now = target;
+    }
+    deliver();
+}
+
+//the status register
+SimStatus::operator uint8_t (){
+    advance(SIM_STATUS_READ_NS);
+    return bits;
+}
+
+SimStatus& SimStatus::operator= (uint8_t value){
+    boolean wasOn = bits & (1 << SREG_I);
+    bits = value;
+    if (inIsr){
+        return *this;
+    }
+    //the MAX31855 driver writes its pins with inturrupts off, the chips see them as SREG is restored
+    chipsStep();
+    if (wasOn && !(value & (1 << SREG_I))){
+        offSince = now;
+    }
+    else if (!wasOn && (value & (1 << SREG_I))){
+        if (now - offSince > simStats.worstOffNs){
+            simStats.worstOffNs = now - offSince;
+        }
+        dispatch();
+    }
+    return *this;
+}
+
+void cli (void){SREG = SREG.bits & ~(1 << SREG_I);}
+void sei (void){SREG = SREG.bits | (1 << SREG_I);}
+
+//the Arduino core
+unsigned long millis (void){
+    advance(SIM_MILLIS_NS);
+    return now / 1000000;
+}
+unsigned long micros (void){
+    advance(SIM_MILLIS_NS);
+    return now / 1000;
+}
+void delay (unsigned long ms){advance(ms * 1000000ULL);}
+void delayMicroseconds (unsigned int us){advance(us * 1000ULL);}
+void _delay_us (double us){
+    chipsStep();
+    advance((uint64_t)(us * 1000));
+}
+void _delay_ms (double ms){_delay_us(ms * 1000);}
+int analogRead (uint8_t){
+    advance(SIM_ANALOGREAD_US * 1000ULL);
+    return simLight(now / 1000);
+}
+void analogReference (uint8_t){}
+void pinMode (uint8_t, uint8_t){}
+void digitalWrite (uint8_t pin, uint8_t value){
+    uint8_t oldSREG = SREG.bits;
+    SREG.bits &= ~(1 << SREG_I);
+    if (value){
+        *portOutputRegister(digitalPinToPort(pin)) |= digitalPinToBitMask(pin);
+    }
+    else{
+        *portOutputRegister(digitalPinToPort(pin)) &= ~digitalPinToBitMask(pin);
+    }
+    SREG = oldSREG;
+}
+int digitalRead (uint8_t pin){
+    return (*portInputRegister(digitalPinToPort(pin)) & digitalPinToBitMask(pin)) ? HIGH : LOW;
+}
+
+size_t Print::write (const uint8_t* buffer, size_t length){
+    for (size_t i = 0; i < length; i++){
+        write(buffer[i]);
+    }
+    return length;
+}
+size_t Print::print (long value, int base){
+    if (value < 0 && base == DEC){
+        return write('-') + print((unsigned long)-value, base);
+    }
+    return print((unsigned long)value, base);
+}
+size_t Print::print (unsigned long value, int base){
+    char digits[33];
+    uint8_t length = 0;
+    do{
+        uint8_t digit = value % base;
+        digits[length++] = (digit < 10) ? '0' + digit : 'A' + digit - 10;
+        value /= base;
+    } while (value != 0);
+    size_t n = 0;
+    while (length > 0){
+        n += write((uint8_t)digits[--length]);
+    }
+    return n;
+}
+size_t Print::print (double value, int digits){
+    char text[40];
+    snprintf(text, sizeof(text), "%.*f", digits, value);
+    return write(text);
+}
+
+//moves the bytes the host has finished sending into the receive buffer, a byte sent at another
+//rate than the DAQ is using arrives as garbage
+static void receive (void){
+    while (!rxWire.empty() && rxWire.front().at <= now){
+        SimByte byte = rxWire.front();
+        rxWire.pop_front();
+        if (deviceBaud == 0){
+            continue;
+        }
+        if (rxBuffer.size() >= SIM_SERIAL_BUFFER - 1){
+            simStats.rxOverruns++;
+            continue;
+        }
+        rxBuffer.push_back((deviceBaud == hostBaud) ? byte.value : 0xFF);
+    }
+}
+
+void HardwareSerial::begin (unsigned long baud){
+    receive();
+    deviceBaud = baud;
+    rxBuffer.clear();
+}
+void HardwareSerial::end (void){
+    flush();
+    receive();
+    deviceBaud = 0;
+    rxBuffer.clear();
+}
+int HardwareSerial::available (void){
+    receive();
+    return rxBuffer.size();
+}
+int HardwareSerial::read (void){
+    receive();
+    if (rxBuffer.empty()){
+        return -1;
+    }
+    uint8_t value = rxBuffer.front();
+    rxBuffer.pop_front();
+    return value;
+}
+int HardwareSerial::peek (void){
+    receive();
+    return rxBuffer.empty() ? -1 : rxBuffer.front();
+}
+void HardwareSerial::flush (void){
+    if (txLast > now){
+        advance(txLast - now);
+    }
+}
+
+/**
+size_t HardwareSerial::write (uint8_t value)
+  Queues a byte behind the ones already sent. The transmit ring holds SIM_SERIAL_BUFFER-1 bytes
+  and the UART one more, a write to a full buffer waits for the UART to take a byte.
+**/
+size_t HardwareSerial::write (uint8_t value){
+    if (deviceBaud == 0){
+        return 0;
+    }
+    uint64_t queued = now;
+    advance(SIM_SERIAL_WRITE_NS);
+    while (txWire.size() >= SIM_SERIAL_BUFFER){
+        advance(txWire.front().at - now);
+    }
+    uint64_t start = (txLast > now) ? txLast : now;
+    txLast = start + byteNs(deviceBaud);
+    SimByte byte = {txLast, queued, value};
+    txWire.push_back(byte);
+    return 1;
+}
+
+//the EEPROM, reads wait for a write to finish the same as in avr-libc
+void eeprom_busy_wait (void){
+    while (EECR & (1 << EEPE)){
+        advance((eepromDone != SIM_NEVER && eepromDone > now) ? eepromDone - now : 1);
+    }
+}
+void eeprom_read_block (void* destination, const void* source, size_t length){
+    eeprom_busy_wait();
+    advance(length * SIM_EEPROM_READ_NS);
+    memcpy(destination, &simEeprom[(uintptr_t)source], length);
+}
+uint8_t eeprom_read_byte (const uint8_t* address){
+    uint8_t value;
+    eeprom_read_block(&value, address, sizeof(value));
+    return value;
+}
+uint16_t eeprom_read_word (const uint16_t* address){
+    uint16_t value;
+    eeprom_read_block(&value, address, sizeof(value));
+    return value;
+}
+uint32_t eeprom_read_dword (const void* address){
+    uint32_t value;
+    eeprom_read_block(&value, address, sizeof(value));
+    return value;
+}
+float eeprom_read_float (const float* address){
+    float value;
+    eeprom_read_block(&value, address, sizeof(value));
+    return value;
+}
+void eeprom_write_block (const void* source, void* destination, size_t length){
+    for (size_t i = 0; i < length; i++){
+        eeprom_busy_wait();
+        EEAR = (uintptr_t)destination + i;
+        EEDR = ((const uint8_t*)source)[i];
+        EECR |= (1 << EEPE);
+        hardwareStep();
+    }
+}
+void eeprom_write_byte (uint8_t* address, uint8_t value){eeprom_write_block(&value, address, 1);}
+void eeprom_write_word (uint16_t* address, uint16_t value){eeprom_write_block(&value, address, 2);}
+void eeprom_write_dword (void* address, uint32_t value){eeprom_write_block(&value, address, 4);}
+void eeprom_write_float (float* address, float value){eeprom_write_block(&value, address, 4);}
+
+//the I2C bus with the DS1307
+static uint8_t rtcRegister (uint8_t address, const struct tm* time){
+    uint8_t value;
+    switch (address){
+        case 0: value = time->tm_sec; break;
+        case 1: value = time->tm_min; break;
+        case 2: value = time->tm_hour; break;
+        case 3: return time->tm_wday + 1;
+        case 4: value = time->tm_mday; break;
+        case 5: value = time->tm_mon + 1; break;
+        case 6: value = time->tm_year - 100; break;
+        case SIM_RTC_CONTROL: return rtcControl;
+        default: return 0;
+    }
+    return ((value / 10) << 4) | (value % 10);
+}
+
+static void setSquareWave (uint8_t control){
+    static const uint32_t rates[] = {1, 4096, 8192, 32768};
+    rtcControl = control;
+    sqwRate = (control & 0x10) ? rates[control & 3] : 0;
+    if (sqwRate != 0){
+        sqwEdge = now * sqwRate / 1000000000ULL;
+    }
+}
+
+void TwoWire::begin (void){}
+void TwoWire::beginTransmission (uint8_t address){
+    if (inIsr || !(SREG.bits & (1 << SREG_I))){
+        simStats.i2cWithInterruptsOff++;
+    }
+    wireAddress = address;
+    wireOut.clear();
+}
+size_t TwoWire::write (uint8_t value){
+    wireOut.push_back(value);
+    return 1;
+}
+size_t TwoWire::write (const uint8_t* values, size_t length){
+    for (size_t i = 0; i < length; i++){
+        write(values[i]);
+    }
+    return length;
+}
+uint8_t TwoWire::endTransmission (void){
+    advance((wireOut.size() + 1) * SIM_I2C_BYTE_US * 1000ULL);
+    if (wireAddress != SIM_RTC_ADDRESS){
+        return 2;
+    }
+    for (size_t i = 0; i < wireOut.size(); i++){
+        if (i == 0){
+            rtcPointer = wireOut[i];
+        }
+        else if (rtcPointer++ == SIM_RTC_CONTROL){
+            setSquareWave(wireOut[i]);
+        }
+    }
+    return 0;
+}
+uint8_t TwoWire::requestFrom (uint8_t address, uint8_t length){
+    if (inIsr || !(SREG.bits & (1 << SREG_I))){
+        simStats.i2cWithInterruptsOff++;
+    }
+    wireIn.clear();
+    //the DS1307 copies the time registers as the read starts
+    time_t seconds = SIM_EPOCH + now / 1000000000ULL;
+    struct tm time;
+    gmtime_r(&seconds, &time);
+    advance((length + 1) * SIM_I2C_BYTE_US * 1000ULL);
+    if (address != SIM_RTC_ADDRESS){
+        return 0;
+    }
+    for (uint8_t i = 0; i < length; i++){
+        wireIn.push_back(rtcRegister(rtcPointer++ & 0x3F, &time));
+    }
+    return length;
+}
+int TwoWire::available (void){
+    return wireIn.size();
+}
+int TwoWire::read (void){
+    if (wireIn.empty()){
+        return -1;
+    }
+    uint8_t value = wireIn.front();
+    wireIn.pop_front();
+    return value;
+}
+
+/**
+void simStart (void)
+  Starts the sketch on a DAQ whose log has never been used: the EEPROM is erased and the
+  experiment and settings blocks are cleared, the state a DAQ is left in by its first B command.
+  Runs setup and clears the statistics. Call once.
+**/
+void simStart (void){
+    memset(simEeprom, 0xFF, sizeof(simEeprom));
+    memset(simEeprom, 0, sizeof(ExperimentBlock) + sizeof(SettingsBlock));
+    for (uint8_t chip = 0; chip < SIM_CHIPS; chip++){
+        simPort[digitalPinToPort(chipSelect[chip])] |= digitalPinToBitMask(chipSelect[chip]);
+    }
+    setup();
+    simClearStats();
+}
+
+/**
+void simRun (uint64_t until)
+  Runs the main loop until the time until in microseconds, each pass costs SIM_LOOP_US on top of
+  whatever it waited for.
+**/
+void simRun (uint64_t until){
+    while (now < until * 1000){
+        uint64_t start = now;
+        loop();
+        advance(SIM_LOOP_US * 1000ULL);
+        if (now - start > simStats.worstLoopNs){
+            simStats.worstLoopNs = now - start;
+        }
+    }
+}
+
+/**
+uint64_t simSend (const char* text, uint64_t at)
+  The host sends text at the time at in microseconds, or as soon as it has finished sending what
+  it sent before. Returns the time in microseconds the last byte has arrived.
+**/
+uint64_t simSend (const char* text, uint64_t at){
+    uint64_t start = at * 1000;
+    if (rxLast > start){
+        start = rxLast;
+    }
+    for (size_t i = 0; text[i] != 0; i++){
+        start += byteNs(hostBaud);
+        SimByte byte = {start, start, (uint8_t)text[i]};
+        rxWire.push_back(byte);
+    }
+    rxLast = start;
+    return (start + 999) / 1000;
+}
+
+void simHostBaud (uint32_t baud){hostBaud = baud;}
+uint64_t simNow (void){return now / 1000;}
+const std::vector<SimLine>& simLines (void){return lines;}
+const std::string& simReceived (void){return received;}
+
+void simClearStats (void){
+    memset(&simStats, 0, sizeof(simStats));
+    offSince = now;
+}
@@ -0,0 +1,65 @@
+/**
+sim.h
+  Runs the whole sketch on a PC against a simulated Uno, see sim.cpp. A test starts the sketch with
+  simStart, sends commands with simSend and runs the main loop with simRun, then looks at the lines
+  that came back and at what the simulation saw on the way. Times are in microseconds from the
+  start of the simulation. Include the C++ library headers a test needs before this one.
+**/
+#ifndef SIM_H
+#define SIM_H
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "Arduino.h"
+
+// global constants for the simulation. All constants contributed to it begin with SIM_
+#define SIM_EPOCH 1420070400UL          //unix time on the RTC as the simulation starts
+#define SIM_LOOP_US 20                  //one pass of the main loop with nothing to do
+#define SIM_EEPROM_WRITE_US 3400        //one EEPROM byte
+#define SIM_ADC_FIRST_US 200            //the first conversion after the ADC is turned on
+#define SIM_ADC_US 104                  //each conversion after that at 125 kHz
+#define SIM_ANALOGREAD_US 112
+#define SIM_I2C_BYTE_US 90              //9 bits at 100 kHz
+#define SIM_SERIAL_BUFFER 64            //bytes the serial port holds on each side
+#define SIM_STATUS_READ_NS 63           //one cycle to read SREG
+#define SIM_MILLIS_NS 2000              //a call to millis or micros
+//the inturrupt vectors the sketch uses, in priority order
+#define SIM_TIMER1_COMPA 0
+#define SIM_ADC 1
+#define SIM_EEPROM_READY 2
+#define SIM_VECTORS 3
+
+//A line the host received.
+typedef struct SimLine_TAG{
+    uint64_t queued;                //when the sketch wrote its first byte
+    uint64_t at;                    //when its last byte reached the host
+    std::string text;               //including the <CR><LF>
+}SimLine;
+
+//What the simulation saw while the sketch ran, since simStart or simClearStats.
+typedef struct SimStats_TAG{
+    uint64_t worstIsrNs[SIM_VECTORS];    //longest run of each inturrupt
+    uint32_t isrs[SIM_VECTORS];          //number of times each inturrupt ran
+    uint64_t worstOffNs;                 //longest time the main loop had inturrupts off
+    uint64_t worstLoopNs;                //longest pass of loop
+    uint32_t rxOverruns;                 //bytes lost because the receive buffer was full
+    uint32_t i2cWithInterruptsOff;       //I2C transactions started with inturrupts off, these hang the Uno
+}SimStats;
+
+extern SimStats simStats;
+extern uint8_t simEeprom[E2END + 1];
+//the raw thermocouple count, in quarter degrees, of the chip on port 1 to 5 at time us
+extern int16_t (*simThermocouple) (uint8_t port, uint64_t us);
+//the ADC count of the light sensor at time us
+extern uint16_t (*simLight) (uint64_t us);
+
+void simStart (void);
+void simRun (uint64_t until);
+uint64_t simSend (const char* text, uint64_t at);
+void simHostBaud (uint32_t baud);
+uint64_t simNow (void);
+void simClearStats (void);
+const std::vector<SimLine>& simLines (void);
+const std::string& simReceived (void);
+
+#endif
@@ -0,0 +1,9 @@
+/**
+util/delay.h
+  Busy waits let the simulated time pass.
+**/
+#ifndef UTIL_DELAY_H
+#define UTIL_DELAY_H
+void _delay_us (double us);
+void _delay_ms (double ms);
+#endif
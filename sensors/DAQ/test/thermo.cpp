@@ -0,0 +1,156 @@
+/**
+thermo.cpp
+  Checks the MAX31855 driver against an emulated chip and works out how many frames a second it
+  reads. Five chips share the clock and data pins the ports use and each has its own chip select,
+  PORT_TEMP5 on pin 10 included. Every chip shifts out its own frame the way the MAX31855 does, the
+  first bit when chip select falls and the next bit on every falling clock edge, and each frame
+  must be read back whole and decode to the fields it was built from.
+  The time a read takes is modelled, not measured: the busy waits the driver asks for plus an
+  estimate of the AVR cycles spent on each pin. The same model is run over the digitalWrite and
+  _delay_ms loop the driver used before, for comparison. Build and run with run.sh.
+**/
+#include <cstdio>
+#include "Arduino.h"
+#include <util/delay.h>
+#include "Adafruit_MAX31855.h"
+
+#define THERMO_CLOCK 3                //PORT_CLOCK
+#define THERMO_DATA 4                 //PORT_DATA_BUS
+#define THERMO_CHIPS 5
+#define THERMO_CPU_MHZ 16
+#define THERMO_PIN_CYCLES 10          //a cached port write: save SREG, cli, read-modify-write, restore
+#define THERMO_DIGITAL_CYCLES 60      //digitalWrite or digitalRead through the pin tables
+#define THERMO_BIT_CYCLES 12          //testing the data pin, shifting the frame and the loop
+#define THERMO_MIN_READS 5000         //reads a second the driver must reach
+
+static const uint8_t chipSelect[THERMO_CHIPS] = {6, 7, 8, 9, 10};   //PORT_TEMP1 to PORT_TEMP5
+
+//the emulated chips
+static uint32_t frames[THERMO_CHIPS];
+static int8_t selected = -1;
+static int8_t bit = 0;
+static boolean clockWas = false;
+static double busyUs = 0;
+
+static boolean pinHigh (uint8_t pin){
+    return hostPort[digitalPinToPort(pin)] & digitalPinToBitMask(pin);
+}
+
+//puts the current bit of the selected chip on the data pin
+static void shiftOut (void){
+    uint8_t mask = digitalPinToBitMask(THERMO_DATA);
+    if (selected >= 0 && bit >= 0 && (frames[selected] >> bit) & 1){
+        hostPin[digitalPinToPort(THERMO_DATA)] |= mask;
+    }
+    else{
+        hostPin[digitalPinToPort(THERMO_DATA)] &= ~mask;
+    }
+}
+
+//the driver waits after every pin change, so the chips catch up with the pins here
+static void chipsStep (double us){
+    busyUs += us;
+    int8_t low = -1;
+    for (uint8_t chip = 0; chip < THERMO_CHIPS; chip++){
+        if (!pinHigh(chipSelect[chip])){
+            low = (low < 0) ? chip : THERMO_CHIPS;
+        }
+    }
+    boolean clock = pinHigh(THERMO_CLOCK);
+    if (low == THERMO_CHIPS){
+        selected = -1;                //two chips driving the data pin at once
+    }
+    else if (low != selected){
+        selected = low;
+        bit = 31;
+    }
+    else if (selected >= 0 && clockWas && !clock){
+        bit--;
+    }
+    clockWas = clock;
+    shiftOut();
+}
+
+//the chips only look at the pins while the driver waits, let them see chip select go high again
+//before the next read
+static uint32_t readChip (Adafruit_MAX31855* chip){
+    uint32_t frame = (*chip).readFrame();
+    chipsStep(0);
+    return frame;
+}
+
+//builds a frame from its fields
+static uint32_t makeFrame (int16_t raw, int16_t internal, uint8_t error){
+    return ((uint32_t)(raw & 0x3FFF) << 18) | ((error != 0) ? 0x10000UL : 0) | ((uint32_t)(internal & 0xFFF) << 4) | error;
+}
+
+//the loop the driver used before, a millisecond wait on each side of every clock edge
+static uint32_t oldRead32 (uint8_t cs){
+    uint32_t d = 0;
+    digitalWrite(THERMO_CLOCK, LOW);
+    _delay_ms(1);
+    digitalWrite(cs, LOW);
+    _delay_ms(1);
+    for (int i = 31; i >= 0; i--){
+        digitalWrite(THERMO_CLOCK, LOW);
+        _delay_ms(1);
+        d <<= 1;
+        if (digitalRead(THERMO_DATA)){
+            d |= 1;
+        }
+        digitalWrite(THERMO_CLOCK, HIGH);
+        _delay_ms(1);
+    }
+    digitalWrite(cs, HIGH);
+    return d;
+}
+
+int main (void){
+    hostDelay = chipsStep;
+    uint32_t failures = 0;
+    Adafruit_MAX31855* chips[THERMO_CHIPS];
+    for (uint8_t chip = 0; chip < THERMO_CHIPS; chip++){
+        chips[chip] = new Adafruit_MAX31855(THERMO_CLOCK, chipSelect[chip], THERMO_DATA);
+        digitalWrite(chipSelect[chip], HIGH);
+    }
+    //hot, cold, below freezing, and open, shorted to ground and shorted to VCC
+    const int16_t raw[] = {100, 1600, -49, 0, 0, 0};
+    const int16_t internal[] = {392, 400, -49, 380, 380, 380};
+    const uint8_t error[] = {0, 0, 0, 1, 2, 4};
+    for (uint8_t test = 0; test < sizeof(raw) / sizeof(raw[0]); test++){
+        for (uint8_t chip = 0; chip < THERMO_CHIPS; chip++){
+            frames[chip] = makeFrame(raw[test] + chip, internal[test] - chip, error[test]);
+        }
+        for (uint8_t chip = 0; chip < THERMO_CHIPS; chip++){
+            uint32_t frame = readChip(chips[chip]);
+            if (frame != frames[chip] || Adafruit_MAX31855::frameToError(frame) != error[test]
+                || Adafruit_MAX31855::frameToRaw(frame) != raw[test] + chip
+                || Adafruit_MAX31855::frameToInternalRaw(frame) != internal[test] - chip){
+                printf("chip select %u: read 0x%08X, the chip sent 0x%08X\n", chipSelect[chip], frame, frames[chip]);
+                failures++;
+            }
+        }
+    }
+    //modelled time of one read, new driver and old loop
+    busyUs = 0;
+    readChip(chips[0]);
+    double newUs = busyUs + (3 + 32 * 2) * THERMO_PIN_CYCLES / (double)THERMO_CPU_MHZ
+        + 32 * THERMO_BIT_CYCLES / (double)THERMO_CPU_MHZ;
+    busyUs = 0;
+    uint32_t frame = oldRead32(chipSelect[0]);
+    chipsStep(0);
+    if (frame != frames[0]){
+        printf("the old loop read the wrong frame\n");
+        failures++;
+    }
+    double oldUs = busyUs + (3 + 32 * 3) * THERMO_DIGITAL_CYCLES / (double)THERMO_CPU_MHZ
+        + 32 * THERMO_BIT_CYCLES / (double)THERMO_CPU_MHZ;
+    printf("modelled read of one frame: cached port bit-bang %6.1f us, %5.0f reads/s\n", newUs, 1e6 / newUs);
+    printf("                            digitalWrite, 1 ms    %6.1f us, %5.0f reads/s\n", oldUs, 1e6 / oldUs);
+    if (1e6 / newUs < THERMO_MIN_READS){
+        printf("fewer than %u reads/s\n", THERMO_MIN_READS);
+        failures++;
+    }
+    printf("%u failures\n", failures);
+    return failures != 0;
+}
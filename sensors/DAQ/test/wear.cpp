@@ -0,0 +1,95 @@
+/**
+wear.cpp
+  EEPROM wear simulator for the log in Memory. Saves a year of samples taken every second and
+  reports the most and the mean writes made to any one byte of the log, and how long the log would
+  last at the rated endurance of EEPROM_ENDURANCE writes. Only bytes that change are counted, the
+  same as the EEPROM itself. Build and run with run.sh.
+**/
+#include <cstdio>
+#include "Arduino.h"
+#include "Memory.h"
+
+#define WEAR_PERIODS 31536000UL      //a year of 1 second periods
+#define EEPROM_ENDURANCE 100000UL
+
+static Memory memory;
+
+static void eepromReady (void){
+    memory.eepromReady();
+}
+
+//a slow random walk in native units, the way a thermocouple read every second drifts
+static int16_t walk (int16_t value, uint32_t* seed){
+    *seed = *seed * 1103515245UL + 12345;
+    return value + (int16_t)((*seed >> 16) % 3) - 1;
+}
+
+//saves a year of samples from the ports in portMask, as summaries of window samples if window is
+//more than 1, and reports the writes made to the log
+static void runYear (const char* name, uint8_t portMask, uint8_t window){
+    memset(hostEeprom, 0xFF, sizeof(hostEeprom));
+    memset(hostEepromWrites, 0, sizeof(hostEepromWrites));
+    memory = Memory();
+    memory.memorySetup();
+    ExperimentBlock experimentBlock;
+    memory.loadExperimentBlock(&experimentBlock);
+    experimentBlock.logEpoch = memory.reset();
+    memory.updateExperimentBlock(experimentBlock);
+    uint32_t seed = 1;
+    int16_t value[MEMORY_MAX_PORTS] = {400, 410, 420, 430, 440, 3000};
+    int32_t sum[MEMORY_MAX_PORTS] = {0};
+    uint32_t blockStart = SETTINGS_BLOCK_ADDRESS + sizeof(SettingsBlock);
+    uint32_t before = hostEepromWrites[0];
+    for (uint32_t period = 1; period <= WEAR_PERIODS; period++){
+        DataBlock dataBlock;
+        dataBlock.periodNumber = period;
+        dataBlock.portMask = portMask;
+        dataBlock.count = 0;
+        for (uint8_t port = 0; port < MEMORY_MAX_PORTS; port++){
+            value[port] = walk(value[port], &seed);
+            dataBlock.data[port] = value[port];
+            sum[port] += value[port];
+        }
+        if (window <= 1){
+            memory.saveDataBlock(dataBlock);
+            continue;
+        }
+        if (period % window != 0){
+            continue;
+        }
+        for (uint8_t port = 0; port < MEMORY_MAX_PORTS; port++){
+            if (portMask & (1 << port)){
+                DataBlock summary = dataBlock;
+                summary.portMask = (1 << port);
+                summary.count = window;
+                summary.data[port] = sum[port] / window;
+                summary.low = summary.data[port] - 2;
+                summary.high = summary.data[port] + 2;
+                memory.saveDataBlock(summary);
+            }
+            sum[port] = 0;
+        }
+    }
+    memory.flush();
+    uint32_t most = 0;
+    uint64_t total = 0;
+    for (uint32_t address = blockStart; address <= E2END; address++){
+        most = max(most, hostEepromWrites[address]);
+        total += hostEepromWrites[address];
+    }
+    printf("%-34s most %7u  mean %7.0f  lasts %5.1f years\n", name, most,
+           (double)total / (E2END + 1 - blockStart), (double)EEPROM_ENDURANCE / most);
+    if (hostEepromWrites[0] != before){
+        printf("  the experiment block was written during the experiment\n");
+    }
+}
+
+int main (void){
+    hostEepromReady = eepromReady;
+    printf("writes to one byte of the log in a year of 1 s periods\n");
+    runYear("1 port every period", 0x01, 1);
+    runYear("6 ports every period", MEMORY_PORT_MASK, 1);
+    runYear("6 ports, 10 sample windows", MEMORY_PORT_MASK, 10);
+    runYear("6 ports, 60 sample windows", MEMORY_PORT_MASK, 60);
+    return 0;
+}